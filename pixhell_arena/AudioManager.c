@@ -21,21 +21,36 @@
 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #include "AudioManager.h"
+#include "PackFile.h"
+#include "MemoryManagement.h"
 
 
 stdList* global_sound_list, * scene_sound_list, * global_music_list, * scene_music_list;
+stdList* prefetch_sound_list, * prefetch_music_list;
 Sound sound_place_holder;
 Music music_place_holder;
+static SRWLOCK sound_list_lock = SRWLOCK_INIT;
+static ResourceRegistry* music_registry;
+static ResourceRegistry* sound_registry;
+static ResourceCache* sound_cache;
+static size_t sound_budget = DEFAULT_SOUND_BUDGET;
+static ResourceCache* music_cache;
+static size_t music_budget = DEFAULT_MUSIC_BUDGET;
 
 Sound CreateSound(const char* path)
 {
 	Sound sound;
 	Path tmpPath = fs_create_path(path);
-	sound.m_sound_buffer = sfSoundBuffer_createFromFile(path);
+	fs_mapped_file mapped_file;
+	size_t file_size = 0;
+	const void* data = MapResourceFile(path, &file_size, &mapped_file);
+	sound.m_sound_buffer = data ? sfSoundBuffer_createFromMemory(data, file_size) : sfSoundBuffer_createFromFile(path);
+	fs_unmap_file(&mapped_file);
 	sound.m_sound = sfSound_create();
 	sfSound_setBuffer(sound.m_sound, sound.m_sound_buffer);
 	sound.m_path = tmpPath;
-	strcpy_s(sound.m_name, MAX_PATH_SIZE, tmpPath.stem(&tmpPath).path_data.m_path);
+	sound.m_load_state = RESOURCE_LOADED;
+	fs_stem(path, sound.m_name, MAX_PATH_SIZE);
 	ToLower(sound.m_name);
 	printf_d("Sound {\n\tPath : %s\n\tName: %s\n } loaded\n\n", sound.m_path.path_data.m_path, sound.m_name);
 	return sound;
@@ -45,9 +60,12 @@ Music CreateMusic(const char* path)
 {
 	Music music;
 	Path tmpPath = fs_create_path(path);
-	music.m_music = sfMusic_createFromFile(path);
+	music.m_data_size = 0;
+	const void* data = ReadResourceFile(path, &music.m_data_size, &music.m_data);
+	music.m_music = data ? sfMusic_createFromMemory(data, music.m_data_size) : sfMusic_createFromFile(path);
 	music.m_path = tmpPath;
-	strcpy_s(music.m_name, MAX_PATH_SIZE, tmpPath.stem(&tmpPath).path_data.m_path);
+	music.m_load_state = RESOURCE_LOADED;
+	fs_stem(path, music.m_name, MAX_PATH_SIZE);
 	ToLower(music.m_name);
 	printf_d("Music {\n\tPath : %s\n\tName: %s\n } loaded\n\n", music.m_path.path_data.m_path, music.m_name);
 	return music;
@@ -62,6 +80,134 @@ void DeleteSound(Sound* sound)
 void DeleteMusic(Music* music)
 {
 	sfMusic_destroy(music->m_music);
+	if (music->m_data)
+		free_d(music->m_data);
+	music->m_data = NULL;
+}
+
+static Sound CreateUnloadedSound(const char* path)
+{
+	Sound tmp = { 0 };
+	tmp.m_path = fs_create_path(path);
+	fs_stem(path, tmp.m_name, MAX_PATH_SIZE);
+	ToLower(tmp.m_name);
+	tmp.m_load_state = RESOURCE_UNLOADED;
+	return tmp;
+}
+
+static void LoadSoundOnFirstUse(void* resource)
+{
+	Sound* sound = resource;
+	Sound loaded = CreateSound(sound->m_path.path_data.m_path);
+	sound->m_sound_buffer = loaded.m_sound_buffer;
+	sound->m_sound = loaded.m_sound;
+}
+
+static sfSound* RequireSound(Sound* sound)
+{
+	if (__RequireResource(&sound->m_load_state, &LoadSoundOnFirstUse, sound))
+		return sound->m_sound;
+	return sound_place_holder.m_sound;
+}
+
+static Music CreateUnloadedMusic(const char* path)
+{
+	Music tmp = { 0 };
+	tmp.m_path = fs_create_path(path);
+	fs_stem(path, tmp.m_name, MAX_PATH_SIZE);
+	ToLower(tmp.m_name);
+	tmp.m_load_state = RESOURCE_UNLOADED;
+	return tmp;
+}
+
+static void LoadMusicOnFirstUse(void* resource)
+{
+	Music* music = resource;
+	Music loaded = CreateMusic(music->m_path.path_data.m_path);
+	music->m_music = loaded.m_music;
+	music->m_data = loaded.m_data;
+	music->m_data_size = loaded.m_data_size;
+}
+
+static sfMusic* RequireMusic(Music* music)
+{
+	if (__RequireResource(&music->m_load_state, &LoadMusicOnFirstUse, music))
+		return music->m_music;
+	return music_place_holder.m_music;
+}
+
+static size_t GetSoundMemorySize(const Sound* sound)
+{
+	return (size_t)sfSoundBuffer_getSampleCount(sound->m_sound_buffer) * sizeof(sfInt16);
+}
+
+static void DestroyCachedSound(void* sound)
+{
+	DeleteSound(sound);
+}
+
+// Instead of being destroyed with its scene, the sound waits in the cache in case a next scene uses it again.
+static void RetireSound(Sound* sound)
+{
+	sfSound_stop(sound->m_sound);
+	sound_cache->Store(sound_cache, sound->m_name, sound->m_path.path_data.m_path, sound, sound->m_sound, GetSoundMemorySize(sound));
+}
+
+static Sound TakeOrCreateSound(const char* path)
+{
+	Sound tmp;
+	if (!sound_cache->Take(sound_cache, path, &tmp))
+		tmp = CreateSound(path);
+	return tmp;
+}
+
+static size_t GetMusicMemorySize(const Music* music)
+{
+	return music->m_data_size;
+}
+
+static void DestroyCachedMusic(void* music)
+{
+	DeleteMusic(music);
+}
+
+// Instead of being destroyed with its scene, the music waits in the cache in case a next scene uses it again.
+static void RetireMusic(Music* music)
+{
+	sfMusic_stop(music->m_music);
+	music_cache->Store(music_cache, music->m_name, music->m_path.path_data.m_path, music, music->m_music, GetMusicMemorySize(music));
+}
+
+static Music TakeOrCreateMusic(const char* path)
+{
+	Music tmp;
+	if (!music_cache->Take(music_cache, path, &tmp))
+		tmp = CreateMusic(path);
+	return tmp;
+}
+
+// The global list is complete, its entries no longer move.
+static void RegisterGlobalSounds(void)
+{
+	sound_registry = CreateResourceRegistry();
+	// Registered first, so the handle of an identifier is the identifier plus one.
+	for (int i = 0; i < SOUND_ID_COUNT; i++)
+		sound_registry->GetHandle(sound_registry, sound_id_names[i], NULL);
+	FOR_EACH_LIST(global_sound_list, Sound, it, tmp,
+		sound_registry->AddGlobalResource(sound_registry, tmp->m_name, tmp);
+		)
+}
+
+// The global list is complete, its entries no longer move.
+static void RegisterGlobalMusics(void)
+{
+	music_registry = CreateResourceRegistry();
+	// Registered first, so the handle of an identifier is the identifier plus one.
+	for (int i = 0; i < MUSIC_ID_COUNT; i++)
+		music_registry->GetHandle(music_registry, music_id_names[i], NULL);
+	FOR_EACH_LIST(global_music_list, Music, it, tmp,
+		music_registry->AddGlobalResource(music_registry, tmp->m_name, tmp);
+		)
 }
 
 void InitSoundManager(void)
@@ -71,7 +217,7 @@ void InitSoundManager(void)
 			strcpy_s(resources_path, MAX_PATH_SIZE, resource_directory);
 		strcat_s(resources_path, MAX_PATH_SIZE, "/ALL/Sounds");
 		Path fs_path = fs_create_path(resources_path);
-		if (fs_path.exist(&fs_path))
+		if ((fs_path.exist(&fs_path) || IsPackedDirectory(fs_path.path_data.m_path)))
 		{
 			if (global_sound_list == NULL)
 			{
@@ -79,13 +225,17 @@ void InitSoundManager(void)
 
 				global_sound_list = stdList_Create(sizeof(Sound), 0);
 				scene_sound_list = stdList_Create(sizeof(Sound), 0);
+				prefetch_sound_list = stdList_Create(sizeof(Sound), 0);
 				FOR_EACH_TEMP_LIST(filesInfos, FilesInfo, SearchFilesInfos(fs_path.path_data.m_path, "wav"),
-					Sound tmp = CreateSound(STD_GETDATA(filesInfos, FilesInfo, i)->m_path);
+					const char* file_path = STD_GETDATA(filesInfos, FilesInfo, i)->m_path;
+					Sound tmp = __IsLoadedEagerly(file_path) ? CreateSound(file_path) : CreateUnloadedSound(file_path);
 				if (strcmp(tmp.m_name, "placeholder") == 0)
 					sound_place_holder = tmp;
 				else
 					global_sound_list->push_back(global_sound_list, &tmp);
 					)
+				RegisterGlobalSounds();
+				sound_cache = CreateResourceCache(sizeof(Sound), sound_registry, &DestroyCachedSound, sound_budget);
 			}
 		}
 		else
@@ -98,7 +248,7 @@ void InitSoundManager(void)
 		strcpy_s(resources_path, MAX_PATH_SIZE, resource_directory);
 	strcat_s(resources_path, MAX_PATH_SIZE, "/ALL/Musics");
 	Path fs_path = fs_create_path(resources_path);
-	if (fs_path.exist(&fs_path))
+	if ((fs_path.exist(&fs_path) || IsPackedDirectory(fs_path.path_data.m_path)))
 	{
 		if (global_music_list == NULL)
 		{
@@ -106,13 +256,17 @@ void InitSoundManager(void)
 
 			global_music_list = stdList_Create(sizeof(Music), 0);
 			scene_music_list = stdList_Create(sizeof(Music), 0);
+			prefetch_music_list = stdList_Create(sizeof(Music), 0);
 			FOR_EACH_TEMP_LIST(filesInfos, FilesInfo, SearchFilesInfos(fs_path.path_data.m_path, "ogg"),
-				Music tmp = CreateMusic(STD_GETDATA(filesInfos, FilesInfo, i)->m_path);
+				const char* file_path = STD_GETDATA(filesInfos, FilesInfo, i)->m_path;
+				Music tmp = __IsLoadedEagerly(file_path) ? CreateMusic(file_path) : CreateUnloadedMusic(file_path);
 			if (strcmp(tmp.m_name, "placeholder") == 0)
 				music_place_holder = tmp;
 			else
 				global_music_list->push_back(global_music_list, &tmp);
 				)
+			RegisterGlobalMusics();
+			music_cache = CreateResourceCache(sizeof(Music), music_registry, &DestroyCachedMusic, music_budget);
 		}
 	}
 	else
@@ -123,96 +277,248 @@ void InitSoundManager(void)
 }
 
 
-void LoadSound(const char* path)
+void LoadSound(const char* path, const CancelToken* cancel_token)
 {
-	Sound tmp = CreateSound(path);
+	Sound tmp = TakeOrCreateSound(path);
+	if (IsLoadCancelled(cancel_token))
+	{
+		RetireSound(&tmp);
+		return;
+	}
+	AcquireSRWLockExclusive(&sound_list_lock);
 	scene_sound_list->push_back(scene_sound_list, &tmp);
+	ReleaseSRWLockExclusive(&sound_list_lock);
+	sound_registry->AddSceneResource(sound_registry, tmp.m_name, tmp.m_sound);
 }
 
-void LoadMusic(const char* path)
+void LoadMusic(const char* path, const CancelToken* cancel_token)
 {
-	Music tmp = CreateMusic(path);
+	Music tmp = TakeOrCreateMusic(path);
+	if (IsLoadCancelled(cancel_token))
+	{
+		RetireMusic(&tmp);
+		return;
+	}
+	AcquireSRWLockExclusive(&sound_list_lock);
 	scene_music_list->push_back(scene_music_list, &tmp);
+	ReleaseSRWLockExclusive(&sound_list_lock);
+	music_registry->AddSceneResource(music_registry, tmp.m_name, tmp.m_music);
 }
 
 
 
-void LoadSceneSound(const char* scene, float* soundProgressValue, float* musicProgressValue)
+void LoadSceneSound(const char* scene, SceneLoader* loader)
 {
 	ClearSceneSound();
-	__LoadScene(scene, "wav", "Sounds",soundProgressValue ,&LoadSound);
-	__LoadScene(scene, "ogg", "Musics",musicProgressValue ,&LoadMusic);
+	__LoadScene(scene, SOUND_EXTENSION, SOUND_DIRECTORY, loader, &LoadSound);
+	__LoadScene(scene, MUSIC_EXTENSION, MUSIC_DIRECTORY, loader, &LoadMusic);
+}
+
+static void PrefetchSound(const char* path, const CancelToken* cancel_token)
+{
+	Sound tmp = TakeOrCreateSound(path);
+	if (IsLoadCancelled(cancel_token))
+	{
+		RetireSound(&tmp);
+		return;
+	}
+	AcquireSRWLockExclusive(&sound_list_lock);
+	prefetch_sound_list->push_back(prefetch_sound_list, &tmp);
+	ReleaseSRWLockExclusive(&sound_list_lock);
+}
+
+static void PrefetchMusic(const char* path, const CancelToken* cancel_token)
+{
+	Music tmp = TakeOrCreateMusic(path);
+	if (IsLoadCancelled(cancel_token))
+	{
+		RetireMusic(&tmp);
+		return;
+	}
+	AcquireSRWLockExclusive(&sound_list_lock);
+	prefetch_music_list->push_back(prefetch_music_list, &tmp);
+	ReleaseSRWLockExclusive(&sound_list_lock);
+}
+
+void PrefetchSceneSound(const char* scene, SceneLoader* loader)
+{
+	ClearPrefetchedSceneSound();
+	__LoadScene(scene, SOUND_EXTENSION, SOUND_DIRECTORY, loader, &PrefetchSound);
+	__LoadScene(scene, MUSIC_EXTENSION, MUSIC_DIRECTORY, loader, &PrefetchMusic);
+}
+
+void CommitPrefetchedSceneSound(void)
+{
+	ClearSceneSound();
+	stdList* tmp = scene_sound_list;
+	scene_sound_list = prefetch_sound_list;
+	prefetch_sound_list = tmp;
+	FOR_EACH_LIST(scene_sound_list, Sound, it, scene_sound,
+		sound_registry->AddSceneResource(sound_registry, scene_sound->m_name, scene_sound->m_sound);
+		)
+	tmp = scene_music_list;
+	scene_music_list = prefetch_music_list;
+	prefetch_music_list = tmp;
+	FOR_EACH_LIST(scene_music_list, Music, it, scene_music,
+		music_registry->AddSceneResource(music_registry, scene_music->m_name, scene_music->m_music);
+		)
+}
+
+void ClearPrefetchedSceneSound(void)
+{
+	if (prefetch_sound_list != NULL)
+	{
+		for (int i = 0; i < prefetch_sound_list->size(prefetch_sound_list); i++)
+			RetireSound(STD_GETDATA(prefetch_sound_list, Sound, i));
+		prefetch_sound_list->clear(prefetch_sound_list);
+	}
+	if (prefetch_music_list != NULL)
+	{
+		for (int i = 0; i < prefetch_music_list->size(prefetch_music_list); i++)
+			RetireMusic(STD_GETDATA(prefetch_music_list, Music, i));
+		prefetch_music_list->clear(prefetch_music_list);
+	}
 }
 
 void ClearSceneSound(void)
 {
 	if (scene_sound_list != NULL)
 	{
+		sound_registry->ClearSceneResources(sound_registry);
 		for (int i = 0; i < scene_sound_list->size(scene_sound_list); i++)
-		{
-			sfSound_destroy(STD_GETDATA(scene_sound_list, Sound, i)->m_sound);
-			sfSoundBuffer_destroy(STD_GETDATA(scene_sound_list, Sound, i)->m_sound_buffer);
-		}
+			RetireSound(STD_GETDATA(scene_sound_list, Sound, i));
 		scene_sound_list->clear(scene_sound_list);
 	}
 	if (scene_music_list != NULL)
 	{
+		music_registry->ClearSceneResources(music_registry);
 		for (int i = 0; i < scene_music_list->size(scene_music_list); i++)
-		{
-			sfMusic_destroy(STD_GETDATA(scene_music_list, Music, i)->m_music);
-		}
+			RetireMusic(STD_GETDATA(scene_music_list, Music, i));
 		scene_music_list->clear(scene_music_list);
 	}
 }
 
-sfSound* GetSound(const char* name)
+void SetSoundBudget(size_t budget)
 {
-	if (global_sound_list != NULL)
-		FOR_EACH_LIST(global_sound_list, Sound, it, tmp,
-			if (strcmp(tmp->m_name, name) == 0)
-				return tmp->m_sound;
-				)
+	sound_budget = budget;
+	if (sound_cache)
+		sound_cache->SetBudget(sound_cache, budget);
+}
 
-		if (scene_sound_list != NULL)
-			FOR_EACH_LIST(scene_sound_list, Sound, it, tmp,
-				if (strcmp(tmp->m_name, name) == 0)
-					return tmp->m_sound;
-					)
+ResourceHandle GetSoundHandle(const char* name)
+{
+	return sound_registry ? sound_registry->GetHandle(sound_registry, name, NULL) : INVALID_RESOURCE_HANDLE;
+}
 
-			if (sound_place_holder.m_sound)
-			{
-				printf_d("Sound %s not found, placeholder returned", name);
-				return sound_place_holder.m_sound;
-			}
+sfSound* GetSoundById(SoundId id)
+{
+	return GetSoundFromHandle((ResourceHandle)id + 1);
+}
 
-	printf_d("No Sound placeholder found, put a placeholder.wav in your %s/ALL/Sounds folder", resource_directory);
-	return NULL;
+sfSound* GetSoundFromHandle(ResourceHandle handle)
+{
+	ResourceEntry* entry = sound_registry ? sound_registry->GetEntry(sound_registry, handle) : NULL;
+	if (entry)
+	{
+		if (entry->m_global_resource)
+			return RequireSound(entry->m_global_resource);
+		if (entry->m_scene_resource)
+			return entry->m_scene_resource;
+	}
+	return sound_place_holder.m_sound;
 }
 
-sfMusic* GetMusic(const char* name)
+sfSound* GetSound(const char* name)
 {
-	if (global_music_list != NULL)
-		FOR_EACH_LIST(global_music_list, Music, it, tmp,
-			if (strcmp(tmp->m_name, name) == 0)
-				return tmp->m_music;
-				)
+	sfBool is_new = sfFalse;
+	ResourceHandle handle = sound_registry ? sound_registry->GetHandle(sound_registry, name, &is_new) : INVALID_RESOURCE_HANDLE;
+	sfSound* sound = GetSoundFromHandle(handle);
+	if (!sound)
+		printf_d("No Sound placeholder found, put a placeholder.wav in your %s/ALL/Sounds folder", resource_directory);
+	// Only the first lookup of a missing name prints, the next ones hit its empty entry.
+	else if (is_new && sound == sound_place_holder.m_sound)
+		printf_d("Sound %s not found, placeholder returned", name);
+	return sound;
+}
 
-		if (scene_music_list != NULL)
-			FOR_EACH_LIST(scene_music_list, Music, it, tmp,
-				if (strcmp(tmp->m_name, name) == 0)
-					return tmp->m_music;
-					)
+void SetMusicBudget(size_t budget)
+{
+	music_budget = budget;
+	if (music_cache)
+		music_cache->SetBudget(music_cache, budget);
+}
 
-			if (music_place_holder.m_music)
-			{
-				printf_d("Music %s not found, placeholder returned", name);
-				return music_place_holder.m_music;
-			}
+ResourceHandle GetMusicHandle(const char* name)
+{
+	return music_registry ? music_registry->GetHandle(music_registry, name, NULL) : INVALID_RESOURCE_HANDLE;
+}
+
+sfMusic* GetMusicById(MusicId id)
+{
+	return GetMusicFromHandle((ResourceHandle)id + 1);
+}
+
+sfMusic* GetMusicFromHandle(ResourceHandle handle)
+{
+	ResourceEntry* entry = music_registry ? music_registry->GetEntry(music_registry, handle) : NULL;
+	if (entry)
+	{
+		if (entry->m_global_resource)
+			return RequireMusic(entry->m_global_resource);
+		if (entry->m_scene_resource)
+			return entry->m_scene_resource;
+	}
+	return music_place_holder.m_music;
+}
 
-	printf_d("No Music placeholder found, put a placeholder.ogg in your %s/ALL/Musics folder", resource_directory);
+sfMusic* GetMusic(const char* name)
+{
+	sfBool is_new = sfFalse;
+	ResourceHandle handle = music_registry ? music_registry->GetHandle(music_registry, name, &is_new) : INVALID_RESOURCE_HANDLE;
+	sfMusic* music = GetMusicFromHandle(handle);
+	if (!music)
+		printf_d("No Music placeholder found, put a placeholder.ogg in your %s/ALL/Musics folder", resource_directory);
+	// Only the first lookup of a missing name prints, the next ones hit its empty entry.
+	else if (is_new && music == music_place_holder.m_music)
+		printf_d("Music %s not found, placeholder returned", name);
+	return music;
+}
+
+static Sound* FindLoadedSound(const char* path)
+{
+	if (sound_place_holder.m_sound && fs_path_equals(sound_place_holder.m_path.path_data.m_path, path))
+		return &sound_place_holder;
+	if (global_sound_list != NULL)
+		FOR_EACH_LIST(global_sound_list, Sound, it, tmp,
+			if (tmp->m_load_state == RESOURCE_LOADED && fs_path_equals(tmp->m_path.path_data.m_path, path))
+				return tmp;
+				)
+	if (scene_sound_list != NULL)
+		FOR_EACH_LIST(scene_sound_list, Sound, it, tmp,
+			if (fs_path_equals(tmp->m_path.path_data.m_path, path))
+				return tmp;
+				)
 	return NULL;
 }
 
+sfBool ReloadSoundBuffer(const char* path, sfSoundBuffer* sound_buffer)
+{
+	AcquireSRWLockShared(&sound_list_lock);
+	Sound* loaded_sound = FindLoadedSound(path);
+	if (loaded_sound)
+	{
+		sfSoundBuffer* old_sound_buffer = loaded_sound->m_sound_buffer;
+		sfSound_setBuffer(loaded_sound->m_sound, sound_buffer);
+		loaded_sound->m_sound_buffer = sound_buffer;
+		sound_buffer = old_sound_buffer;
+	}
+	ReleaseSRWLockShared(&sound_list_lock);
+	sfSoundBuffer_destroy(sound_buffer);
+	// A cached copy would be taken back by the next scene with the old samples.
+	sfBool is_evicted = sound_cache->Evict(sound_cache, path);
+	return loaded_sound || is_evicted ? sfTrue : sfFalse;
+}
+
 void DestroySoundsManager(void)
 {
 	ClearSceneSound();
@@ -236,4 +542,11 @@ void DestroySoundsManager(void)
 		global_music_list->destroy(&global_music_list);
 	}
 	scene_music_list->destroy(&scene_music_list);
+	ClearPrefetchedSceneSound();
+	prefetch_sound_list->destroy(&prefetch_sound_list);
+	prefetch_music_list->destroy(&prefetch_music_list);
+	sound_cache->Destroy(&sound_cache);
+	music_cache->Destroy(&music_cache);
+	sound_registry->Destroy(&sound_registry);
+	music_registry->Destroy(&music_registry);
 }
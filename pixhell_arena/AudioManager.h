@@ -22,12 +22,50 @@
 */
 #pragma once
 #include "Tools.h"
+#include "ResourceCache.h"
+#include "ResourceIds.h"
 
 /**
  * @file audiomanager.h
  * @brief This file contains all the data to load sounds and musics for the engine.
  */
 
+/**
+ * @def SOUND_EXTENSION
+ * @brief Extension of the sound files.
+ */
+#define SOUND_EXTENSION "wav"
+
+/**
+ * @def SOUND_DIRECTORY
+ * @brief Name of the sounds directory inside a scene directory.
+ */
+#define SOUND_DIRECTORY "Sounds"
+
+/**
+ * @def MUSIC_EXTENSION
+ * @brief Extension of the music files.
+ */
+#define MUSIC_EXTENSION "ogg"
+
+/**
+ * @def MUSIC_DIRECTORY
+ * @brief Name of the musics directory inside a scene directory.
+ */
+#define MUSIC_DIRECTORY "Musics"
+
+/**
+ * @def DEFAULT_SOUND_BUDGET
+ * @brief Default size in bytes of the sounds of the previous scenes kept loaded, see SetSoundBudget.
+ */
+#define DEFAULT_SOUND_BUDGET (32 * 1024 * 1024)
+
+/**
+ * @def DEFAULT_MUSIC_BUDGET
+ * @brief Default size in bytes of the musics of the previous scenes kept loaded, see SetMusicBudget.
+ */
+#define DEFAULT_MUSIC_BUDGET (16 * 1024 * 1024)
+
 
 /**
  * @struct Sound
@@ -40,6 +78,7 @@ struct Sound
     sfSound* m_sound;             /**< Pointer to the sound instance for playback. */
     Path m_path;                  /**< Path to the sound file. */
     char m_name[MAX_PATH_SIZE];   /**< Name of the sound, typically used for identification. */
+    volatile LONG m_load_state;   /**< ResourceLoadState of the sound, see __RequireResource. */
 };
 
 /**
@@ -52,6 +91,9 @@ struct Music
     sfMusic* m_music;            /**< Pointer to the music instance for playback. */
     Path m_path;                 /**< Path to the music file. */
     char m_name[MAX_PATH_SIZE];  /**< Name of the music, typically used for identification. */
+    void* m_data;                /**< Copy of the music file, the music streams from it until it is destroyed. NULL for a packed music, see ReadResourceFile. */
+    size_t m_data_size;          /**< Size in bytes of the music file. */
+    volatile LONG m_load_state;  /**< ResourceLoadState of the music, see __RequireResource. */
 };
 
 /**
@@ -89,15 +131,34 @@ void InitSoundManager(void);
 /**
  * @brief Loads sounds associated with a specific scene.
  * @param scene Name of the scene for which sounds should be loaded.
+ * @param loader Loader the files are queued on, they load once it is started.
  */
-void LoadSceneSound(const char* scene, float* soundProgressValue, float* musicProgressValue);
+void LoadSceneSound(const char* scene, SceneLoader* loader);
 
 /**
  * @brief Clears all sounds associated with the current scene.
- * This function frees memory and unloads scene-specific sounds.
+ * They are handed to the cache of the manager, the next scenes take them back without loading them again.
  */
 void ClearSceneSound(void);
 
+/**
+ * @brief Loads the sounds and musics of a scene into separate lists, without touching the ones of the current scene.
+ * @param scene Name of the scene for which sounds and musics should be prefetched.
+ * @param loader Loader the files are queued on, they load once it is started.
+ */
+void PrefetchSceneSound(const char* scene, SceneLoader* loader);
+
+/**
+ * @brief Replaces the sounds and musics of the current scene by the prefetched ones.
+ * The sounds and musics of the previous scene are freed.
+ */
+void CommitPrefetchedSceneSound(void);
+
+/**
+ * @brief Frees the prefetched sounds and musics that were never committed.
+ */
+void ClearPrefetchedSceneSound(void);
+
 /**
  * @brief Retrieves a sound instance by its name.
  * @param name Name of the sound to retrieve.
@@ -105,6 +166,27 @@ void ClearSceneSound(void);
  */
 sfSound* GetSound(const char* name);
 
+/**
+ * @brief Retrieves the stable handle of a sound name, to resolve it every frame with GetSoundFromHandle instead of looking the name up.
+ * @param name Name of the sound, compared without case. It does not have to be loaded yet.
+ * @return The handle of the name.
+ */
+ResourceHandle GetSoundHandle(const char* name);
+
+/**
+ * @brief Retrieves a sound instance by its handle, without any name lookup.
+ * @param handle Handle returned by GetSoundHandle.
+ * @return Pointer to the sound instance, or the placeholder while no sound of that name is loaded.
+ */
+sfSound* GetSoundFromHandle(ResourceHandle handle);
+
+/**
+ * @brief Retrieves a sound instance by its generated identifier, see ResourceIds.h. A renamed or removed sound fails to compile instead of returning the placeholder.
+ * @param id Identifier of the sound.
+ * @return Pointer to the sound instance, or the placeholder while it is not loaded.
+ */
+sfSound* GetSoundById(SoundId id);
+
 /**
  * @brief Retrieves a music instance by its name.
  * @param name Name of the music to retrieve.
@@ -112,6 +194,48 @@ sfSound* GetSound(const char* name);
  */
 sfMusic* GetMusic(const char* name);
 
+/**
+ * @brief Retrieves the stable handle of a music name, to resolve it every frame with GetMusicFromHandle instead of looking the name up.
+ * @param name Name of the music, compared without case. It does not have to be loaded yet.
+ * @return The handle of the name.
+ */
+ResourceHandle GetMusicHandle(const char* name);
+
+/**
+ * @brief Retrieves a music instance by its handle, without any name lookup.
+ * @param handle Handle returned by GetMusicHandle.
+ * @return Pointer to the music instance, or the placeholder while no music of that name is loaded.
+ */
+sfMusic* GetMusicFromHandle(ResourceHandle handle);
+
+/**
+ * @brief Retrieves a music instance by its generated identifier, see ResourceIds.h. A renamed or removed music fails to compile instead of returning the placeholder.
+ * @param id Identifier of the music.
+ * @return Pointer to the music instance, or the placeholder while it is not loaded.
+ */
+sfMusic* GetMusicById(MusicId id);
+
+/**
+ * @brief Sets the size of the sounds of the previous scenes kept loaded. The least recently used ones are destroyed over it.
+ * @param budget Budget in bytes, DEFAULT_SOUND_BUDGET by default.
+ */
+void SetSoundBudget(size_t budget);
+
+/**
+ * @brief Sets the size of the musics of the previous scenes kept loaded. The least recently used ones are destroyed over it.
+ * @param budget Budget in bytes, DEFAULT_MUSIC_BUDGET by default.
+ */
+void SetMusicBudget(size_t budget);
+
+/**
+ * @brief Replaces the buffer of the loaded sound created from path, used by the hot reload.
+ * The sfSound returned by GetSound stays the same and plays the new buffer. Must be called from the main thread.
+ * @param path Path of the sound file.
+ * @param sound_buffer Buffer decoded from the modified file. Owned by the sound on success, destroyed otherwise.
+ * @return sfTrue if a loaded or cached sound was created from path, sfFalse otherwise. The cached one is destroyed.
+ */
+sfBool ReloadSoundBuffer(const char* path, sfSoundBuffer* sound_buffer);
+
 /**
  * @brief Destroys the sound manager and releases all associated resources.
  */
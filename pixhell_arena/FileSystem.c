@@ -21,20 +21,16 @@
 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #include "FileSystem.h"
+#include <ctype.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#endif
 
 
-static void reverseString(char* str, int len, int i, int temp)
-{
-	if (i < len) {
-		temp = str[i];
-		str[i] = str[len - 1];
-		str[len - 1] = temp;
-		i++;
-		len--;
-		reverseString(str, len, i, temp);
-	}
-}
-
 static void convertToW_Char(wchar_t* output, const char* copied)
 {
 	size_t outsize, size = strlen(copied);
@@ -47,79 +43,147 @@ static void convertToChar(char* output, wchar_t* copied)
 	wcstombs_s(&outsize, output, size + 1, copied, size);
 }
 
+static fsBool is_separator(char c)
+{
+	return c == '\\' || c == '/';
+}
 
+fs_file_type fs_status(const char* path)
+{
+#ifdef _WIN32
+	DWORD attributes = GetFileAttributesA(path);
+	if (attributes == INVALID_FILE_ATTRIBUTES)
+		return FS_TYPE_NONE;
+	return (attributes & FILE_ATTRIBUTE_DIRECTORY) ? FS_TYPE_DIRECTORY : FS_TYPE_FILE;
+#else
+	struct stat path_stat;
+	if (stat(path, &path_stat) != 0)
+		return FS_TYPE_NONE;
+	return S_ISDIR(path_stat.st_mode) ? FS_TYPE_DIRECTORY : FS_TYPE_FILE;
+#endif
+}
 
-fsBool exist(Path* path)
+fs_path_view fs_view(const char* path)
 {
-	fsBool result = is_file(path);
-	if (!result)
-		result = is_directory(path);
+	fs_path_view view = { path, strlen(path) };
+	return view;
+}
 
-	return result;
+fs_path_view fs_view_filename(fs_path_view path)
+{
+	size_t start = path.m_length;
+	while (start > 0 && !is_separator(path.m_data[start - 1]))
+		start--;
+	fs_path_view view = { path.m_data + start, path.m_length - start };
+	return view;
 }
 
-fsBool is_directory(Path* path)
+fs_path_view fs_view_stem(fs_path_view path)
 {
-	DIR* dir = opendir(path->path_data.m_path);
-	if (dir)
+	fs_path_view view = fs_view_filename(path);
+	for (size_t i = view.m_length; i > 1; i--)
 	{
-		closedir(dir);
-		return TRUE;
+		if (view.m_data[i - 1] == '.')
+		{
+			view.m_length = i - 1;
+			break;
+		}
 	}
-	return FALSE;
+	return view;
 }
 
-fsBool is_file(Path* path)
+fs_path_view fs_view_extension(fs_path_view path)
 {
-	FILE* file = NULL;
-	errno_t error_code = fopen_s(&file, path->path_data.m_path, "r");
-	if (error_code == 0)
+	fs_path_view file_name = fs_view_filename(path);
+	fs_path_view stem = fs_view_stem(path);
+	fs_path_view view = { file_name.m_data + file_name.m_length, 0 };
+	if (stem.m_length < file_name.m_length)
 	{
-		fclose(file);
-		return TRUE;
+		view.m_data = stem.m_data + stem.m_length + 1;
+		view.m_length = file_name.m_length - stem.m_length - 1;
 	}
-	return FALSE;
+	return view;
+}
+
+fs_path_view fs_view_parent(fs_path_view path)
+{
+	fs_path_view view = { path.m_data, path.m_length - fs_view_filename(path).m_length };
+	if (view.m_length > 0)
+		view.m_length--;
+	return view;
+}
+
+fsBool fs_view_equals(fs_path_view view, const char* string)
+{
+	return strncmp(view.m_data, string, view.m_length) == 0 && string[view.m_length] == '\0';
+}
+
+fsBool fs_path_equals(const char* left, const char* right)
+{
+	for (; *left && *right; left++, right++)
+	{
+		if (is_separator(*left) && is_separator(*right))
+			continue;
+		if (tolower((unsigned char)*left) != tolower((unsigned char)*right))
+			return FALSE;
+	}
+	return *left == *right;
+}
+
+void fs_view_copy(fs_path_view view, char* buffer, size_t size)
+{
+	strncpy_s(buffer, size, view.m_data, view.m_length < size ? view.m_length : _TRUNCATE);
+}
+
+static Path create_path_from_view(fs_path_view view)
+{
+	NEW_CHAR(tmp, MAX_PATH_SIZE)
+		fs_view_copy(view, tmp, MAX_PATH_SIZE);
+	return fs_create_path(tmp);
+}
+
+// The dirent d_type already tells what the entry is, only links and unknown types need a query.
+static fs_file_type entry_type(const char* path, const struct dirent* entry)
+{
+	if (entry->d_type == DT_REG)
+		return FS_TYPE_FILE;
+	if (entry->d_type == DT_DIR)
+		return FS_TYPE_DIRECTORY;
+	return fs_status(path);
+}
+
+
+
+fsBool exist(Path* path)
+{
+	return fs_status(path->path_data.m_path) != FS_TYPE_NONE;
+}
+
+fsBool is_directory(Path* path)
+{
+	return fs_status(path->path_data.m_path) == FS_TYPE_DIRECTORY;
+}
+
+fsBool is_file(Path* path)
+{
+	return fs_status(path->path_data.m_path) == FS_TYPE_FILE;
 }
 
 Path extension(Path* path)
 {
-	NEW_CHAR(extension, MAX_PATH_SIZE)
-		if (is_file(path))
-		{
-			int index_extension = 0, index_path = (int)path->path_data.length - 1;
-			while (path->path_data.m_path[index_path] != '.')
-			{
-				extension[index_extension] = path->path_data.m_path[index_path];
-				index_path--;
-				index_extension++;
-			}
-			reverseString(extension, (int)strlen(extension), 0, 0);
-		}
-	return fs_create_path(extension);
+	if (is_file(path))
+		return create_path_from_view(fs_view_extension(fs_view(path->path_data.m_path)));
+	return fs_create_path("");
 }
 
 
 Path parent(Path* path)
 {
-	NEW_CHAR(tmp, MAX_PATH_SIZE)
-		for (int i = (int)path->path_data.length; i > 0; i--)
-		{
-			if (path->path_data.m_path[i] == '/' || path->path_data.m_path[i] == '\\')
-			{
-				i--;
-				int index = 0;
-				while (i >= 0)
-				{
-					tmp[index] = path->path_data.m_path[i];
-					i--;
-					index++;
-				}
-				reverseString(tmp, (int)strlen(tmp), 0, 0);
-				break;
-			}
-		}
+	fs_path_view parent_view = fs_view_parent(fs_view(path->path_data.m_path));
+	if (parent_view.m_length == 0)
+		return *path;
 
-	Path parent = fs_create_path(tmp);
+	Path parent = create_path_from_view(parent_view);
 	if (exist(&parent))
 		return parent;
 	return *path;
@@ -140,9 +204,11 @@ stdList* fs_iterator_directory(Path* path)
 			strcat_s(new_entry_path, strlen(new_entry_path) + 2, "\\");
 			strcat_s(new_entry_path, strlen(new_entry_path) + strlen(dir->d_name) + 1, dir->d_name);
 
-			Path new_entry = fs_create_path(new_entry_path);
-			if (is_file(&new_entry))
+			if (entry_type(new_entry_path, dir) == FS_TYPE_FILE)
+			{
+				Path new_entry = fs_create_path(new_entry_path);
 				list->push_back(list, &new_entry);
+			}
 		}
 		closedir(d);
 	}
@@ -165,10 +231,13 @@ static stdList* recursive_iterator_directory__(Path* path, stdList* list)
 			strcat_s(new_entry_path, strlen(new_entry_path) + 2, "\\");
 			strcat_s(new_entry_path, strlen(new_entry_path) + strlen(dir->d_name) + 1, dir->d_name);
 
+			fs_file_type type = entry_type(new_entry_path, dir);
+			if (type == FS_TYPE_NONE)
+				continue;
 			Path new_entry = fs_create_path(new_entry_path);
-			if (is_file(&new_entry))
+			if (type == FS_TYPE_FILE)
 				list->push_back(list, &new_entry);
-			else if (is_directory(&new_entry))
+			else
 				recursive_iterator_directory__(&new_entry, list);
 
 		}
@@ -186,42 +255,88 @@ stdList* fs_recursive_iterator_directory(Path* path)
 	return list;
 }
 
-static Path filename(Path* path)
+void fs_stem(const char* path, char* stem, size_t size)
 {
-	NEW_CHAR(tmp_filename, MAX_PATH_SIZE)
-		size_t index = path->path_data.length - 1;
-	size_t index_new_path = 0;
-	while (path->path_data.m_path[index] != '\\' && path->path_data.m_path[index] != '/')
+	fs_view_copy(fs_view_stem(fs_view(path)), stem, size);
+}
+
+#ifdef _WIN32
+fsBool fs_map_file(const char* path, fs_mapped_file* mapped_file)
+{
+	mapped_file->m_data = NULL;
+	mapped_file->m_size = 0;
+
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return FALSE;
+
+	LARGE_INTEGER file_size;
+	HANDLE mapping = NULL;
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	// The view keeps the mapping and the file alive, both handles can be closed right away.
+	if (mapping)
 	{
-		tmp_filename[index_new_path] = path->path_data.m_path[index];
-		index_new_path++;
-		index--;
+		mapped_file->m_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
 	}
-	return fs_create_path(_strrev(tmp_filename));
+	CloseHandle(file);
+
+	if (!mapped_file->m_data)
+		return FALSE;
+	mapped_file->m_size = (size_t)file_size.QuadPart;
+	return TRUE;
 }
 
-static Path stem(Path* path)
+void fs_unmap_file(fs_mapped_file* mapped_file)
 {
-	if (path->is_file(path))
+	if (mapped_file->m_data)
+		UnmapViewOfFile(mapped_file->m_data);
+	mapped_file->m_data = NULL;
+	mapped_file->m_size = 0;
+}
+#else
+fsBool fs_map_file(const char* path, fs_mapped_file* mapped_file)
+{
+	mapped_file->m_data = NULL;
+	mapped_file->m_size = 0;
+
+	int file = open(path, O_RDONLY);
+	if (file < 0)
+		return FALSE;
+
+	struct stat file_stat;
+	if (fstat(file, &file_stat) == 0 && file_stat.st_size > 0)
 	{
-		Path filename = path->filename(path);
-		NEW_CHAR(tmp_file_path, MAX_PATH_SIZE)
-			size_t index = filename.path_data.length;
-		while (filename.path_data.m_path[index] != '.')
-		{
-			index--;
-		}
-		index--;
-		size_t index_new_path = 0;
-		while (index != 0)
+		void* data = mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (data != MAP_FAILED)
 		{
-			tmp_file_path[index_new_path] = filename.path_data.m_path[index];
-			index_new_path++;
-			index--;
+			mapped_file->m_data = data;
+			mapped_file->m_size = (size_t)file_stat.st_size;
 		}
-		tmp_file_path[index_new_path] = filename.path_data.m_path[index];
-		return fs_create_path(_strrev(tmp_file_path));
 	}
+	close(file);
+	return mapped_file->m_data ? TRUE : FALSE;
+}
+
+void fs_unmap_file(fs_mapped_file* mapped_file)
+{
+	if (mapped_file->m_data)
+		munmap((void*)mapped_file->m_data, mapped_file->m_size);
+	mapped_file->m_data = NULL;
+	mapped_file->m_size = 0;
+}
+#endif
+
+static Path filename(Path* path)
+{
+	return create_path_from_view(fs_view_filename(fs_view(path->path_data.m_path)));
+}
+
+static Path stem(Path* path)
+{
+	if (is_file(path))
+		return create_path_from_view(fs_view_stem(fs_view(path->path_data.m_path)));
 	return *path;
 }
 
@@ -348,7 +463,128 @@ fsBool fs_remove(const char* path)
 }
 
 
+// Former queries, kept to compare with: every entry was opened to be classified.
+static fsBool legacy_is_file(const char* path)
+{
+	FILE* file = NULL;
+	if (fopen_s(&file, path, "r") == 0)
+	{
+		fclose(file);
+		return TRUE;
+	}
+	return FALSE;
+}
 
+static fsBool legacy_is_directory(const char* path)
+{
+	DIR* dir = opendir(path);
+	if (dir)
+	{
+		closedir(dir);
+		return TRUE;
+	}
+	return FALSE;
+}
 
+// Walks like SearchFilesInfos used to: each file was opened once by the walk, then once more by extension() and by stem().
+static size_t legacy_walk(Path* path)
+{
+	size_t file_count = 0;
+	DIR* d = opendir(path->path_data.m_path);
+	if (!d)
+		return 0;
+	struct dirent* dir;
+	while ((dir = readdir(d)) != NULL)
+	{
+		if (strcmp(dir->d_name, ".") == 0 || strcmp(dir->d_name, "..") == 0)
+			continue;
+		NEW_CHAR(new_entry_path, MAX_PATH_SIZE)
+			sprintf_s(new_entry_path, MAX_PATH_SIZE, "%s\\%s", path->path_data.m_path, dir->d_name);
+		Path new_entry = fs_create_path(new_entry_path);
+		if (legacy_is_file(new_entry.path_data.m_path))
+		{
+			// extension() then stem() opened the file again.
+			legacy_is_file(new_entry.path_data.m_path);
+			legacy_is_file(new_entry.path_data.m_path);
+			file_count++;
+		}
+		else if (legacy_is_directory(new_entry.path_data.m_path))
+			file_count += legacy_walk(&new_entry);
+	}
+	closedir(d);
+	return file_count;
+}
 
+static double now_ms(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * 1000. / (double)frequency.QuadPart;
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec * 1000. + (double)time.tv_nsec / 1000000.;
+#endif
+}
 
+void fs_run_benchmark(const char* directory, size_t file_count)
+{
+	const size_t files_per_directory = 100;
+	if (fs_status(directory) != FS_TYPE_NONE || !fs_create_directory(directory))
+	{
+		printf("FileSystem benchmark: %s already exists or can't be created\n", directory);
+		return;
+	}
+
+	NEW_CHAR(entry_path, MAX_PATH_SIZE)
+	for (size_t i = 0; i < file_count; i++)
+	{
+		sprintf_s(entry_path, MAX_PATH_SIZE, "%s\\%03zu", directory, i / files_per_directory);
+		if (i % files_per_directory == 0)
+			fs_create_directory(entry_path);
+		sprintf_s(entry_path, MAX_PATH_SIZE, "%s\\%03zu\\file_%05zu.png", directory, i / files_per_directory, i);
+		FILE* file = NULL;
+		if (fopen_s(&file, entry_path, "wb") == 0)
+			fclose(file);
+	}
+
+	double start;
+	printf("FileSystem benchmark: %zu files in %zu directories\n", file_count, (file_count + files_per_directory - 1) / files_per_directory);
+
+	Path root = fs_create_path(directory);
+	start = now_ms();
+	size_t legacy_count = legacy_walk(&root);
+	double legacy_walk_time = now_ms() - start;
+
+	start = now_ms();
+	stdList* files = fs_recursive_iterator_directory(&root);
+	size_t view_count = 0;
+	for (int i = 0; i < files->size(files); i++)
+	{
+		fs_path_view file_view = fs_view(STD_GETDATA(files, Path, i)->path_data.m_path);
+		view_count += fs_view_equals(fs_view_extension(file_view), "png") && fs_view_stem(file_view).m_length > 0;
+	}
+	double walk_time = now_ms() - start;
+	printf("  walk + extension + stem: %9.3f ms -> %9.3f ms  x%.2f  (%zu / %zu files)\n", legacy_walk_time, walk_time, legacy_walk_time / walk_time, legacy_count, view_count);
+
+	start = now_ms();
+	size_t legacy_file_count = 0;
+	for (int i = 0; i < files->size(files); i++)
+	{
+		const char* path = STD_GETDATA(files, Path, i)->path_data.m_path;
+		legacy_file_count += legacy_is_file(path) || legacy_is_directory(path);
+	}
+	double legacy_query_time = now_ms() - start;
+
+	start = now_ms();
+	size_t status_file_count = 0;
+	for (int i = 0; i < files->size(files); i++)
+		status_file_count += fs_status(STD_GETDATA(files, Path, i)->path_data.m_path) != FS_TYPE_NONE;
+	double query_time = now_ms() - start;
+	printf("  exist on each file:      %9.3f ms -> %9.3f ms  x%.2f  (%zu / %zu files)\n", legacy_query_time, query_time, legacy_query_time / query_time, legacy_file_count, status_file_count);
+
+	files->destroy(&files);
+	fs_remove(directory);
+}
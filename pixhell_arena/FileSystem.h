@@ -138,6 +138,40 @@ struct Path
     Path(*filename)(Path* path);
 };
 
+/**
+ * @struct fs_path_view
+ * @brief Non-owning view on a part of a path string. Two words and no function pointers, cheap to pass and return by value.
+ */
+typedef struct fs_path_view fs_path_view;
+struct fs_path_view
+{
+    const char* m_data; /**< First character of the view, not null-terminated. */
+    size_t m_length; /**< Number of characters in the view. */
+};
+
+/**
+ * @enum fs_file_type
+ * @brief Type of a file system entry, as returned by fs_status.
+ */
+typedef enum fs_file_type fs_file_type;
+enum fs_file_type
+{
+    FS_TYPE_NONE, /**< The entry does not exist. */
+    FS_TYPE_FILE, /**< The entry is a file. */
+    FS_TYPE_DIRECTORY /**< The entry is a directory. */
+};
+
+/**
+ * @struct fs_mapped_file
+ * @brief Read-only view of a whole file mapped in memory.
+ */
+typedef struct fs_mapped_file fs_mapped_file;
+struct fs_mapped_file
+{
+    const void* m_data; /**< First byte of the mapped file, NULL when nothing is mapped. */
+    size_t m_size; /**< Size of the mapped file in bytes. */
+};
+
 /**
  * @brief Creates a Path object from a given string.
  * @param path String representing the file system path.
@@ -173,6 +207,103 @@ stdList* fs_iterator_directory(Path* path);
  */
 stdList* fs_recursive_iterator_directory(Path* path);
 
+/**
+ * @brief Classifies a path with a single stat query, without opening it.
+ * @param path String representing the file system path.
+ * @return The type of the entry, FS_TYPE_NONE if it does not exist.
+ */
+fs_file_type fs_status(const char* path);
+
+/**
+ * @brief Creates a view on a whole null-terminated path.
+ * @param path String representing the file system path, must outlive the view.
+ * @return A view on the path.
+ */
+fs_path_view fs_view(const char* path);
+
+/**
+ * @brief Retrieves the file name (with extension) of a path view.
+ * @param path View on the path.
+ * @return A view on the characters after the last separator.
+ */
+fs_path_view fs_view_filename(fs_path_view path);
+
+/**
+ * @brief Retrieves the stem (file name without extension) of a path view.
+ * @param path View on the path.
+ * @return A view on the file name up to its last dot.
+ */
+fs_path_view fs_view_stem(fs_path_view path);
+
+/**
+ * @brief Retrieves the extension, without the dot, of a path view.
+ * @param path View on the path.
+ * @return A view on the characters after the last dot of the file name, empty if there is none.
+ */
+fs_path_view fs_view_extension(fs_path_view path);
+
+/**
+ * @brief Retrieves the parent directory of a path view.
+ * @param path View on the path.
+ * @return A view on the characters before the last separator, empty if there is none.
+ */
+fs_path_view fs_view_parent(fs_path_view path);
+
+/**
+ * @brief Compares a path view with a null-terminated string.
+ * @param view View to compare.
+ * @param string String to compare with.
+ * @return TRUE if both hold the same characters, FALSE otherwise.
+ */
+fsBool fs_view_equals(fs_path_view view, const char* string);
+
+/**
+ * @brief Compares two paths the way Windows does, ignoring the case and the separator style.
+ * @param left First path.
+ * @param right Second path.
+ * @return TRUE if both name the same entry, FALSE otherwise.
+ */
+fsBool fs_path_equals(const char* left, const char* right);
+
+/**
+ * @brief Copies a path view in a null-terminated buffer, truncated to fit.
+ * @param view View to copy.
+ * @param buffer Buffer receiving the copy.
+ * @param size Size of the buffer.
+ */
+void fs_view_copy(fs_path_view view, char* buffer, size_t size);
+
+/**
+ * @brief Writes the stem (base name without extension) of a path, without touching the file system.
+ * @param path String representing the file path.
+ * @param stem Buffer receiving the stem.
+ * @param size Size of the stem buffer.
+ */
+void fs_stem(const char* path, char* stem, size_t size);
+
+/**
+ * @brief Maps a whole file in memory as a read-only view, with a file mapping on Windows and mmap elsewhere.
+ * The pages are read from the disk when they are first touched, so a loader can decode the file without copying it in a buffer.
+ * @param path String representing the file path.
+ * @param mapped_file Receives the view, left empty on failure.
+ * @return TRUE if the file was mapped, FALSE if it can't be opened or is empty.
+ */
+fsBool fs_map_file(const char* path, fs_mapped_file* mapped_file);
+
+/**
+ * @brief Unmaps a view returned by fs_map_file and empties it. Does nothing on an empty view.
+ * @param mapped_file Pointer to the view to unmap.
+ */
+void fs_unmap_file(fs_mapped_file* mapped_file);
+
+/**
+ * @brief Times the path queries of this file against the former ones, which opened every entry to classify it, on a generated tree.
+ * The tree is created in directory and removed at the end.
+ * @param directory Path of the directory to generate, must not exist.
+ * @param file_count Number of files to generate.
+ */
+void fs_run_benchmark(const char* directory, size_t file_count);
+
 /**
  * @brief Checks if the given Path represents a directory.
  * @param path Pointer to the Path object.
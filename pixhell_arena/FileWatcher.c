@@ -0,0 +1,235 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "FileWatcher.h"
+#include "Game.h"
+#include "MemoryManagement.h"
+#include "Profiler.h"
+
+typedef struct WatchedFile WatchedFile;
+struct WatchedFile
+{
+	char m_path[MAX_PATH_SIZE];
+	unsigned long long m_size;
+	unsigned long long m_mtime;
+};
+
+typedef enum ReloadedType ReloadedType;
+enum ReloadedType
+{
+	RELOADED_TEXTURE,
+	RELOADED_SOUND,
+	RELOADED_FONT
+};
+
+typedef struct ReloadedResource ReloadedResource;
+struct ReloadedResource
+{
+	char m_path[MAX_PATH_SIZE];
+	ReloadedType m_type;
+	sfTexture* m_texture;
+	sfSoundBuffer* m_sound_buffer;
+	Font m_font;
+};
+
+static sfThread* watcher_thread;
+static HANDLE watcher_stop_event;
+static char watcher_root[MAX_PATH_SIZE];
+static WatchedFile* watched_files;
+static size_t watched_file_count;
+
+
+static int CompareWatchedFiles(const void* a, const void* b)
+{
+	return strcmp(((const WatchedFile*)a)->m_path, ((const WatchedFile*)b)->m_path);
+}
+
+static WatchedFile* ScanWatchedFiles(size_t* file_count)
+{
+	Path root = fs_create_path(watcher_root);
+	stdList* files = fs_recursive_iterator_directory(&root);
+	WatchedFile* scanned_files = calloc_d(WatchedFile, files->size(files) ? files->size(files) : 1);
+	assert(scanned_files);
+
+	*file_count = 0;
+	for (int i = 0; i < files->size(files); i++)
+	{
+		WatchedFile* file = &scanned_files[*file_count];
+		WIN32_FILE_ATTRIBUTE_DATA data;
+		strcpy_s(file->m_path, MAX_PATH_SIZE, STD_GETDATA(files, Path, i)->path_data.m_path);
+		if (!GetFileAttributesExA(file->m_path, GetFileExInfoStandard, &data))
+			continue;
+		file->m_size = ((unsigned long long)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+		file->m_mtime = ((unsigned long long)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+		(*file_count)++;
+	}
+	files->destroy(&files);
+	qsort(scanned_files, *file_count, sizeof(WatchedFile), &CompareWatchedFiles);
+	return scanned_files;
+}
+
+static void ApplyReload(void* data)
+{
+	ReloadedResource* reloaded = data;
+	sfBool is_reloaded = sfFalse;
+	switch (reloaded->m_type)
+	{
+	case RELOADED_TEXTURE:
+		is_reloaded = ReloadTexture(reloaded->m_path, reloaded->m_texture);
+		break;
+	case RELOADED_SOUND:
+		is_reloaded = ReloadSoundBuffer(reloaded->m_path, reloaded->m_sound_buffer);
+		break;
+	case RELOADED_FONT:
+		is_reloaded = ReloadFont(reloaded->m_path, &reloaded->m_font);
+		break;
+	}
+	printf_d("%s %s\n\n", reloaded->m_path, is_reloaded ? "reloaded" : "is not loaded, ignored");
+}
+
+static void ReloadFile(const char* path)
+{
+	size_t packed_size = 0;
+	if (GetPackedFile(path, &packed_size))
+		return;
+
+	ReloadedResource reloaded = { 0 };
+	strcpy_s(reloaded.m_path, MAX_PATH_SIZE, path);
+	fs_path_view extension = fs_view_extension(fs_view(path));
+	sfBool is_decoded = sfFalse;
+	if (fs_view_equals(extension, TEXTURE_EXTENSION))
+	{
+		reloaded.m_type = RELOADED_TEXTURE;
+		reloaded.m_texture = sfTexture_createFromFile(path, NULL);
+		is_decoded = reloaded.m_texture != NULL;
+	}
+	else if (fs_view_equals(extension, SOUND_EXTENSION))
+	{
+		reloaded.m_type = RELOADED_SOUND;
+		reloaded.m_sound_buffer = sfSoundBuffer_createFromFile(path);
+		is_decoded = reloaded.m_sound_buffer != NULL;
+	}
+	else if (fs_view_equals(extension, FONT_EXTENSION))
+	{
+		reloaded.m_type = RELOADED_FONT;
+		reloaded.m_font = CreateFont(path);
+		is_decoded = reloaded.m_font.m_font != NULL;
+		if (!is_decoded)
+			DeleteFont(&reloaded.m_font);
+	}
+	else
+	{
+		// The sheets already loaded keep their sprites, the next textures loaded from the directory read the new descriptor.
+		if (fs_view_equals(extension, SPRITE_SHEET_DESCRIPTOR_EXTENSION))
+			ClearSpriteSheetCache();
+		return;
+	}
+
+	if (!is_decoded)
+	{
+		printf_d("Can't reload %s, it will be retried on its next change\n\n", path);
+		return;
+	}
+	PostToMainThread(&ApplyReload, &reloaded, sfTrue, sizeof(ReloadedResource));
+}
+
+// Both scans are sorted by path, a single merge finds the files present in both whose size or modification time changed.
+static void ReloadModifiedFiles(void)
+{
+	size_t file_count = 0;
+	WatchedFile* files = ScanWatchedFiles(&file_count);
+	size_t i = 0, j = 0;
+	while (i < watched_file_count && j < file_count)
+	{
+		int order = strcmp(watched_files[i].m_path, files[j].m_path);
+		if (order == 0)
+		{
+			if (watched_files[i].m_mtime != files[j].m_mtime || watched_files[i].m_size != files[j].m_size)
+				ReloadFile(files[j].m_path);
+			i++;
+			j++;
+		}
+		else if (order < 0)
+			i++;
+		else
+			j++;
+	}
+	free_d(watched_files);
+	watched_files = files;
+	watched_file_count = file_count;
+}
+
+static void FileWatcherThread(void* data)
+{
+	PROFILE_THREAD_NAME("File watcher");
+	HANDLE change_notification = FindFirstChangeNotificationA(watcher_root, TRUE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE);
+	if (change_notification == INVALID_HANDLE_VALUE)
+		printf_d("No change notification for %s, polling it every %d ms\n\n", watcher_root, FILE_WATCHER_POLL_MS);
+
+	HANDLE handles[2] = { watcher_stop_event, change_notification };
+	while (1)
+	{
+		DWORD result = change_notification != INVALID_HANDLE_VALUE
+			? WaitForMultipleObjects(2, handles, FALSE, INFINITE)
+			: WaitForSingleObject(watcher_stop_event, FILE_WATCHER_POLL_MS);
+		if (result == WAIT_OBJECT_0)
+			break;
+		if (change_notification != INVALID_HANDLE_VALUE)
+		{
+			if (WaitForSingleObject(watcher_stop_event, FILE_WATCHER_SETTLE_MS) == WAIT_OBJECT_0)
+				break;
+			FindNextChangeNotification(change_notification);
+		}
+		PROFILE_ZONE("ReloadModifiedFiles", ReloadModifiedFiles(););
+	}
+
+	if (change_notification != INVALID_HANDLE_VALUE)
+		FindCloseChangeNotification(change_notification);
+	PROFILE_THREAD_EXIT();
+}
+
+void StartFileWatcher(const char* resource_directory_)
+{
+	if (watcher_thread)
+		return;
+	strcpy_s(watcher_root, MAX_PATH_SIZE, resource_directory_);
+	watched_files = ScanWatchedFiles(&watched_file_count);
+	watcher_stop_event = CreateEventA(NULL, TRUE, FALSE, NULL);
+	watcher_thread = sfThread_create(&FileWatcherThread, NULL);
+	sfThread_launch(watcher_thread);
+	printf_d("Watching %s, %zu files\n\n", watcher_root, watched_file_count);
+}
+
+void StopFileWatcher(void)
+{
+	if (!watcher_thread)
+		return;
+	SetEvent(watcher_stop_event);
+	sfThread_wait(watcher_thread);
+	sfThread_destroy(watcher_thread);
+	CloseHandle(watcher_stop_event);
+	free_d(watched_files);
+	watcher_thread = NULL;
+	watcher_stop_event = NULL;
+	watched_files = NULL;
+	watched_file_count = 0;
+}
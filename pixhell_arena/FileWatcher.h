@@ -0,0 +1,63 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "Tools.h"
+
+/**
+ * @file filewatcher.h
+ * @brief This file defines the file watcher, which reloads the modified assets of the resources directory while the game runs.
+ *
+ * A background thread waits for a change notification on the resources directory, or polls it every FILE_WATCHER_POLL_MS
+ * when notifications are not available. It then compares the size and modification time of every file with the previous scan.
+ * Each modified texture, sound or font is decoded on the watcher thread, then handed to the main thread
+ * which swaps it into the loaded entry, so the rest of the game keeps its pointers.
+ *
+ * @code
+ * // Done by the --hot-reload command line option:
+ * InitResourcesManager("../Ressources");
+ * StartFileWatcher("../Ressources");
+ * @endcode
+ */
+
+/**
+ * @def FILE_WATCHER_POLL_MS
+ * @brief Time between two scans when the change notifications are not available, in milliseconds.
+ */
+#define FILE_WATCHER_POLL_MS 1000
+
+/**
+ * @def FILE_WATCHER_SETTLE_MS
+ * @brief Time waited after a change notification before scanning, so the editor has finished writing the file, in milliseconds.
+ */
+#define FILE_WATCHER_SETTLE_MS 100
+
+/**
+ * @brief Starts watching a resources directory on a background thread. Does nothing if the watcher is already running.
+ * @param resource_directory_ Path of the resources directory to watch.
+ */
+void StartFileWatcher(const char* resource_directory_);
+
+/**
+ * @brief Stops the watcher thread and waits for it. Does nothing if the watcher is not running.
+ */
+void StopFileWatcher(void);
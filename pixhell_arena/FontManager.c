@@ -21,17 +21,31 @@
 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #include "FontManager.h"
+#include "PackFile.h"
+#include "MemoryManagement.h"
 
-stdList* global_font_list, * scene_font_list;
+stdList* global_font_list, * scene_font_list, * prefetch_font_list;
 Font font_place_holder;
+static SRWLOCK font_list_lock = SRWLOCK_INIT;
+static ResourceRegistry* font_registry;
+static ResourceCache* font_cache;
+static size_t font_budget = DEFAULT_FONT_BUDGET;
+static stdList* retired_font_list;
 
 Font CreateFont(const char* path)
 {
 	Font tmp;
 	Path tmpPath = fs_create_path(path);
-	tmp.m_font = sfFont_createFromFile(path);
+	tmp.m_data_size = 0;
+	const void* data = ReadResourceFile(path, &tmp.m_data_size, &tmp.m_data);
+	// Without a graphics context no sfFont is created, its glyph pages would be textures. The file bytes are kept.
+	if (is_headless_resources)
+		tmp.m_font = NULL;
+	else
+		tmp.m_font = data ? sfFont_createFromMemory(data, tmp.m_data_size) : sfFont_createFromFile(path);
 	tmp.m_path = tmpPath;
-	strcpy_s(tmp.m_name, MAX_PATH_SIZE, tmpPath.stem(&tmpPath).path_data.m_path);
+	tmp.m_load_state = RESOURCE_LOADED;
+	fs_stem(path, tmp.m_name, MAX_PATH_SIZE);
 	ToLower(tmp.m_name);
 	printf_d("Font {\n\tPath : %s\n\tName: %s\n } loaded\n\n", tmp.m_path.path_data.m_path, tmp.m_name);
 
@@ -40,7 +54,73 @@ Font CreateFont(const char* path)
 
 void DeleteFont(Font* font)
 {
-	sfFont_destroy(font->m_font);
+	if (font->m_font)
+		sfFont_destroy(font->m_font);
+	if (font->m_data)
+		free_d(font->m_data);
+	font->m_data = NULL;
+}
+
+static Font CreateUnloadedFont(const char* path)
+{
+	Font tmp = { 0 };
+	tmp.m_path = fs_create_path(path);
+	fs_stem(path, tmp.m_name, MAX_PATH_SIZE);
+	ToLower(tmp.m_name);
+	tmp.m_load_state = RESOURCE_UNLOADED;
+	return tmp;
+}
+
+static void LoadFontOnFirstUse(void* resource)
+{
+	Font* font = resource;
+	Font loaded = CreateFont(font->m_path.path_data.m_path);
+	font->m_font = loaded.m_font;
+	font->m_data = loaded.m_data;
+	font->m_data_size = loaded.m_data_size;
+}
+
+static sfFont* RequireFont(Font* font)
+{
+	if (__RequireResource(&font->m_load_state, &LoadFontOnFirstUse, font))
+		return font->m_font;
+	return font_place_holder.m_font;
+}
+
+static size_t GetFontMemorySize(const Font* font)
+{
+	return font->m_data_size;
+}
+
+static void DestroyCachedFont(void* font)
+{
+	DeleteFont(font);
+}
+
+// Instead of being destroyed with its scene, the font waits in the cache in case a next scene uses it again.
+static void RetireFont(Font* font)
+{
+	font_cache->Store(font_cache, font->m_name, font->m_path.path_data.m_path, font, font->m_font, GetFontMemorySize(font));
+}
+
+static Font TakeOrCreateFont(const char* path)
+{
+	Font tmp;
+	if (!font_cache->Take(font_cache, path, &tmp))
+		tmp = CreateFont(path);
+	return tmp;
+}
+
+// The global list is complete, its entries no longer move.
+static void RegisterGlobalFonts(void)
+{
+	font_registry = CreateResourceRegistry();
+	// Registered first, so the handle of an identifier is the identifier plus one.
+	for (int i = 0; i < FONT_ID_COUNT; i++)
+		font_registry->GetHandle(font_registry, font_id_names[i], NULL);
+	FOR_EACH_LIST(global_font_list, Font, it, tmp,
+		font_registry->AddGlobalResource(font_registry, tmp->m_name, tmp);
+		)
 }
 
 void InitFontManager(void)
@@ -49,7 +129,7 @@ void InitFontManager(void)
 		strcpy_s(resources_path, MAX_PATH_SIZE, resource_directory);
 	strcat_s(resources_path, MAX_PATH_SIZE, "/ALL/Fonts");
 	Path fs_path = fs_create_path(resources_path);
-	if (fs_path.exist(&fs_path))
+	if ((fs_path.exist(&fs_path) || IsPackedDirectory(fs_path.path_data.m_path)))
 	{
 		if (global_font_list == NULL)
 		{
@@ -57,14 +137,18 @@ void InitFontManager(void)
 
 			global_font_list = stdList_Create(sizeof(Font), 0);
 			scene_font_list = stdList_Create(sizeof(Font), 0);
+			prefetch_font_list = stdList_Create(sizeof(Font), 0);
 			
 			FOR_EACH_TEMP_LIST(filesInfos, FilesInfo, SearchFilesInfos(fs_path.path_data.m_path, "ttf"),
-				Font tmp = CreateFont(STD_GETDATA(filesInfos, FilesInfo, i)->m_path);
+				const char* file_path = STD_GETDATA(filesInfos, FilesInfo, i)->m_path;
+				Font tmp = __IsLoadedEagerly(file_path) ? CreateFont(file_path) : CreateUnloadedFont(file_path);
 			if (strcmp(tmp.m_name, "placeholder") == 0)
 				font_place_holder = tmp;
 			else
 				global_font_list->push_back(global_font_list, &tmp);
 				)
+			RegisterGlobalFonts();
+			font_cache = CreateResourceCache(sizeof(Font), font_registry, &DestroyCachedFont, font_budget);
 		}
 	}
 	else
@@ -74,62 +158,181 @@ void InitFontManager(void)
 	}
 }
 
-void Load_Font(const char* path)
+void Load_Font(const char* path, const CancelToken* cancel_token)
 {
-	Font tmp = CreateFont(path);
+	Font tmp = TakeOrCreateFont(path);
+	if (IsLoadCancelled(cancel_token))
+	{
+		RetireFont(&tmp);
+		return;
+	}
+	AcquireSRWLockExclusive(&font_list_lock);
 	scene_font_list->push_back(scene_font_list, &tmp);
+	ReleaseSRWLockExclusive(&font_list_lock);
+	font_registry->AddSceneResource(font_registry, tmp.m_name, tmp.m_font);
+}
+
+void LoadSceneFont(const char* scene, SceneLoader* loader)
+{
+	ClearSceneFont();
+	__LoadScene(scene, FONT_EXTENSION, FONT_DIRECTORY, loader, &Load_Font);
+}
+
+static void Prefetch_Font(const char* path, const CancelToken* cancel_token)
+{
+	Font tmp = TakeOrCreateFont(path);
+	if (IsLoadCancelled(cancel_token))
+	{
+		RetireFont(&tmp);
+		return;
+	}
+	AcquireSRWLockExclusive(&font_list_lock);
+	prefetch_font_list->push_back(prefetch_font_list, &tmp);
+	ReleaseSRWLockExclusive(&font_list_lock);
 }
 
-void LoadSceneFont(const char* scene, float* progressValue)
+void PrefetchSceneFont(const char* scene, SceneLoader* loader)
+{
+	ClearPrefetchedSceneFont();
+	__LoadScene(scene, FONT_EXTENSION, FONT_DIRECTORY, loader, &Prefetch_Font);
+}
+
+void CommitPrefetchedSceneFont(void)
 {
 	ClearSceneFont();
-	__LoadScene(scene, "ttf", "Fonts",progressValue, &Load_Font);
+	stdList* tmp = scene_font_list;
+	scene_font_list = prefetch_font_list;
+	prefetch_font_list = tmp;
+	FOR_EACH_LIST(scene_font_list, Font, it, scene_font,
+		font_registry->AddSceneResource(font_registry, scene_font->m_name, scene_font->m_font);
+		)
+}
+
+void ClearPrefetchedSceneFont(void)
+{
+	if (prefetch_font_list != NULL)
+	{
+		for (int i = 0; i < prefetch_font_list->size(prefetch_font_list); i++)
+			RetireFont(STD_GETDATA(prefetch_font_list, Font, i));
+		prefetch_font_list->clear(prefetch_font_list);
+	}
 }
 
 void ClearSceneFont(void)
 {
 	if (scene_font_list != NULL)
 	{
+		font_registry->ClearSceneResources(font_registry);
 		for (int i = 0; i < scene_font_list->size(scene_font_list); i++)
-			sfFont_destroy(STD_GETDATA(scene_font_list, Font, i)->m_font);
+			RetireFont(STD_GETDATA(scene_font_list, Font, i));
 		scene_font_list->clear(scene_font_list);
 	}
 }
 
+void SetFontBudget(size_t budget)
+{
+	font_budget = budget;
+	if (font_cache)
+		font_cache->SetBudget(font_cache, budget);
+}
+
+ResourceHandle GetFontHandle(const char* name)
+{
+	return font_registry ? font_registry->GetHandle(font_registry, name, NULL) : INVALID_RESOURCE_HANDLE;
+}
+
+sfFont* GetFontById(FontId id)
+{
+	return GetFontFromHandle((ResourceHandle)id + 1);
+}
+
+sfFont* GetFontFromHandle(ResourceHandle handle)
+{
+	ResourceEntry* entry = font_registry ? font_registry->GetEntry(font_registry, handle) : NULL;
+	if (entry)
+	{
+		if (entry->m_global_resource)
+			return RequireFont(entry->m_global_resource);
+		if (entry->m_scene_resource)
+			return entry->m_scene_resource;
+	}
+	return font_place_holder.m_font;
+}
+
 sfFont* GetFont(const char* name)
 {
+	sfBool is_new = sfFalse;
+	ResourceHandle handle = font_registry ? font_registry->GetHandle(font_registry, name, &is_new) : INVALID_RESOURCE_HANDLE;
+	sfFont* font = GetFontFromHandle(handle);
+	if (!font && !is_headless_resources)
+		printf_d("No Font placeholder found, put a placeholder.ttf in your %s/ALL/Fonts folder\n\n", resource_directory);
+	// Only the first lookup of a missing name prints, the next ones hit its empty entry.
+	else if (is_new && font == font_place_holder.m_font)
+		printf_d("Font %s not found, placeholder returned\n\n", name);
+	return font;
+}
+
+static Font* FindLoadedFont(const char* path)
+{
+	if (font_place_holder.m_font && fs_path_equals(font_place_holder.m_path.path_data.m_path, path))
+		return &font_place_holder;
 	if (global_font_list != NULL)
 		FOR_EACH_LIST(global_font_list, Font, it, tmp,
-			if (strcmp(tmp->m_name, name) == 0)
-				return tmp->m_font;
+			if (tmp->m_load_state == RESOURCE_LOADED && fs_path_equals(tmp->m_path.path_data.m_path, path))
+				return tmp;
+				)
+	if (scene_font_list != NULL)
+		FOR_EACH_LIST(scene_font_list, Font, it, tmp,
+			if (fs_path_equals(tmp->m_path.path_data.m_path, path))
+				return tmp;
 				)
-
-		if (scene_font_list != NULL)
-			FOR_EACH_LIST(scene_font_list, Font, it, tmp,
-				if (strcmp(tmp->m_name, name) == 0)
-					return tmp->m_font;
-					)
-
-			if (font_place_holder.m_font)
-			{
-				printf_d("Font %s not found, placeholder returned\n\n", name);
-				return font_place_holder.m_font;
-			}
-
-	printf_d("No Font placeholder found, put a placeholder.ttf in your %s/ALL/Fonts folder\n\n", resource_directory);
 	return NULL;
 }
 
+sfBool ReloadFont(const char* path, Font* font)
+{
+	AcquireSRWLockExclusive(&font_list_lock);
+	Font* loaded_font = FindLoadedFont(path);
+	if (loaded_font)
+	{
+		if (retired_font_list == NULL)
+			retired_font_list = stdList_Create(sizeof(Font), 0);
+		retired_font_list->push_back(retired_font_list, loaded_font);
+		// A scene font is registered by its sfFont, a global one by its list entry which stays in place.
+		ResourceEntry* entry = font_registry->GetEntry(font_registry, font_registry->GetHandle(font_registry, loaded_font->m_name, NULL));
+		if (entry)
+			InterlockedCompareExchangePointer(&entry->m_scene_resource, font->m_font, loaded_font->m_font);
+		loaded_font->m_font = font->m_font;
+		loaded_font->m_data = font->m_data;
+		loaded_font->m_data_size = font->m_data_size;
+	}
+	ReleaseSRWLockExclusive(&font_list_lock);
+	if (!loaded_font)
+		DeleteFont(font);
+	// A cached copy would be taken back by the next scene with the old glyphs.
+	sfBool is_evicted = font_cache->Evict(font_cache, path);
+	return loaded_font || is_evicted ? sfTrue : sfFalse;
+}
+
 void DestroyFontsManager(void)
 {
+	if (retired_font_list != NULL)
+	{
+		for (int i = 0; i < retired_font_list->size(retired_font_list); i++)
+			DeleteFont(STD_GETDATA(retired_font_list, Font, i));
+		retired_font_list->destroy(&retired_font_list);
+	}
 	ClearSceneFont();
 	if (global_font_list != NULL)
 	{
 		for (int i = 0; i < global_font_list->size(global_font_list); i++)
-			sfFont_destroy(STD_GETDATA(global_font_list, Font, i)->m_font);
+			DeleteFont(STD_GETDATA(global_font_list, Font, i));
 		global_font_list->clear(global_font_list);
 	}
 	scene_font_list->destroy(&scene_font_list);
+	ClearPrefetchedSceneFont();
+	prefetch_font_list->destroy(&prefetch_font_list);
 	global_font_list->destroy(&global_font_list);
-
+	font_cache->Destroy(&font_cache);
+	font_registry->Destroy(&font_registry);
 }
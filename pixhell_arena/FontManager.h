@@ -22,12 +22,32 @@
 */
 #pragma once
 #include "Tools.h"
+#include "ResourceCache.h"
+#include "ResourceIds.h"
 
 /**
  * @file fontmanager.h
  * @brief This file contains all the data to load fonts for the engine.
  */
 
+/**
+ * @def FONT_EXTENSION
+ * @brief Extension of the fonts files.
+ */
+#define FONT_EXTENSION "ttf"
+
+/**
+ * @def FONT_DIRECTORY
+ * @brief Name of the fonts directory inside a scene directory.
+ */
+#define FONT_DIRECTORY "Fonts"
+
+/**
+ * @def DEFAULT_FONT_BUDGET
+ * @brief Default size in bytes of the fonts of the previous scenes kept loaded, see SetFontBudget.
+ */
+#define DEFAULT_FONT_BUDGET (8 * 1024 * 1024)
+
 
 #undef CreateFont /**< Undefine the macro CreateFont to avoid conflicts. */
 
@@ -41,6 +61,9 @@ struct Font
     sfFont* m_font;              /**< Pointer to the loaded font object. */
     Path m_path;                 /**< Path to the font file. */
     char m_name[MAX_PATH_SIZE];  /**< Name of the font, used for identification. */
+    void* m_data;                /**< Copy of the font file, the font reads its glyphs from it until it is destroyed. NULL for a packed font, see ReadResourceFile. Kept without m_font when the resources are headless. */
+    size_t m_data_size;          /**< Size in bytes of the font file. */
+    volatile LONG m_load_state;  /**< ResourceLoadState of the font, see __RequireResource. */
 };
 
 /**
@@ -65,15 +88,34 @@ void InitFontManager(void);
 /**
  * @brief Loads fonts associated with a specific scene.
  * @param scene Name of the scene for which fonts should be loaded.
+ * @param loader Loader the files are queued on, they load once it is started.
  */
-void LoadSceneFont(const char* scene, float* progressValue);
+void LoadSceneFont(const char* scene, SceneLoader* loader);
 
 /**
  * @brief Clears all fonts associated with the current scene.
- * This function frees memory and unloads scene-specific fonts.
+ * They are handed to the cache of the manager, the next scenes take them back without loading them again.
  */
 void ClearSceneFont(void);
 
+/**
+ * @brief Loads the fonts of a scene into a separate list, without touching the fonts of the current scene.
+ * @param scene Name of the scene for which fonts should be prefetched.
+ * @param loader Loader the files are queued on, they load once it is started.
+ */
+void PrefetchSceneFont(const char* scene, SceneLoader* loader);
+
+/**
+ * @brief Replaces the fonts of the current scene by the prefetched ones.
+ * The fonts of the previous scene are freed.
+ */
+void CommitPrefetchedSceneFont(void);
+
+/**
+ * @brief Frees the prefetched fonts that were never committed.
+ */
+void ClearPrefetchedSceneFont(void);
+
 /**
  * @brief Retrieves a font object by its name.
  * @param name Name of the font to retrieve.
@@ -81,6 +123,43 @@ void ClearSceneFont(void);
  */
 sfFont* GetFont(const char* name);
 
+/**
+ * @brief Retrieves the stable handle of a font name, to resolve it every frame with GetFontFromHandle instead of looking the name up.
+ * @param name Name of the font, compared without case. It does not have to be loaded yet.
+ * @return The handle of the name.
+ */
+ResourceHandle GetFontHandle(const char* name);
+
+/**
+ * @brief Retrieves a font object by its handle, without any name lookup.
+ * @param handle Handle returned by GetFontHandle.
+ * @return Pointer to the font object, or the placeholder while no font of that name is loaded.
+ */
+sfFont* GetFontFromHandle(ResourceHandle handle);
+
+/**
+ * @brief Retrieves a font object by its generated identifier, see ResourceIds.h. A renamed or removed font fails to compile instead of returning the placeholder.
+ * @param id Identifier of the font.
+ * @return Pointer to the font object, or the placeholder while it is not loaded.
+ */
+sfFont* GetFontById(FontId id);
+
+/**
+ * @brief Sets the size of the fonts of the previous scenes kept loaded. The least recently used ones are destroyed over it.
+ * @param budget Budget in bytes, DEFAULT_FONT_BUDGET by default.
+ */
+void SetFontBudget(size_t budget);
+
+/**
+ * @brief Replaces the loaded font created from path, used by the hot reload. Must be called from the main thread.
+ * A font can't be swapped in place, so GetFont returns the new one while the texts already using the old one keep it.
+ * The old font is kept alive until DestroyFontsManager.
+ * @param path Path of the font file.
+ * @param font Font created from the modified file. Owned by the manager on success, deleted otherwise.
+ * @return sfTrue if a loaded or cached font was created from path, sfFalse otherwise. The cached one is destroyed.
+ */
+sfBool ReloadFont(const char* path, Font* font);
+
 /**
  * @brief Destroys the font manager and releases all associated resources.
  */
@@ -0,0 +1,188 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "FramePacer.h"
+#include "MemoryManagement.h"
+#include <windows.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#pragma comment(lib, "winmm.lib")
+
+struct FramePacer_Data
+{
+	LONGLONG m_frequency;
+	LONGLONG m_period;
+	LONGLONG m_next_deadline;
+	LONGLONG m_last_frame;
+	unsigned int m_frame_rate;
+	sfBool m_has_timer_period;
+
+	float m_history[FRAME_PACER_HISTORY_SIZE];
+	unsigned int m_history_index;
+	unsigned int m_history_count;
+};
+
+
+static LONGLONG GetCounter(void)
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+}
+
+static void SetTargetFrameRate(FramePacer* pacer, unsigned int frame_rate)
+{
+	FramePacer_Data* data = pacer->_Data;
+
+	data->m_frame_rate = frame_rate;
+	data->m_period = frame_rate ? data->m_frequency / frame_rate : 0;
+	data->m_next_deadline = GetCounter() + data->m_period;
+
+	// Sleep(1) lasts up to 15.6 ms with the default timer resolution, far too coarse to pace a frame.
+	if (frame_rate && !data->m_has_timer_period)
+		data->m_has_timer_period = timeBeginPeriod(1) == 0;
+	else if (!frame_rate && data->m_has_timer_period)
+	{
+		timeEndPeriod(1);
+		data->m_has_timer_period = sfFalse;
+	}
+}
+
+static unsigned int GetTargetFrameRate(const FramePacer* pacer)
+{
+	return pacer->_Data->m_frame_rate;
+}
+
+static void WaitUntil(const FramePacer_Data* data, LONGLONG deadline)
+{
+	LONGLONG spin_time = (LONGLONG)(FRAME_PACER_SPIN_MS * (double)data->m_frequency / 1000.0);
+	LONGLONG now = GetCounter();
+
+	if (deadline - now > spin_time)
+	{
+		DWORD sleep_ms = (DWORD)((deadline - now - spin_time) * 1000 / data->m_frequency);
+		if (sleep_ms)
+			Sleep(sleep_ms);
+	}
+	while (GetCounter() < deadline)
+		YieldProcessor();
+}
+
+static void WaitNextFrame(FramePacer* pacer)
+{
+	FramePacer_Data* data = pacer->_Data;
+
+	if (data->m_period)
+		WaitUntil(data, data->m_next_deadline);
+
+	LONGLONG now = GetCounter();
+	if (data->m_period)
+	{
+		data->m_next_deadline += data->m_period;
+		// A frame late by more than a whole period restarts the schedule instead of rushing the next frames to catch up.
+		if (now > data->m_next_deadline)
+			data->m_next_deadline = now + data->m_period;
+	}
+	if (data->m_last_frame)
+	{
+		data->m_history[data->m_history_index] = (float)((double)(now - data->m_last_frame) * 1000.0 / (double)data->m_frequency);
+		data->m_history_index = (data->m_history_index + 1) % FRAME_PACER_HISTORY_SIZE;
+		if (data->m_history_count < FRAME_PACER_HISTORY_SIZE)
+			data->m_history_count++;
+	}
+	data->m_last_frame = now;
+}
+
+static int CompareFrameTime(const void* a, const void* b)
+{
+	float lhs = *(const float*)a;
+	float rhs = *(const float*)b;
+	return (lhs > rhs) - (lhs < rhs);
+}
+
+static FrameStats GetStats(const FramePacer* pacer)
+{
+	const FramePacer_Data* data = pacer->_Data;
+	FrameStats stats = { 0 };
+	float sorted[FRAME_PACER_HISTORY_SIZE];
+	unsigned int count = data->m_history_count;
+
+	if (!count)
+		return stats;
+
+	memcpy(sorted, data->m_history, count * sizeof(float));
+	qsort(sorted, count, sizeof(float), &CompareFrameTime);
+
+	float total = 0.f;
+	for (unsigned int i = 0; i < count; i++)
+		total += sorted[i];
+
+	stats.sample_count = count;
+	stats.average = total / (float)count;
+	stats.p50 = sorted[(count - 1) * 50 / 100];
+	stats.p95 = sorted[(count - 1) * 95 / 100];
+	stats.p99 = sorted[(count - 1) * 99 / 100];
+	stats.worst = sorted[count - 1];
+	for (unsigned int i = count; i > 0 && sorted[i - 1] > stats.p50 * FRAME_PACER_SPIKE_FACTOR; i--)
+		stats.spike_count++;
+
+	return stats;
+}
+
+static void ResetStats(FramePacer* pacer)
+{
+	pacer->_Data->m_history_index = 0;
+	pacer->_Data->m_history_count = 0;
+	pacer->_Data->m_last_frame = 0;
+}
+
+static void DestroyFramePacer(FramePacer** pacer)
+{
+	if ((*pacer)->_Data->m_has_timer_period)
+		timeEndPeriod(1);
+	free_d((*pacer)->_Data);
+	free_d(*pacer);
+	*pacer = NULL;
+}
+
+
+FramePacer* CreateFramePacer(void)
+{
+	FramePacer* pacer = calloc_d(FramePacer, 1);
+	assert(pacer);
+	pacer->_Data = calloc_d(FramePacer_Data, 1);
+	assert(pacer->_Data);
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	pacer->_Data->m_frequency = frequency.QuadPart;
+
+	pacer->SetTargetFrameRate = &SetTargetFrameRate;
+	pacer->GetTargetFrameRate = &GetTargetFrameRate;
+	pacer->WaitNextFrame = &WaitNextFrame;
+	pacer->GetStats = &GetStats;
+	pacer->ResetStats = &ResetStats;
+	pacer->Destroy = &DestroyFramePacer;
+
+	return pacer;
+}
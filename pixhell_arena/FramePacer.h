@@ -0,0 +1,142 @@
+/*
+    Author: GRALLAN Yann
+
+    Description: An advanced game engine for CSFML
+
+    Date: 2025/01/22
+
+    MIT License
+
+    Copyright (c) 2025 GRALLAN Yann
+
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "SFML/System.h"
+
+/**
+ * @file framepacer.h
+ * @brief This file defines the FramePacer structure, which limits the frame rate and keeps a rolling frame time histogram.
+ *
+ * The pacer sleeps until about FRAME_PACER_SPIN_MS before the frame deadline, then spins on the performance counter
+ * for the rest, so the frame rate stays accurate to a fraction of a millisecond without burning a whole core.
+ * Every frame time is stored in a ring of the last FRAME_PACER_HISTORY_SIZE frames used to compute the statistics.
+ *
+ * @code
+ * // Example usage:
+ * FramePacer* pacer = CreateFramePacer();
+ * pacer->SetTargetFrameRate(pacer, 144);
+ * while (running)
+ * {
+ *     UpdateAndRender();
+ *     pacer->WaitNextFrame(pacer);
+ * }
+ * FrameStats stats = pacer->GetStats(pacer);
+ * printf("p99: %.2f ms\n", stats.p99);
+ * pacer->Destroy(&pacer);
+ * @endcode
+ */
+
+/**
+ * @def FRAME_PACER_HISTORY_SIZE
+ * @brief Number of frames kept to compute the statistics.
+ */
+#define FRAME_PACER_HISTORY_SIZE 240
+
+/**
+ * @def FRAME_PACER_SPIN_MS
+ * @brief Time before the deadline at which the pacer stops sleeping and starts spinning, in milliseconds.
+ */
+#define FRAME_PACER_SPIN_MS 1.5
+
+/**
+ * @def FRAME_PACER_SPIKE_FACTOR
+ * @brief A frame taking more than this factor times the median frame time is counted as a spike.
+ */
+#define FRAME_PACER_SPIKE_FACTOR 2.f
+
+/**
+ * @struct FrameStats
+ * @brief Frame time statistics over the last FRAME_PACER_HISTORY_SIZE frames. Every time is in milliseconds.
+ */
+typedef struct FrameStats
+{
+    float average; /**< Mean frame time. */
+    float p50; /**< Median frame time. */
+    float p95; /**< 95th percentile frame time. */
+    float p99; /**< 99th percentile frame time. */
+    float worst; /**< Longest frame time. */
+    unsigned int spike_count; /**< Number of frames longer than FRAME_PACER_SPIKE_FACTOR times the median. */
+    unsigned int sample_count; /**< Number of frames the statistics are computed on. */
+} FrameStats;
+
+typedef struct FramePacer_Data FramePacer_Data;
+
+/**
+ * @typedef FramePacer
+ * @brief Structure for pacing the frames and measuring their duration.
+ */
+typedef struct FramePacer FramePacer;
+
+/**
+ * @struct FramePacer
+ * @brief Structure for pacing the frames and measuring their duration.
+ */
+struct FramePacer
+{
+    FramePacer_Data* _Data;
+
+    /**
+     * @brief Sets the frame rate the pacer waits for.
+     * @param pacer The FramePacer instance.
+     * @param frame_rate Target frame rate, 0 disables the limiter and only measures the frames.
+     */
+    void (*SetTargetFrameRate)(FramePacer* pacer, unsigned int frame_rate);
+
+    /**
+     * @brief Gets the frame rate the pacer waits for.
+     * @param pacer The FramePacer instance.
+     * @return The target frame rate, 0 if the limiter is disabled.
+     */
+    unsigned int (*GetTargetFrameRate)(const FramePacer* pacer);
+
+    /**
+     * @brief Waits for the end of the current frame and records its duration. Call it once per frame, after the display.
+     * @param pacer The FramePacer instance.
+     */
+    void (*WaitNextFrame)(FramePacer* pacer);
+
+    /**
+     * @brief Computes the statistics of the last recorded frames.
+     * @param pacer The FramePacer instance.
+     * @return The frame time statistics, zeroed if no frame was recorded.
+     */
+    FrameStats(*GetStats)(const FramePacer* pacer);
+
+    /**
+     * @brief Forgets every recorded frame, e.g. after a loading screen.
+     * @param pacer The FramePacer instance.
+     */
+    void (*ResetStats)(FramePacer* pacer);
+
+    /**
+     * @brief Destroys the frame pacer and restores the system timer resolution.
+     * @param pacer A pointer to the FramePacer instance to destroy.
+     */
+    void (*Destroy)(FramePacer** pacer);
+};
+
+/**
+ * @brief Creates a new frame pacer with the limiter disabled.
+ * @return A pointer to the newly created FramePacer instance.
+ */
+FramePacer* CreateFramePacer(void);
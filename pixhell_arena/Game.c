@@ -24,6 +24,8 @@
 
 #include "MemoryManagement.h"
 #include "Animation.h"
+#include "JobScheduler.h"
+#include "Profiler.h"
 #include "time.h"
 
 
@@ -40,13 +42,27 @@ stdList* registered_sub_state_list, * active_sub_state_list;
 void(*ResetLoadingStateFunction)(WindowManager* window);
 
 
-ThreadManager* thread_manager;
+ThreadTask* init_task;
+CancelToken init_cancel_token;
 sfBool is_changing_state;
 sfBool has_loaded_state;
 sfBool is_sub_state_delete;
 Clock* main_clock;
+float simulation_accumulator;
 
-float loading_delay;
+sfBool is_pipelined_mode;
+sfBool current_state_has_snapshot;
+StateSnapshotInfo current_snapshot_info;
+ThreadManager* simulation_thread;
+ThreadTask* simulation_task;
+void* snapshot_buffers[2];
+float snapshot_alpha[2];
+size_t snapshot_buffer_size;
+int snapshot_front;
+sfBool snapshot_is_valid;
+
+sfBool(*current_init_step)(WindowManager*);
+sfBool is_headless_running;
 
 
 typedef struct {
@@ -54,15 +70,76 @@ typedef struct {
 	WindowManager* window_manager;
 } InitThreadInfo;
 
+typedef struct {
+	WindowManager* window_manager;
+	int step_count;
+	void* snapshot;
+} SimulationBatchInfo;
+
 
 static void init_new_state(void* state_info)
 {
 	InitThreadInfo* new_state_info = state_info;
 
+	PROFILE_THREAD_NAME("State init");
+	SetThreadCancelToken(&init_cancel_token);
 	if (new_state_info->state_info.Init)
-		new_state_info->state_info.Init(new_state_info->window_manager);
+		PROFILE_ZONE("Init", new_state_info->state_info.Init(new_state_info->window_manager););
+	SetThreadCancelToken(NULL);
+}
+
+
+static void simulate_batch(void* batch_info)
+{
+	SimulationBatchInfo* batch = batch_info;
+
+	PROFILE_THREAD_NAME("Simulation");
+	for (int i = 0; i < batch->step_count && !is_changing_state; i++)
+	{
+		UpdateKeyAndMouseState();
+		if (Current_state.Update)
+			PROFILE_ZONE("Update", Current_state.Update(batch->window_manager););
+	}
+	PROFILE_ZONE("Capture", current_snapshot_info.Capture(batch->snapshot););
 }
 
+static void WaitSimulationBatch(void)
+{
+	if (!simulation_task)
+		return;
+	simulation_thread->WaitTask(simulation_thread, simulation_task);
+	simulation_thread->ReleaseTask(simulation_thread, &simulation_task);
+	snapshot_front ^= 1;
+}
+
+static void PrepareSnapshotBuffers(size_t snapshot_size)
+{
+	if (snapshot_buffer_size >= snapshot_size)
+		return;
+	for (int i = 0; i < 2; i++)
+	{
+		if (snapshot_buffers[i])
+			free_d(snapshot_buffers[i]);
+		snapshot_buffers[i] = calloc_d(char, snapshot_size);
+		assert(snapshot_buffers[i]);
+	}
+	snapshot_buffer_size = snapshot_size;
+	snapshot_is_valid = sfFalse;
+}
+
+static int ConsumeSimulationSteps(float frame_time)
+{
+	int step_count = 0;
+	simulation_accumulator += frame_time < MAX_FRAME_TIME ? frame_time : MAX_FRAME_TIME;
+	while (simulation_accumulator >= FIXED_TIME_STEP && step_count < MAX_SIMULATION_STEPS)
+	{
+		simulation_accumulator -= FIXED_TIME_STEP;
+		step_count++;
+	}
+	if (simulation_accumulator >= FIXED_TIME_STEP)
+		simulation_accumulator = fmodf(simulation_accumulator, FIXED_TIME_STEP);
+	return step_count;
+}
 
 static sfBool UpdateSubState(WindowManager* window)
 {
@@ -122,49 +199,155 @@ static sfBool ShouldRenderMainState(WindowManager* window)
 }
 
 
-static void Update(WindowManager* window)
+static void RenderPipelinedState(WindowManager* window)
 {
-	UpdateKeyAndMouseState();
-	main_clock->restartClock(main_clock);
-	window->RestartClock(window);
-	DeltaTime = main_clock->getDeltaTime(main_clock);
-	if (is_changing_state)
+	const void* snapshot = snapshot_buffers[snapshot_front];
+
+	window->Clear(window, sfBlack);
+	if (current_snapshot_info.Render)
+		PROFILE_ZONE("Render", current_snapshot_info.Render(window, snapshot););
+	if (current_snapshot_info.UIRender)
 	{
-		FOR_EACH_LIST(registered_sub_state_list, SubState, i, it,
-			it->state.Destroy(window);
-			);
-		active_sub_state_list->clear(active_sub_state_list);
-		registered_sub_state_list->clear(registered_sub_state_list);
+		sfView* customView = window->GetCustomView(window);
+		window->SetDefaultView(window);
+		PROFILE_ZONE("UIRender", current_snapshot_info.UIRender(window, snapshot););
+		if (customView)
+			window->SetCustomView(window, customView);
+	}
+	PROFILE_ZONE("Display", window->Display(window););
+}
 
-		if (Current_state.Destroy)
-			Current_state.Destroy(window);
+static void UpdatePipelined(WindowManager* window, int step_count)
+{
+	if (!simulation_thread)
+		simulation_thread = CreateThreadManager(1);
+	PrepareSnapshotBuffers(current_snapshot_info.snapshot_size);
+	if (!snapshot_is_valid)
+	{
+		current_snapshot_info.Capture(snapshot_buffers[snapshot_front]);
+		snapshot_alpha[snapshot_front] = 1.f;
+		snapshot_is_valid = sfTrue;
+	}
 
-		if (New_state.Init)
-		{
+	SimulationBatchInfo batch = {
+		.window_manager = window,
+		.step_count = step_count,
+		.snapshot = snapshot_buffers[snapshot_front ^ 1]
+	};
+	snapshot_alpha[snapshot_front ^ 1] = simulation_accumulator / FIXED_TIME_STEP;
+	RenderAlpha = snapshot_alpha[snapshot_front];
+	DeltaTime = FIXED_TIME_STEP;
+	simulation_task = simulation_thread->AddNewTask(simulation_thread, &simulate_batch, &batch, sfTrue, sizeof(batch));
+
+	RenderPipelinedState(window);
+}
+
+static void ApplyStateChange(WindowManager* window)
+{
+	// The streamed files of the previous scene outlive its Init, stop them whether it returned or not.
+	CancelSceneLoad();
+	if (init_task)
+	{
+		// The scene of the previous Init is about to be cleared, stop its load at the next file.
+		CancelLoad(&init_cancel_token);
+		thread_manager->WaitTask(thread_manager, init_task);
+		thread_manager->ReleaseTask(thread_manager, &init_task);
+	}
+
+	FOR_EACH_LIST(registered_sub_state_list, SubState, i, it,
+		it->state.Destroy(window);
+		);
+	active_sub_state_list->clear(active_sub_state_list);
+	registered_sub_state_list->clear(registered_sub_state_list);
+
+	if (Current_state.Destroy)
+		Current_state.Destroy(window);
+
+	if (New_state.Init)
+	{
+		ResetCancelToken(&init_cancel_token);
 
-			InitThreadInfo init_thread_info;
-			init_thread_info.state_info = New_state;
-			init_thread_info.window_manager = window;
+		InitThreadInfo init_thread_info;
+		init_thread_info.state_info = New_state;
+		init_thread_info.window_manager = window;
 
-			thread_manager->AddNewThread(thread_manager, &init_new_state, &init_thread_info, sfTrue, sizeof(init_thread_info));
+		init_task = thread_manager->AddNewTask(thread_manager, &init_new_state, &init_thread_info, sfTrue, sizeof(init_thread_info));
 
+	}
+	Current_state = New_state;
+	current_state_has_snapshot = GetStateSnapshot(Current_state.name, &current_snapshot_info);
+	snapshot_is_valid = sfFalse;
+	simulation_accumulator = 0.f;
+	current_init_step = GetStateInitStep(Current_state.name);
+	is_changing_state = sfFalse;
+	has_loaded_state = sfFalse;
+}
+
+static sfBool RunInitSteps(WindowManager* window, unsigned int budget_us)
+{
+	sfClock* budget_clock = sfClock_create();
+	while (current_init_step)
+	{
+		sfBool is_done;
+		PROFILE_ZONE("InitStep", is_done = current_init_step(window););
+		if (is_done)
+			current_init_step = NULL;
+
+		if (budget_us && sfClock_getElapsedTime(budget_clock).microseconds >= (sfInt64)budget_us)
+			break;
+	}
+	sfClock_destroy(budget_clock);
+	return current_init_step == NULL;
+}
+
+static void SimulateTick(WindowManager* window)
+{
+	sfBool update_main_state;
+	PROFILE_ZONE("UpdateSubState", update_main_state = UpdateSubState(window););
+	if (Current_state.Update && update_main_state)
+		PROFILE_ZONE("Update", Current_state.Update(window););
+}
+
+static void RenderFrame(WindowManager* window)
+{
+	window->Clear(window, sfBlack);
+
+	if (Current_state.Render && ShouldRenderMainState(window))
+	{
+		PROFILE_ZONE("Render", Current_state.Render(window););
+		if (Current_state.UIRender)
+		{
+			sfView* customView = window->GetCustomView(window);
+			window->SetDefaultView(window);
+			PROFILE_ZONE("UIRender", Current_state.UIRender(window););
+			if (customView)
+				window->SetCustomView(window, customView);
 		}
-		Current_state = New_state;
-		loading_delay = 1.f;
-		is_changing_state = sfFalse;
-		has_loaded_state = sfFalse;
 	}
+	PROFILE_ZONE("RenderSubState", RenderSubState(window););
+	PROFILE_ZONE("Display", window->Display(window););
+}
+
+static void Update(WindowManager* window)
+{
+	PROFILE_ZONE("WaitSimulation", WaitSimulationBatch(););
+	main_clock->restartClock(main_clock);
+	window->RestartClock(window);
+	DeltaTime = main_clock->getDeltaTime(main_clock);
+	if (is_changing_state)
+		ApplyStateChange(window);
+	PROFILE_ZONE("MainThreadTasks", thread_manager->RunMainThreadTasks(thread_manager, MAIN_THREAD_TASK_BUDGET_US););
 
 	if (!has_loaded_state)
 	{
+		UpdateKeyAndMouseState();
+		RenderAlpha = 1.f;
 		thread_manager->Update(thread_manager);
-		if (!thread_manager->GetThreadCount(thread_manager))
+		if (!init_task || thread_manager->IsTaskFinished(init_task))
 		{
- 			loading_delay -= DeltaTime;
-			if (loading_delay < 0.f)
-			{
+			thread_manager->ReleaseTask(thread_manager, &init_task);
+			if (RunInitSteps(window, INIT_STEP_BUDGET_US))
 				has_loaded_state = sfTrue;
-			}
 		}
 		if (Loading_state.Update && strcmp(Loading_state.name, "null") != 0)
 		{
@@ -192,35 +375,65 @@ static void Update(WindowManager* window)
 			{
 				EndGame(window);
 			}
+#ifdef PROFILER_ENABLED
+			if (event->type == sfEvtKeyPressed && event->key.code == sfKeyF12)
+				PROFILE_DUMP("profile.json");
+#endif
 			if (Current_state.UpdateEvent)
 				Current_state.UpdateEvent(window, event);
 		}
 
-		sfBool update_main_state = UpdateSubState(window);
-		if (Current_state.Update && update_main_state)
-			Current_state.Update(window);
+		float frame_time = DeltaTime;
+		int step_count = ConsumeSimulationSteps(frame_time);
 
-		window->Clear(window, sfBlack);
+		if (is_pipelined_mode && current_state_has_snapshot && !active_sub_state_list->size(active_sub_state_list) && !is_changing_state)
+		{
+			UpdatePipelined(window, step_count);
+			return;
+		}
+		snapshot_is_valid = sfFalse;
 
-		if (Current_state.Render && ShouldRenderMainState(window))
+		DeltaTime = FIXED_TIME_STEP;
+		for (int i = 0; i < step_count && !is_changing_state; i++)
 		{
-			Current_state.Render(window);
-			if (Current_state.UIRender)
-			{
-				sfView* customView = window->GetCustomView(window);
-				window->SetDefaultView(window);
-				Current_state.UIRender(window);
-				if (customView)
-					window->SetCustomView(window, customView);
-			}
+			UpdateKeyAndMouseState();
+			SimulateTick(window);
 		}
-		RenderSubState(window);
-		window->Display(window);
+		RenderAlpha = simulation_accumulator / FIXED_TIME_STEP;
+		DeltaTime = frame_time;
+
+		RenderFrame(window);
 	}
 }
 
 
 
+void SetPipelinedMode(sfBool enable)
+{
+	is_pipelined_mode = enable;
+}
+
+void PostToMainThread(void (*func)(void*), void* func_data, sfBool copy_data, size_t data_size)
+{
+	if (!thread_manager)
+	{
+		func(func_data);
+		return;
+	}
+	thread_manager->PostToMainThread(thread_manager, func, func_data, copy_data, data_size);
+}
+
+void PrefetchState(const char* state_name)
+{
+	const char* scene_name = GetStateScene(state_name);
+	if (!scene_name)
+	{
+		printf_d("ERROR, NO SCENE REGISTERED FOR STATE %s !!!!\n", state_name);
+		return;
+	}
+	PrefetchScene(scene_name);
+}
+
 void ChangeMainState(const char* state_name)
 {
 	New_state = GetState(state_name);
@@ -273,39 +486,116 @@ void PopSubState()
 
 static void CleanUpGame()
 {
+	WaitSimulationBatch();
 	FOR_EACH(registered_sub_state_list, StateInfo, i, it,
 		it->Destroy(GameWindow);
 		);
 	Current_state.Destroy(GameWindow);
+	if (simulation_thread)
+		simulation_thread->Destroy(&simulation_thread);
+	for (int i = 0; i < 2; i++)
+	{
+		if (snapshot_buffers[i])
+			free_d(snapshot_buffers[i]);
+		snapshot_buffers[i] = NULL;
+	}
 	main_clock->destroy(&main_clock);
+	StopFileWatcher();
+	__WaitAsyncLoads();
 	thread_manager->Destroy(&thread_manager);
+	DestroyJobScheduler();
 	GameWindow->Destroy(&GameWindow);
 }
 
 
+static void SetUpGame(const char* starting_state)
+{
+	// One worker for the state init, which waits for the critical files, the others for the scene loader tasks.
+	thread_manager = CreateThreadManager(MAX_THREAD + 1);
+	InitJobScheduler(0);
+	main_clock = CreateClock();
+	registered_sub_state_list = STD_LIST_CREATE(SubState, 0);
+	active_sub_state_list = STD_LIST_CREATE(SubState, 0);
+	ChangeMainState(starting_state);
+}
+
 void StartGame(WindowManager* window_manager, const char* starting_state, const char* loading_state, void(*ResetLoadingStateFunc)(WindowManager* window))
 {
 	srand((unsigned int)time(NULL));
+	PROFILE_THREAD_NAME("Main");
 	GameWindow = window_manager;
 	Loading_state = GetState(loading_state);
 	ResetLoadingStateFunction = ResetLoadingStateFunc;
-	loading_delay = 0.f;
 	if (Loading_state.Init)
 		Loading_state.Init(window_manager);
-	thread_manager = CreateThreadManager(2);
-	main_clock = CreateClock();
-	registered_sub_state_list = STD_LIST_CREATE(SubState, 0);
-	active_sub_state_list = STD_LIST_CREATE(SubState, 0);
-	ChangeMainState(starting_state);
+	SetUpGame(starting_state);
 	while (sfRenderWindow_isOpen(window_manager->GetWindow(window_manager)))
 	{
-		Update(window_manager);
+		PROFILE_ZONE("Frame", Update(window_manager););
+	}
+	CleanUpGame();
+	PROFILE_SHUTDOWN();
+	ReportLeaks();
+}
+
+void StartGameHeadless(WindowManager* window_manager, const char* starting_state, unsigned int tick_count)
+{
+	// sfClock is monotonic on every platform and needs no graphics context.
+	sfClock* tick_clock = sfClock_create();
+	double total_time = 0.0, worst_time = 0.0;
+	unsigned int tick = 0;
+
+	srand(HEADLESS_RANDOM_SEED);
+	PROFILE_THREAD_NAME("Main");
+	GameWindow = window_manager;
+	is_headless_running = sfTrue;
+	SetUpGame(starting_state);
+
+	while (tick < tick_count && is_headless_running)
+	{
+		if (is_changing_state)
+		{
+			ApplyStateChange(window_manager);
+			if (init_task)
+			{
+				thread_manager->WaitTask(thread_manager, init_task);
+				thread_manager->ReleaseTask(thread_manager, &init_task);
+			}
+			RunInitSteps(window_manager, 0);
+			has_loaded_state = sfTrue;
+		}
+		thread_manager->RunMainThreadTasks(thread_manager, 0);
+		thread_manager->Update(thread_manager);
+
+		sfClock_restart(tick_clock);
+		DeltaTime = FIXED_TIME_STEP;
+		RenderAlpha = 1.f;
+		PROFILE_ZONE("Frame",
+			SimulateTick(window_manager);
+			RenderFrame(window_manager);
+			);
+		double tick_time = (double)sfClock_getElapsedTime(tick_clock).microseconds / 1000.0;
+		total_time += tick_time;
+		if (tick_time > worst_time)
+			worst_time = tick_time;
+		tick++;
 	}
+
+	printf("headless: %u ticks of %s, total %.3f ms, average %.4f ms, worst %.4f ms\n",
+		tick, starting_state, total_time, tick ? total_time / tick : 0.0, worst_time);
+	sfClock_destroy(tick_clock);
+
 	CleanUpGame();
+	PROFILE_SHUTDOWN();
 	ReportLeaks();
 }
 
 void EndGame(WindowManager* window)
 {
+	if (!window->GetWindow(window))
+	{
+		is_headless_running = sfFalse;
+		return;
+	}
 	sfRenderWindow_close(window->GetWindow(window));
 }
\ No newline at end of file
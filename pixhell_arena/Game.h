@@ -31,6 +31,24 @@
  * @brief This file contains the core of the game engine.
 */
 
+/**
+ * @def FIXED_TIME_STEP
+ * @brief Duration of one simulation tick, in seconds. Update functions always see this value in DeltaTime.
+ */
+#define FIXED_TIME_STEP (1.f / 60.f)
+
+/**
+ * @def MAX_FRAME_TIME
+ * @brief Longest frame time fed to the simulation, in seconds. Longer frames (breakpoint, window drag) are clamped.
+ */
+#define MAX_FRAME_TIME 0.25f
+
+/**
+ * @def MAX_SIMULATION_STEPS
+ * @brief Maximum number of simulation ticks per rendered frame, the remaining backlog is dropped to avoid the spiral of death.
+ */
+#define MAX_SIMULATION_STEPS 5
+
 /**
  * @brief Starts the game with a specified loading screen animation.
  * @param window_manager Pointer to the WindowManager object for managing the application window.
@@ -40,6 +58,37 @@
  */
 void StartGame(WindowManager* window_manager, const char* starting_state, const char* loading_state, void(*ResetLoadingStateFunc)(WindowManager* window));
 
+/**
+ * @def INIT_STEP_BUDGET_US
+ * @brief Time the loading screen gives each frame to the init steps of the new state, in microseconds. See REGISTER_STATE_INIT_STEP.
+ */
+#define INIT_STEP_BUDGET_US 4000
+
+/**
+ * @def MAIN_THREAD_TASK_BUDGET_US
+ * @brief Time the main loop spends each frame on the tasks posted with PostToMainThread, in microseconds.
+ */
+#define MAIN_THREAD_TASK_BUDGET_US 2000
+
+/**
+ * @def HEADLESS_RANDOM_SEED
+ * @brief Seed given to srand by StartGameHeadless so two runs of the same state simulate the same ticks.
+ */
+#define HEADLESS_RANDOM_SEED 1337u
+
+/**
+ * @brief Runs a state for a fixed number of ticks without opening a window, then prints the tick timings.
+ * @param window_manager Window manager created with CreateHeadlessWindowManager.
+ * @param starting_state Name of the state to simulate.
+ * @param tick_count Number of ticks to run, each tick advances the simulation by FIXED_TIME_STEP.
+ *
+ * The state init is waited for instead of showing a loading screen, keyboard and mouse are never sampled
+ * and the render functions still run against the null sink of the headless window.
+ * No graphics context is needed when the resources are loaded after SetHeadlessResources(sfTrue).
+ * The game is cleaned up and leaks are reported before the function returns, like StartGame.
+ */
+void StartGameHeadless(WindowManager* window_manager, const char* starting_state, unsigned int tick_count);
+
 /**
  * @brief Ends the game and exits the StartGame function.
  * @param window Pointer to the WindowManager object.
@@ -48,6 +97,35 @@ void StartGame(WindowManager* window_manager, const char* starting_state, const
  */
 void EndGame(WindowManager* window);
 
+/**
+ * @brief Enables or disables the pipelined mode.
+ * @param enable sfTrue to run the simulation on a worker thread while the main thread renders the previous tick.
+ *
+ * Only states registered with REGISTER_STATE_SNAPSHOT are pipelined, and only while no sub-state is active.
+ * The other states keep running update and render back-to-back on the main thread.
+ */
+void SetPipelinedMode(sfBool enable);
+
+/**
+ * @brief Queues a function to be executed by the main thread, e.g. a GPU-side step of a background loader. Can be called from any thread.
+ * @param func The function to execute on the main thread.
+ * @param func_data Data to pass to the function, if any.
+ * @param copy_data Flag to indicate whether to copy the data or not.
+ * @param data_size Size of the data to pass to the function.
+ *
+ * The queue is drained at the start of every frame, for at most MAIN_THREAD_TASK_BUDGET_US.
+ * Before StartGame the function is executed right away on the calling thread.
+ */
+void PostToMainThread(void (*func)(void*), void* func_data, sfBool copy_data, size_t data_size);
+
+/**
+ * @brief Starts loading the resource scene of a state in the background, while the current state keeps running.
+ * @param state_name Name of the state, which must declare its scene with REGISTER_STATE_SCENE.
+ *
+ * The LoadScene of the state Init then only waits for what is left to load.
+ */
+void PrefetchState(const char* state_name);
+
 /**
  * @brief Changes the current state of the application.
  * @param state_name Name of the new state.
@@ -1,8 +1,16 @@
 #include "InGame.h"
 #include "Players.h"
 
+typedef struct
+{
+	PlayerSnapshot players[PLAYER_NUMBER];
+	ProjectilesSnapshot projectiles;
+} InGameSnapshot;
+
 void InitInGame(WindowManager* windowManager)
 {
+	DeclareCriticalAsset("Game", "InGameP1");
+	DeclareCriticalAsset("Game", "InGameP2");
 	LoadScene("Game");
 	InitPlayers();
 	InitProjectiles();
@@ -36,4 +44,26 @@ void DestroyInGame(WindowManager* windowManager)
 	DestroyProjectiles();
 }
 
-REGISTER_STATE(InGame)
\ No newline at end of file
+void CaptureInGame(void* snapshot)
+{
+	InGameSnapshot* in_game_snapshot = snapshot;
+	CapturePlayers(in_game_snapshot->players);
+	CaptureProjectiles(&in_game_snapshot->projectiles);
+}
+
+void RenderSnapshotInGame(WindowManager* windowManager, const void* snapshot)
+{
+	const InGameSnapshot* in_game_snapshot = snapshot;
+	DisplayPlayersSnapshot(windowManager, in_game_snapshot->players);
+	DisplayProjectilesSnapshot(windowManager, &in_game_snapshot->projectiles);
+}
+
+void UIRenderSnapshotInGame(WindowManager* windowManager, const void* snapshot)
+{
+	const InGameSnapshot* in_game_snapshot = snapshot;
+	DisplayUIPlayersSnapshot(windowManager, in_game_snapshot->players);
+}
+
+REGISTER_STATE(InGame)
+REGISTER_STATE_SNAPSHOT(InGame, InGameSnapshot)
+REGISTER_STATE_SCENE(InGame, "Game")
\ No newline at end of file
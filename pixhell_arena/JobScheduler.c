@@ -0,0 +1,369 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "JobScheduler.h"
+#include "MemoryManagement.h"
+#include "Profiler.h"
+#include <windows.h>
+
+#define JOB_DEQUE_CAPACITY 256
+#define JOB_DEFAULT_GRAIN 1024
+#define JOB_IDLE_SPIN_COUNT 64
+
+typedef struct JobInfo JobInfo;
+struct JobInfo
+{
+	void (*fn)(size_t begin, size_t end, void* ctx);
+	void* ctx;
+	size_t grain;
+	volatile LONG64 m_remaining;
+};
+
+typedef struct JobRange JobRange;
+struct JobRange
+{
+	JobInfo* job;
+	size_t begin;
+	size_t end;
+};
+
+typedef struct JobDeque JobDeque;
+struct JobDeque
+{
+	SRWLOCK m_lock;
+	JobRange m_ranges[JOB_DEQUE_CAPACITY];
+	size_t m_top;
+	size_t m_bottom;
+};
+
+typedef struct JobWorker JobWorker;
+struct JobWorker
+{
+	sfThread* m_thread;
+	size_t m_index;
+};
+
+typedef struct JobScheduler JobScheduler;
+struct JobScheduler
+{
+	size_t m_worker_count;
+	JobWorker* m_workers;
+	JobDeque* m_deques; /**< One deque per worker, plus the last one for the external calling thread. */
+
+	SRWLOCK m_external_lock;
+	SRWLOCK m_sleep_lock;
+	CONDITION_VARIABLE m_work_available;
+	volatile LONG m_queued_ranges;
+	volatile LONG m_sleeping_workers;
+	volatile LONG m_is_running;
+};
+
+static JobScheduler* job_scheduler = NULL;
+static __declspec(thread) long tls_deque_index = -1;
+
+
+
+static sfBool PushRange(JobDeque* deque, JobRange range)
+{
+	AcquireSRWLockExclusive(&deque->m_lock);
+	if (deque->m_bottom - deque->m_top == JOB_DEQUE_CAPACITY)
+	{
+		ReleaseSRWLockExclusive(&deque->m_lock);
+		return sfFalse;
+	}
+	deque->m_ranges[deque->m_bottom % JOB_DEQUE_CAPACITY] = range;
+	deque->m_bottom++;
+	ReleaseSRWLockExclusive(&deque->m_lock);
+
+	InterlockedIncrement(&job_scheduler->m_queued_ranges);
+	if (InterlockedCompareExchange(&job_scheduler->m_sleeping_workers, 0, 0) > 0)
+	{
+		AcquireSRWLockExclusive(&job_scheduler->m_sleep_lock);
+		WakeAllConditionVariable(&job_scheduler->m_work_available);
+		ReleaseSRWLockExclusive(&job_scheduler->m_sleep_lock);
+	}
+	return sfTrue;
+}
+
+/* The owner takes the most recent range (bottom), it is the smallest one and still hot in cache. */
+static sfBool PopRange(JobDeque* deque, JobRange* range)
+{
+	AcquireSRWLockExclusive(&deque->m_lock);
+	if (deque->m_bottom == deque->m_top)
+	{
+		ReleaseSRWLockExclusive(&deque->m_lock);
+		return sfFalse;
+	}
+	deque->m_bottom--;
+	*range = deque->m_ranges[deque->m_bottom % JOB_DEQUE_CAPACITY];
+	ReleaseSRWLockExclusive(&deque->m_lock);
+	InterlockedDecrement(&job_scheduler->m_queued_ranges);
+	return sfTrue;
+}
+
+/* Thieves take the oldest range (top), it is the biggest one so one steal brings a lot of work. */
+static sfBool StealRange(JobDeque* deque, JobRange* range)
+{
+	if (!TryAcquireSRWLockExclusive(&deque->m_lock))
+		return sfFalse;
+	if (deque->m_bottom == deque->m_top)
+	{
+		ReleaseSRWLockExclusive(&deque->m_lock);
+		return sfFalse;
+	}
+	*range = deque->m_ranges[deque->m_top % JOB_DEQUE_CAPACITY];
+	deque->m_top++;
+	ReleaseSRWLockExclusive(&deque->m_lock);
+	InterlockedDecrement(&job_scheduler->m_queued_ranges);
+	return sfTrue;
+}
+
+static sfBool FindRange(size_t deque_index, JobRange* range)
+{
+	size_t deque_count = job_scheduler->m_worker_count + 1;
+	if (PopRange(&job_scheduler->m_deques[deque_index], range))
+		return sfTrue;
+	for (size_t i = 1; i < deque_count; i++)
+	{
+		if (StealRange(&job_scheduler->m_deques[(deque_index + i) % deque_count], range))
+			return sfTrue;
+	}
+	return sfFalse;
+}
+
+static void ProcessRange(size_t deque_index, JobRange range)
+{
+	while (range.end - range.begin > range.job->grain)
+	{
+		size_t middle = range.begin + (range.end - range.begin) / 2;
+		JobRange upper_half = { range.job, middle, range.end };
+		if (!PushRange(&job_scheduler->m_deques[deque_index], upper_half))
+			break;
+		range.end = middle;
+	}
+	range.job->fn(range.begin, range.end, range.job->ctx);
+	InterlockedExchangeAdd64(&range.job->m_remaining, -(LONG64)(range.end - range.begin));
+}
+
+static void WorkerFunction(void* data)
+{
+	JobWorker* worker = data;
+	tls_deque_index = (long)worker->m_index;
+	int idle_spin = 0;
+	JobRange range;
+
+	while (InterlockedCompareExchange(&job_scheduler->m_is_running, 0, 0))
+	{
+		if (FindRange(worker->m_index, &range))
+		{
+			ProcessRange(worker->m_index, range);
+			idle_spin = 0;
+			continue;
+		}
+		if (++idle_spin < JOB_IDLE_SPIN_COUNT)
+		{
+			YieldProcessor();
+			continue;
+		}
+
+		AcquireSRWLockExclusive(&job_scheduler->m_sleep_lock);
+		InterlockedIncrement(&job_scheduler->m_sleeping_workers);
+		if (!InterlockedCompareExchange(&job_scheduler->m_queued_ranges, 0, 0) && InterlockedCompareExchange(&job_scheduler->m_is_running, 0, 0))
+			SleepConditionVariableSRW(&job_scheduler->m_work_available, &job_scheduler->m_sleep_lock, INFINITE, 0);
+		InterlockedDecrement(&job_scheduler->m_sleeping_workers);
+		ReleaseSRWLockExclusive(&job_scheduler->m_sleep_lock);
+		idle_spin = 0;
+	}
+	PROFILE_THREAD_EXIT();
+}
+
+static size_t GetCoreCount(void)
+{
+	SYSTEM_INFO system_info;
+	GetSystemInfo(&system_info);
+	return system_info.dwNumberOfProcessors ? (size_t)system_info.dwNumberOfProcessors : 1;
+}
+
+void InitJobScheduler(size_t worker_count)
+{
+	if (job_scheduler)
+		return;
+	if (!worker_count)
+		worker_count = GetCoreCount() > 1 ? GetCoreCount() - 1 : 1;
+
+	job_scheduler = calloc_d(JobScheduler, 1);
+	assert(job_scheduler);
+	job_scheduler->m_worker_count = worker_count;
+	job_scheduler->m_workers = calloc_d(JobWorker, worker_count);
+	job_scheduler->m_deques = calloc_d(JobDeque, worker_count + 1);
+	assert(job_scheduler->m_workers);
+	assert(job_scheduler->m_deques);
+
+	for (size_t i = 0; i < worker_count + 1; i++)
+		InitializeSRWLock(&job_scheduler->m_deques[i].m_lock);
+	InitializeSRWLock(&job_scheduler->m_external_lock);
+	InitializeSRWLock(&job_scheduler->m_sleep_lock);
+	InitializeConditionVariable(&job_scheduler->m_work_available);
+	job_scheduler->m_is_running = 1;
+
+	for (size_t i = 0; i < worker_count; i++)
+	{
+		job_scheduler->m_workers[i].m_index = i;
+		job_scheduler->m_workers[i].m_thread = sfThread_create(&WorkerFunction, &job_scheduler->m_workers[i]);
+		sfThread_launch(job_scheduler->m_workers[i].m_thread);
+	}
+}
+
+size_t GetJobWorkerCount(void)
+{
+	return job_scheduler ? job_scheduler->m_worker_count : 0;
+}
+
+void ParallelFor(size_t begin, size_t end, size_t grain, void (*fn)(size_t begin, size_t end, void* ctx), void* ctx)
+{
+	if (end <= begin)
+		return;
+	if (!grain)
+		grain = JOB_DEFAULT_GRAIN;
+	if (!job_scheduler || end - begin <= grain)
+	{
+		fn(begin, end, ctx);
+		return;
+	}
+
+	/* The external deque is shared by every non worker thread, only one of them can drive a job at a time. */
+	sfBool is_external = tls_deque_index < 0;
+	if (is_external)
+	{
+		AcquireSRWLockExclusive(&job_scheduler->m_external_lock);
+		tls_deque_index = (long)job_scheduler->m_worker_count;
+	}
+	size_t deque_index = (size_t)tls_deque_index;
+
+	JobInfo job = { fn, ctx, grain, (LONG64)(end - begin) };
+	JobRange range = { &job, begin, end };
+	ProcessRange(deque_index, range);
+
+	/* Help with any pending range until every index of this job is done, nested jobs included. */
+	while (InterlockedCompareExchange64(&job.m_remaining, 0, 0) > 0)
+	{
+		if (FindRange(deque_index, &range))
+			ProcessRange(deque_index, range);
+		else
+			YieldProcessor();
+	}
+
+	if (is_external)
+	{
+		tls_deque_index = -1;
+		ReleaseSRWLockExclusive(&job_scheduler->m_external_lock);
+	}
+}
+
+void DestroyJobScheduler(void)
+{
+	if (!job_scheduler)
+		return;
+
+	AcquireSRWLockExclusive(&job_scheduler->m_sleep_lock);
+	InterlockedExchange(&job_scheduler->m_is_running, 0);
+	WakeAllConditionVariable(&job_scheduler->m_work_available);
+	ReleaseSRWLockExclusive(&job_scheduler->m_sleep_lock);
+
+	for (size_t i = 0; i < job_scheduler->m_worker_count; i++)
+	{
+		sfThread_wait(job_scheduler->m_workers[i].m_thread);
+		sfThread_destroy(job_scheduler->m_workers[i].m_thread);
+	}
+	free_d(job_scheduler->m_deques);
+	free_d(job_scheduler->m_workers);
+	free_d(job_scheduler);
+	job_scheduler = NULL;
+}
+
+
+typedef struct BenchmarkElement BenchmarkElement;
+struct BenchmarkElement
+{
+	sfVector2f m_position;
+	sfVector2f m_direction;
+	float m_rotation;
+	float m_speed;
+	float m_despawn_timer;
+	float m_despawn_time;
+};
+
+static void UpdateBenchmarkElements(size_t begin, size_t end, void* ctx)
+{
+	BenchmarkElement* elements = ctx;
+	const float delta_time = 1.f / 60.f;
+	for (size_t i = begin; i < end; i++)
+	{
+		BenchmarkElement* it = &elements[i];
+		it->m_despawn_timer += delta_time;
+		if (it->m_despawn_timer > it->m_despawn_time)
+			it->m_despawn_timer = 0.f;
+		it->m_position.x += it->m_direction.x * it->m_speed * delta_time;
+		it->m_position.y += it->m_direction.y * it->m_speed * delta_time;
+		it->m_direction.x = cosf(it->m_rotation);
+		it->m_direction.y = sinf(it->m_rotation);
+		it->m_rotation += 0.5f * delta_time;
+	}
+}
+
+void RunParallelForBenchmark(size_t element_count)
+{
+	const int frame_count = 200;
+	size_t max_threads = GetCoreCount();
+	BenchmarkElement* elements = calloc_d(BenchmarkElement, element_count);
+	assert(elements);
+	for (size_t i = 0; i < element_count; i++)
+	{
+		elements[i].m_speed = 100.f;
+		elements[i].m_despawn_time = 2.f + (float)(i % 100) / 100.f;
+		elements[i].m_rotation = (float)i;
+	}
+
+	LARGE_INTEGER frequency, start, stop;
+	QueryPerformanceFrequency(&frequency);
+	double single_thread_time = 0.;
+
+	printf("ParallelFor benchmark: %zu elements, %d frames\n", element_count, frame_count);
+	for (size_t thread_count = 1; thread_count <= max_threads; thread_count++)
+	{
+		if (thread_count > 1)
+			InitJobScheduler(thread_count - 1);
+
+		QueryPerformanceCounter(&start);
+		for (int frame = 0; frame < frame_count; frame++)
+			ParallelFor(0, element_count, JOB_DEFAULT_GRAIN, &UpdateBenchmarkElements, elements);
+		QueryPerformanceCounter(&stop);
+
+		double frame_time = (double)(stop.QuadPart - start.QuadPart) * 1000. / (double)frequency.QuadPart / frame_count;
+		if (thread_count == 1)
+			single_thread_time = frame_time;
+		printf("  %2zu thread(s): %8.4f ms/frame  x%.2f\n", thread_count, frame_time, single_thread_time / frame_time);
+
+		DestroyJobScheduler();
+	}
+	free_d(elements);
+}
@@ -0,0 +1,82 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "SFML/System.h"
+
+/**
+ * @file jobscheduler.h
+ * @brief This file defines a work-stealing job scheduler used to split large per-frame updates across every core.
+ *
+ * Each worker owns a deque of index ranges. A range bigger than the grain is split in two, the upper half is pushed
+ * on the worker's own deque where idle workers can steal it, and the lower half keeps being processed locally.
+ * The calling thread takes part in the work until the whole range is done, so ParallelFor returns only once every index has been processed.
+ *
+ * @code
+ * // Example usage, updating 100k particles by chunks of 1024:
+ * static void UpdateChunk(size_t begin, size_t end, void* ctx)
+ * {
+ *     Particle* particles = ctx;
+ *     for (size_t i = begin; i < end; i++)
+ *         UpdateParticle(&particles[i]);
+ * }
+ *
+ * InitJobScheduler(0);
+ * ParallelFor(0, 100000, 1024, &UpdateChunk, particles);
+ * DestroyJobScheduler();
+ * @endcode
+ */
+
+/**
+ * @brief Starts the worker threads of the job scheduler.
+ * @param worker_count Number of worker threads. 0 uses one worker per core minus the calling thread.
+ */
+void InitJobScheduler(size_t worker_count);
+
+/**
+ * @brief Gets the number of worker threads of the job scheduler, not counting the calling thread.
+ * @return The number of workers, 0 if the scheduler is not started.
+ */
+size_t GetJobWorkerCount(void);
+
+/**
+ * @brief Calls fn on every sub-range of [begin, end), splitting the work between the calling thread and the workers.
+ * @param begin First index of the range.
+ * @param end Index one past the last of the range.
+ * @param grain Size under which a range is no longer split. 0 lets the scheduler choose.
+ * @param fn Function called with a sub-range [begin, end) and the user context. It must not touch the other indexes.
+ * @param ctx User context given back to fn.
+ *
+ * @note Runs serially on the calling thread if the scheduler is not started. Can be nested from inside fn.
+ */
+void ParallelFor(size_t begin, size_t end, size_t grain, void (*fn)(size_t begin, size_t end, void* ctx), void* ctx);
+
+/**
+ * @brief Stops and joins the worker threads of the job scheduler.
+ */
+void DestroyJobScheduler(void);
+
+/**
+ * @brief Headless benchmark, prints the time of a particle-like update of element_count elements with 1 to N threads.
+ * @param element_count Number of elements updated each frame.
+ */
+void RunParallelForBenchmark(size_t element_count);
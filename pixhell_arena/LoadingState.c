@@ -5,6 +5,17 @@ sfRectangleShape* loading_bar;
 sfRectangleShape* loading_bar_outline;
 sfSprite* loading_sprite;
 sfSprite* background;
+sfBool are_loading_textures_set;
+
+// In RESOURCE_LOADING_ASYNC mode the sprites get the placeholder until their textures are loaded, they take them again once they are.
+static void SetLoadingTextures(void)
+{
+	are_loading_textures_set = IsTextureLoadedById(TEXTURE_ID_LOADING) && IsTextureLoadedById(TEXTURE_ID_MENU_SPRITESHEET);
+	sfSprite_setTexture(loading_sprite, GetTextureById(TEXTURE_ID_LOADING), sfTrue);
+	TextureRegion background_region = GetSpriteRegionById(TEXTURE_ID_MENU_SPRITESHEET, "Fond");
+	sfSprite_setTexture(background, background_region.m_texture, sfTrue);
+	sfSprite_setTextureRect(background, background_region.m_rect);
+}
 
 void InitLoading(WindowManager* windowManager)
 { 
@@ -21,13 +32,11 @@ void InitLoading(WindowManager* windowManager)
 	sfRectangleShape_setPosition(loading_bar_outline, sfVector2f_Create(560, 800));
 
 	loading_sprite = sfSprite_create();
-	sfSprite_setTexture(loading_sprite, GetTexture("loading"), sfTrue);
 	sfSprite_setOrigin(loading_sprite, sfVector2f_Create(128, 128));
 	sfSprite_setScale(loading_sprite, sfVector2f_Create(0.5f, 0.5f));
 
 	background = sfSprite_create();
-	sfSprite_setTexture(background, GetTexture("menu_spritesheet"), sfTrue);
-	sfSprite_setTextureRect(background, (sfIntRect) { 0, 0, 1920, 1080 });
+	SetLoadingTextures();
 } 
 
 void UpdateEventLoading(WindowManager* windowManager, sfEvent* evt) 
@@ -37,6 +46,8 @@ void UpdateEventLoading(WindowManager* windowManager, sfEvent* evt)
 
 void UpdateLoading(WindowManager* windowManager) 
 { 
+	if (!are_loading_textures_set && IsTextureLoadedById(TEXTURE_ID_LOADING) && IsTextureLoadedById(TEXTURE_ID_MENU_SPRITESHEET))
+		SetLoadingTextures();
 	sfRectangleShape_setSize(loading_bar, sfVector2f_Create(LERP(sfRectangleShape_getSize(loading_bar).x, LERP(0, 800, GetLoadingValue()) ,DeltaTime * 5.f), sfRectangleShape_getSize(loading_bar).y));
 	sfSprite_setRotation(loading_sprite, sfSprite_getRotation(loading_sprite) + 36.f * DeltaTime);
 }
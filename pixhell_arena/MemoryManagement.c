@@ -21,6 +21,7 @@
 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #include "MemoryManagement.h"
+#include <windows.h>
 
 typedef struct AllocInfo AllocInfo;
 struct AllocInfo
@@ -34,6 +35,7 @@ struct AllocInfo
 static stdList* allocations = NULL;
 static size_t totalAllocated = 0;
 static size_t totalFreed = 0;
+static SRWLOCK allocations_lock = SRWLOCK_INIT;
 
 static void allocationTracker(void* ptr, size_t size, const char* file, unsigned int line)
 {
@@ -46,21 +48,26 @@ static void allocationTracker(void* ptr, size_t size, const char* file, unsigned
 void* TrackerCalloc(size_t count, size_t size, const char* file, unsigned int line)
 {
 	void* ptr = calloc(count, size);
+	AcquireSRWLockExclusive(&allocations_lock);
 	allocationTracker(ptr, size, file, line);
+	ReleaseSRWLockExclusive(&allocations_lock);
 	return ptr;
 }
 
 void DetrackerCalloc(void* ptr)
 {
+	AcquireSRWLockExclusive(&allocations_lock);
 	FOR_EACH_LIST(allocations, AllocInfo, it, tmp,
 		if (tmp->ptr == ptr)
 		{
 			free(tmp->ptr);
 			totalFreed += tmp->size;
 			allocations->erase(allocations, it);
+			ReleaseSRWLockExclusive(&allocations_lock);
 			return;
 		}
 			)
+	ReleaseSRWLockExclusive(&allocations_lock);
 
 
 	free(ptr);
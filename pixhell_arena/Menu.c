@@ -8,13 +8,16 @@ SpriteManager* spriteManager;
 UIObjectManager* UIManager;
 sfSprite* starSelection;
 sfBool isButtonHovered;
+int initStep;
 
 void UpdateUIVisual(UIObject* object, WindowManager* window)
 {
 	if (object->isHover)
 	{
 		isButtonHovered = sfTrue;
-		sfSprite_setPosition(starSelection, AddVector2f(object->getPosition(object), sfVector2f_Create(358, 65)));
+		// The star is centered on the right edge of the button, whose rectangle is the one of its sprite in the menu sheet descriptor.
+		sfIntRect button_rect = object->getTextureRect(object);
+		sfSprite_setPosition(starSelection, AddVector2f(object->getPosition(object), sfVector2f_Create((float)button_rect.width, button_rect.height / 2.f)));
 	}
 
 	if (object->isClicked)
@@ -39,42 +42,71 @@ void InitMainMenu(WindowManager* windowManager)
 	windowManager->AddNewSound(windowManager, "SFX", 0.f);
 	windowManager->AddNewSound(windowManager, "Music", 50.f);
 
-	sfTexture* menu_spritesheet = GetTexture("menu_spritesheet");
-
-	spriteManager = CreateSpriteManager();
-	UIManager = CreateUIObjectManager();
-
-	starSelection = sfSprite_create();
-	sfSprite_setTexture(starSelection, menu_spritesheet, sfTrue);
-	sfSprite_setTextureRect(starSelection, (sfIntRect) { 0, 14146, 102, 97 });
-	sfSprite_setOrigin(starSelection, sfVector2f_Create(51, 48.5f));
-
-	sfSprite* spriteHolder = spriteManager->push_back(spriteManager, "BG1", menu_spritesheet, sfTrue);
-	sfSprite_setTextureRect(spriteHolder, (sfIntRect) { 0, 0, 1920, 1080 });
-
-	spriteHolder = spriteManager->push_back(spriteManager, "BG2", menu_spritesheet, sfTrue);
-	sfSprite_setTextureRect(spriteHolder, (sfIntRect) { 0, 1080, 1920, 1080 });
-
-	spriteHolder = spriteManager->push_back(spriteManager, "BG3", menu_spritesheet, sfTrue);
-	sfSprite_setTextureRect(spriteHolder, (sfIntRect) { 0, 2160, 1920, 1080 });
-
-	spriteHolder = spriteManager->push_back(spriteManager, "Title", menu_spritesheet, sfTrue);
-	sfSprite_setTextureRect(spriteHolder, (sfIntRect) { 0, 6259, 563, 468 });
-	sfSprite_setPosition(spriteHolder, sfVector2f_Create(678, 42));
-
-	UIObject* UIholder = UIManager->push_back(UIManager, CreateUIObjectFromSprite(NULL, "Play", sfMouseLeft, sfKeyUnknown));
-	UIholder->setTexture(UIholder, menu_spritesheet, sfFalse);
-	UIholder->setTextureRect(UIholder, (sfIntRect) { 0, 14004, 358, 142 });
-	UIholder->setPosition(UIholder, sfVector2f_Create(781, 520));
-	UIholder->setUpdateFunction(UIholder, &UpdateUIVisual);
-
-	UIholder = UIManager->push_back(UIManager, CreateUIObjectFromSprite(NULL, "Quit", sfMouseLeft, sfKeyUnknown));
-	UIholder->setTexture(UIholder, menu_spritesheet, sfFalse);
-	UIholder->setTextureRect(UIholder, (sfIntRect) { 0, 13436, 358, 142 });
-	UIholder->setPosition(UIholder, sfVector2f_Create(781, 840));
-	UIholder->setUpdateFunction(UIholder, &UpdateUIVisual);
-
+	initStep = 0;
+}
 
+sfBool InitStepMainMenu(WindowManager* windowManager)
+{
+	switch (initStep++)
+	{
+	case 0:
+		// In RESOURCE_LOADING_ASYNC mode the sheet loads in the background, the sprites would keep the placeholder.
+		if (!IsTextureLoadedById(TEXTURE_ID_MENU_SPRITESHEET))
+			initStep--;
+		return sfFalse;
+	case 1:
+	{
+		spriteManager = CreateSpriteManager();
+		UIManager = CreateUIObjectManager();
+
+		TextureRegion region = GetSpriteRegionById(TEXTURE_ID_MENU_SPRITESHEET, "Selection Star");
+		starSelection = sfSprite_create();
+		sfSprite_setTexture(starSelection, region.m_texture, sfTrue);
+		sfSprite_setTextureRect(starSelection, region.m_rect);
+		sfSprite_setOrigin(starSelection, sfVector2f_Create(region.m_rect.width / 2.f, region.m_rect.height / 2.f));
+		return sfFalse;
+	}
+	case 2:
+	{
+		TextureRegion region = GetSpriteRegionById(TEXTURE_ID_MENU_SPRITESHEET, "Fond");
+		sfSprite* spriteHolder = spriteManager->push_back(spriteManager, "BG1", region.m_texture, sfTrue);
+		sfSprite_setTextureRect(spriteHolder, region.m_rect);
+
+		region = GetSpriteRegionById(TEXTURE_ID_MENU_SPRITESHEET, "Fond2");
+		spriteHolder = spriteManager->push_back(spriteManager, "BG2", region.m_texture, sfTrue);
+		sfSprite_setTextureRect(spriteHolder, region.m_rect);
+
+		region = GetSpriteRegionById(TEXTURE_ID_MENU_SPRITESHEET, "Fond3");
+		spriteHolder = spriteManager->push_back(spriteManager, "BG3", region.m_texture, sfTrue);
+		sfSprite_setTextureRect(spriteHolder, region.m_rect);
+
+		region = GetSpriteRegionById(TEXTURE_ID_MENU_SPRITESHEET, "Logo");
+		spriteHolder = spriteManager->push_back(spriteManager, "Title", region.m_texture, sfTrue);
+		sfSprite_setTextureRect(spriteHolder, region.m_rect);
+		sfSprite_setPosition(spriteHolder, sfVector2f_Create(678, 42));
+		return sfFalse;
+	}
+	case 3:
+	{
+		TextureRegion region = GetSpriteRegionById(TEXTURE_ID_MENU_SPRITESHEET, "Solo");
+		UIObject* UIholder = UIManager->push_back(UIManager, CreateUIObjectFromSprite(NULL, "Play", sfMouseLeft, sfKeyUnknown));
+		UIholder->setTexture(UIholder, region.m_texture, sfFalse);
+		UIholder->setTextureRect(UIholder, region.m_rect);
+		UIholder->setPosition(UIholder, sfVector2f_Create(781, 520));
+		UIholder->setUpdateFunction(UIholder, &UpdateUIVisual);
+
+		region = GetSpriteRegionById(TEXTURE_ID_MENU_SPRITESHEET, "Quit");
+		UIholder = UIManager->push_back(UIManager, CreateUIObjectFromSprite(NULL, "Quit", sfMouseLeft, sfKeyUnknown));
+		UIholder->setTexture(UIholder, region.m_texture, sfFalse);
+		UIholder->setTextureRect(UIholder, region.m_rect);
+		UIholder->setPosition(UIholder, sfVector2f_Create(781, 840));
+		UIholder->setUpdateFunction(UIholder, &UpdateUIVisual);
+		return sfFalse;
+	}
+	default:
+		PrefetchState("InGame");
+		return sfTrue;
+	}
 }
 
 void UpdateEventMainMenu(WindowManager* windowManager, sfEvent* evt)
@@ -104,9 +136,18 @@ void UIRenderMainMenu(WindowManager* windowManager)
 
 void DestroyMainMenu(WindowManager* windowManager)
 {
-	spriteManager->destroy(&spriteManager);
-	UIManager->destroy(&UIManager);
-	sfSprite_destroy(starSelection);
+	// A state change can come before the init steps built everything.
+	if (spriteManager)
+		spriteManager->destroy(&spriteManager);
+	if (UIManager)
+		UIManager->destroy(&UIManager);
+	if (starSelection)
+	{
+		sfSprite_destroy(starSelection);
+		starSelection = NULL;
+	}
 }
 
-REGISTER_STATE(MainMenu)
\ No newline at end of file
+REGISTER_STATE(MainMenu)
+REGISTER_STATE_INIT_STEP(MainMenu)
+REGISTER_STATE_SCENE(MainMenu, "Menu")
\ No newline at end of file
@@ -24,16 +24,22 @@
 #include "AudioManager.h"
 
 
-stdList* global_movie_list, * scene_movie_list;
+stdList* global_movie_list, * scene_movie_list, * prefetch_movie_list;
 Movie movie_place_holder;
+static SRWLOCK movie_list_lock = SRWLOCK_INIT;
+static ResourceRegistry* movie_registry;
+static ResourceCache* movie_cache;
+static size_t movie_budget = DEFAULT_MOVIE_BUDGET;
 
 Movie CreateMovie(const char* path)
 {
 	Movie tmp;
 	Path tmpPath = fs_create_path(path);
-	tmp.m_movie = sfeMovie_createFromFile(path);
+	// A movie renders to a texture, so none is opened without a graphics context.
+	tmp.m_movie = is_headless_resources ? NULL : sfeMovie_createFromFile(path);
 	tmp.m_path = tmpPath;
-	strcpy_s(tmp.m_name, MAX_PATH_SIZE, tmpPath.stem(&tmpPath).path_data.m_path);
+	tmp.m_load_state = RESOURCE_LOADED;
+	fs_stem(path, tmp.m_name, MAX_PATH_SIZE);
 	ToLower(tmp.m_name);
 	printf_d("Movie {\n\tPath : %s\n\tName: %s\n } loaded\n\n", tmp.m_path.path_data.m_path, tmp.m_name);
 	return tmp;
@@ -43,7 +49,75 @@ Movie CreateMovie(const char* path)
 
 void DeleteMovie(Movie* movie)
 {
-	sfeMovie_destroy(movie->m_movie);
+	if (movie->m_movie)
+		sfeMovie_destroy(movie->m_movie);
+}
+
+static Movie CreateUnloadedMovie(const char* path)
+{
+	Movie tmp = { 0 };
+	tmp.m_path = fs_create_path(path);
+	fs_stem(path, tmp.m_name, MAX_PATH_SIZE);
+	ToLower(tmp.m_name);
+	tmp.m_load_state = RESOURCE_UNLOADED;
+	return tmp;
+}
+
+static void LoadMovieOnFirstUse(void* resource)
+{
+	Movie* movie = resource;
+	Movie loaded = CreateMovie(movie->m_path.path_data.m_path);
+	movie->m_movie = loaded.m_movie;
+}
+
+static sfeMovie* RequireMovie(Movie* movie)
+{
+	if (__RequireResource(&movie->m_load_state, &LoadMovieOnFirstUse, movie))
+		return movie->m_movie;
+	return movie_place_holder.m_movie;
+}
+
+static size_t GetMovieMemorySize(const Movie* movie)
+{
+	// The frame texture is what a movie keeps in memory, the file is streamed.
+	if (!movie->m_movie)
+		return 0;
+	sfVector2f size = sfeMovie_getSize(movie->m_movie);
+	return (size_t)size.x * (size_t)size.y * 4;
+}
+
+static void DestroyCachedMovie(void* movie)
+{
+	DeleteMovie(movie);
+}
+
+// Instead of being destroyed with its scene, the movie waits in the cache in case a next scene uses it again.
+static void RetireMovie(Movie* movie)
+{
+	// No movie is created without a graphics context.
+	if (movie->m_movie)
+		sfeMovie_stop(movie->m_movie);
+	movie_cache->Store(movie_cache, movie->m_name, movie->m_path.path_data.m_path, movie, movie->m_movie, GetMovieMemorySize(movie));
+}
+
+static Movie TakeOrCreateMovie(const char* path)
+{
+	Movie tmp;
+	if (!movie_cache->Take(movie_cache, path, &tmp))
+		tmp = CreateMovie(path);
+	return tmp;
+}
+
+// The global list is complete, its entries no longer move.
+static void RegisterGlobalMovies(void)
+{
+	movie_registry = CreateResourceRegistry();
+	// Registered first, so the handle of an identifier is the identifier plus one.
+	for (int i = 0; i < MOVIE_ID_COUNT; i++)
+		movie_registry->GetHandle(movie_registry, movie_id_names[i], NULL);
+	FOR_EACH_LIST(global_movie_list, Movie, it, tmp,
+		movie_registry->AddGlobalResource(movie_registry, tmp->m_name, tmp);
+		)
 }
 
 void InitMovieManager(void)
@@ -60,13 +134,17 @@ void InitMovieManager(void)
 
 			global_movie_list = stdList_Create(sizeof(Movie), 0);
 			scene_movie_list = stdList_Create(sizeof(Movie), 0);
+			prefetch_movie_list = stdList_Create(sizeof(Movie), 0);
 			FOR_EACH_TEMP_LIST(filesInfos, FilesInfo, SearchFilesInfos(fs_path.path_data.m_path, "mp4"),
-				Movie tmp = CreateMovie(STD_GETDATA(filesInfos, FilesInfo, i)->m_path);
+				const char* file_path = STD_GETDATA(filesInfos, FilesInfo, i)->m_path;
+				Movie tmp = __IsLoadedEagerly(file_path) ? CreateMovie(file_path) : CreateUnloadedMovie(file_path);
 			if (strcmp(tmp.m_name, "placeholder") == 0)
 				movie_place_holder = tmp;
 			else
 				global_movie_list->push_back(global_movie_list, &tmp);
 				)
+			RegisterGlobalMovies();
+			movie_cache = CreateResourceCache(sizeof(Movie), movie_registry, &DestroyCachedMovie, movie_budget);
 		}
 	}
 	else
@@ -76,51 +154,119 @@ void InitMovieManager(void)
 	}
 }
 
-void LoadMovie(const char* path)
+void LoadMovie(const char* path, const CancelToken* cancel_token)
 {
-	Movie tmp = CreateMovie(path);
+	Movie tmp = TakeOrCreateMovie(path);
+	if (IsLoadCancelled(cancel_token))
+	{
+		RetireMovie(&tmp);
+		return;
+	}
+	AcquireSRWLockExclusive(&movie_list_lock);
 	scene_movie_list->push_back(scene_movie_list, &tmp);
+	ReleaseSRWLockExclusive(&movie_list_lock);
+	movie_registry->AddSceneResource(movie_registry, tmp.m_name, tmp.m_movie);
+}
+
+
+void LoadSceneMovie(const char* scene, SceneLoader* loader)
+{
+	ClearSceneMovie();
+	__LoadScene(scene, MOVIE_EXTENSION, MOVIE_DIRECTORY, loader, &LoadMovie);
+}
+
+static void Prefetch_Movie(const char* path, const CancelToken* cancel_token)
+{
+	Movie tmp = TakeOrCreateMovie(path);
+	if (IsLoadCancelled(cancel_token))
+	{
+		RetireMovie(&tmp);
+		return;
+	}
+	AcquireSRWLockExclusive(&movie_list_lock);
+	prefetch_movie_list->push_back(prefetch_movie_list, &tmp);
+	ReleaseSRWLockExclusive(&movie_list_lock);
 }
 
+void PrefetchSceneMovie(const char* scene, SceneLoader* loader)
+{
+	ClearPrefetchedSceneMovie();
+	__LoadScene(scene, MOVIE_EXTENSION, MOVIE_DIRECTORY, loader, &Prefetch_Movie);
+}
 
-void LoadSceneMovie(const char* scene, float* progressValue)
+void CommitPrefetchedSceneMovie(void)
 {
 	ClearSceneMovie();
-	__LoadScene(scene, "mp4", "Movies", progressValue, &LoadMovie);
+	stdList* tmp = scene_movie_list;
+	scene_movie_list = prefetch_movie_list;
+	prefetch_movie_list = tmp;
+	FOR_EACH_LIST(scene_movie_list, Movie, it, scene_movie,
+		movie_registry->AddSceneResource(movie_registry, scene_movie->m_name, scene_movie->m_movie);
+		)
+}
+
+void ClearPrefetchedSceneMovie(void)
+{
+	if (prefetch_movie_list != NULL)
+	{
+		for (int i = 0; i < prefetch_movie_list->size(prefetch_movie_list); i++)
+			RetireMovie(STD_GETDATA(prefetch_movie_list, Movie, i));
+		prefetch_movie_list->clear(prefetch_movie_list);
+	}
 }
 
 void ClearSceneMovie(void)
 {
 	if (scene_movie_list != NULL)
 	{
+		movie_registry->ClearSceneResources(movie_registry);
 		for (int i = 0; i < scene_movie_list->size(scene_movie_list); i++)
-			sfeMovie_destroy(STD_GETDATA(scene_movie_list, Movie, i)->m_movie);
+			RetireMovie(STD_GETDATA(scene_movie_list, Movie, i));
 		scene_movie_list->clear(scene_movie_list);
 	}
 }
 
-sfeMovie* GetMovie(const char* name)
+void SetMovieBudget(size_t budget)
 {
-	if (global_movie_list != NULL)
-		FOR_EACH_LIST(global_movie_list, Movie, it, tmp,
-			if (strcmp(tmp->m_name, name) == 0)
-				return tmp->m_movie;
-				)
+	movie_budget = budget;
+	if (movie_cache)
+		movie_cache->SetBudget(movie_cache, budget);
+}
 
-		if (scene_movie_list != NULL)
-			FOR_EACH_LIST(scene_movie_list, Movie, it, tmp,
-				if (strcmp(tmp->m_name, name) == 0)
-					return tmp->m_movie;
-					)
+ResourceHandle GetMovieHandle(const char* name)
+{
+	return movie_registry ? movie_registry->GetHandle(movie_registry, name, NULL) : INVALID_RESOURCE_HANDLE;
+}
 
-			if (movie_place_holder.m_movie)
-			{
-				printf_d("Movie %s not found, placeholder returned", name);
-				return movie_place_holder.m_movie;
-			}
+sfeMovie* GetMovieById(MovieId id)
+{
+	return GetMovieFromHandle((ResourceHandle)id + 1);
+}
 
-	printf_d("No Movie placeholder found, put a placeholder.mp4 in your %s/ALL/Movies folder", resource_directory);
-	return NULL;
+sfeMovie* GetMovieFromHandle(ResourceHandle handle)
+{
+	ResourceEntry* entry = movie_registry ? movie_registry->GetEntry(movie_registry, handle) : NULL;
+	if (entry)
+	{
+		if (entry->m_global_resource)
+			return RequireMovie(entry->m_global_resource);
+		if (entry->m_scene_resource)
+			return entry->m_scene_resource;
+	}
+	return movie_place_holder.m_movie;
+}
+
+sfeMovie* GetMovie(const char* name)
+{
+	sfBool is_new = sfFalse;
+	ResourceHandle handle = movie_registry ? movie_registry->GetHandle(movie_registry, name, &is_new) : INVALID_RESOURCE_HANDLE;
+	sfeMovie* movie = GetMovieFromHandle(handle);
+	if (!movie)
+		printf_d("No Movie placeholder found, put a placeholder.mp4 in your %s/ALL/Movies folder", resource_directory);
+	// Only the first lookup of a missing name prints, the next ones hit its empty entry.
+	else if (is_new && movie == movie_place_holder.m_movie)
+		printf_d("Movie %s not found, placeholder returned", name);
+	return movie;
 }
 
 void DestroyMoviesManager(void)
@@ -133,5 +279,9 @@ void DestroyMoviesManager(void)
 		global_movie_list->clear(global_movie_list);
 	}
 	scene_movie_list->destroy(&scene_movie_list);
+	ClearPrefetchedSceneMovie();
+	prefetch_movie_list->destroy(&prefetch_movie_list);
 	global_movie_list->destroy(&global_movie_list);
+	movie_cache->Destroy(&movie_cache);
+	movie_registry->Destroy(&movie_registry);
 }
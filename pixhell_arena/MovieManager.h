@@ -22,12 +22,32 @@
 */
 #pragma once
 #include "Tools.h"
+#include "ResourceCache.h"
+#include "ResourceIds.h"
 
 /**
  * @file moviemanager.h
  * @brief This file contains all the data to load movies for the engine.
  */
 
+/**
+ * @def MOVIE_EXTENSION
+ * @brief Extension of the movies files.
+ */
+#define MOVIE_EXTENSION "mp4"
+
+/**
+ * @def MOVIE_DIRECTORY
+ * @brief Name of the movies directory inside a scene directory.
+ */
+#define MOVIE_DIRECTORY "Movies"
+
+/**
+ * @def DEFAULT_MOVIE_BUDGET
+ * @brief Default size in bytes of the movies of the previous scenes kept loaded, see SetMovieBudget.
+ */
+#define DEFAULT_MOVIE_BUDGET (32 * 1024 * 1024)
+
 
 /**
  * @struct Movie
@@ -39,6 +59,7 @@ struct Movie
     sfeMovie* m_movie;              /**< Pointer to the movie object for playback. */
     Path m_path;                   /**< Path to the movie file. */
     char m_name[MAX_PATH_SIZE];    /**< Name of the movie, used for identification. */
+    volatile LONG m_load_state;    /**< ResourceLoadState of the movie, see __RequireResource. */
 };
 
 /**
@@ -63,15 +84,34 @@ void InitMovieManager(void);
 /**
  * @brief Loads movies associated with a specific scene.
  * @param scene Name of the scene for which movies should be loaded.
+ * @param loader Loader the files are queued on, they load once it is started.
  */
-void LoadSceneMovie(const char* scene, float* progressValue);
+void LoadSceneMovie(const char* scene, SceneLoader* loader);
 
 /**
  * @brief Clears all movies associated with the current scene.
- * This function frees memory and unloads scene-specific movies.
+ * They are handed to the cache of the manager, the next scenes take them back without loading them again.
  */
 void ClearSceneMovie(void);
 
+/**
+ * @brief Loads the movies of a scene into a separate list, without touching the movies of the current scene.
+ * @param scene Name of the scene for which movies should be prefetched.
+ * @param loader Loader the files are queued on, they load once it is started.
+ */
+void PrefetchSceneMovie(const char* scene, SceneLoader* loader);
+
+/**
+ * @brief Replaces the movies of the current scene by the prefetched ones.
+ * The movies of the previous scene are freed.
+ */
+void CommitPrefetchedSceneMovie(void);
+
+/**
+ * @brief Frees the prefetched movies that were never committed.
+ */
+void ClearPrefetchedSceneMovie(void);
+
 /**
  * @brief Retrieves a movie object by its name.
  * @param name Name of the movie to retrieve.
@@ -79,6 +119,33 @@ void ClearSceneMovie(void);
  */
 sfeMovie* GetMovie(const char* name);
 
+/**
+ * @brief Retrieves the stable handle of a movie name, to resolve it every frame with GetMovieFromHandle instead of looking the name up.
+ * @param name Name of the movie, compared without case. It does not have to be loaded yet.
+ * @return The handle of the name.
+ */
+ResourceHandle GetMovieHandle(const char* name);
+
+/**
+ * @brief Retrieves a movie object by its handle, without any name lookup.
+ * @param handle Handle returned by GetMovieHandle.
+ * @return Pointer to the movie object, or the placeholder while no movie of that name is loaded.
+ */
+sfeMovie* GetMovieFromHandle(ResourceHandle handle);
+
+/**
+ * @brief Retrieves a movie object by its generated identifier, see ResourceIds.h. A renamed or removed movie fails to compile instead of returning the placeholder.
+ * @param id Identifier of the movie.
+ * @return Pointer to the movie object, or the placeholder while it is not loaded.
+ */
+sfeMovie* GetMovieById(MovieId id);
+
+/**
+ * @brief Sets the size of the movies of the previous scenes kept loaded. The least recently used ones are destroyed over it.
+ * @param budget Budget in bytes, DEFAULT_MOVIE_BUDGET by default.
+ */
+void SetMovieBudget(size_t budget);
+
 /**
  * @brief Destroys the movie manager and releases all associated resources.
  */
@@ -0,0 +1,353 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "PackFile.h"
+#include "ResourceManifest.h"
+#include "MemoryManagement.h"
+#include <ctype.h>
+
+static fs_mapped_file pack_mapping;
+static const PackEntry* pack_entries;
+static unsigned int pack_entry_count;
+static char pack_root[MAX_PATH_SIZE];
+static sfBool* pack_stale_entries; /**< sfTrue for the entries whose loose file changed after the pack was built. */
+
+
+static void NormalizePackPath(char* path)
+{
+	for (; *path; path++)
+		*path = *path == '/' ? '\\' : (char)tolower((unsigned char)*path);
+}
+
+// Writes in relative_path the path of a file relative to root, both normalized. Returns sfFalse if the file is outside of root.
+static sfBool GetRelativePath(const char* root, const char* path, char* relative_path)
+{
+	NEW_CHAR(normalized, MAX_PATH_SIZE)
+		strcpy_s(normalized, MAX_PATH_SIZE, path);
+	NormalizePackPath(normalized);
+	size_t root_length = strlen(root);
+	if (strncmp(normalized, root, root_length) != 0)
+		return sfFalse;
+	if (normalized[root_length] == '\0')
+	{
+		relative_path[0] = '\0';
+		return sfTrue;
+	}
+	if (normalized[root_length] != '\\')
+		return sfFalse;
+	strcpy_s(relative_path, MAX_PATH_SIZE, normalized + root_length + 1);
+	return sfTrue;
+}
+
+static sfBool GetLooseFileAttributes(const char* path, unsigned long long* size, unsigned long long* mtime)
+{
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data))
+		return sfFalse;
+	*size = ((unsigned long long)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+	*mtime = ((unsigned long long)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+	return sfTrue;
+}
+
+// The pack is written after reading every file, a loose file written after it or of another size was edited since.
+// Its entry is then skipped, the edited loose file is loaded until the pack is built again.
+static void FindStaleEntries(const char* pack_path)
+{
+	unsigned long long pack_size, pack_mtime;
+	if (!GetLooseFileAttributes(pack_path, &pack_size, &pack_mtime))
+		return;
+	pack_stale_entries = calloc_d(sfBool, pack_entry_count ? pack_entry_count : 1);
+	assert(pack_stale_entries);
+	NEW_CHAR(loose_path, MAX_PATH_SIZE)
+		for (unsigned int i = 0; i < pack_entry_count; i++)
+		{
+			unsigned long long size, mtime;
+			sprintf_s(loose_path, MAX_PATH_SIZE, "%s\\%s", pack_root, pack_entries[i].m_path);
+			if (GetLooseFileAttributes(loose_path, &size, &mtime) && (size != pack_entries[i].m_size || mtime > pack_mtime))
+			{
+				pack_stale_entries[i] = sfTrue;
+				printf_d("%s changed since the pack was built, the loose file is loaded instead\n", loose_path);
+			}
+		}
+}
+
+static void SetRoot(char* root, const char* resource_directory_)
+{
+	strcpy_s(root, MAX_PATH_SIZE, resource_directory_);
+	NormalizePackPath(root);
+	size_t length = strlen(root);
+	if (length && root[length - 1] == '\\')
+		root[length - 1] = '\0';
+}
+
+static int ComparePackEntries(const void* a, const void* b)
+{
+	return strcmp(((const PackEntry*)a)->m_path, ((const PackEntry*)b)->m_path);
+}
+
+static sfBool WritePadding(FILE* file, unsigned long long* offset)
+{
+	static const char zeros[PACK_ALIGNMENT] = { 0 };
+	size_t padding = (size_t)((PACK_ALIGNMENT - *offset % PACK_ALIGNMENT) % PACK_ALIGNMENT);
+	*offset += padding;
+	return fwrite(zeros, 1, padding, file) == padding;
+}
+
+sfBool BuildPackFile(const char* resource_directory_, const char* pack_path)
+{
+	NEW_CHAR(root, MAX_PATH_SIZE)
+		SetRoot(root, resource_directory_);
+
+	Path root_path = fs_create_path(resource_directory_);
+	stdList* files = fs_recursive_iterator_directory(&root_path);
+	PackEntry* entries = calloc_d(PackEntry, files->size(files) ? files->size(files) : 1);
+	assert(entries);
+	unsigned int entry_count = 0;
+
+	for (int i = 0; i < files->size(files); i++)
+	{
+		const Path* file = STD_GETDATA(files, Path, i);
+		NEW_CHAR(relative_path, MAX_PATH_SIZE)
+			if (!GetRelativePath(root, file->path_data.m_path, relative_path) || strcmp(relative_path, RESOURCE_MANIFEST_NAME) == 0)
+				continue;
+		if (strlen(relative_path) >= PACK_PATH_SIZE)
+		{
+			printf_d("%s is too long to be packed, it stays a loose file\n", relative_path);
+			continue;
+		}
+		strcpy_s(entries[entry_count].m_path, PACK_PATH_SIZE, relative_path);
+		entries[entry_count].m_size = (unsigned long long)GetFileSizeCustom(file->path_data.m_path);
+		entry_count++;
+	}
+	qsort(entries, entry_count, sizeof(PackEntry), &ComparePackEntries);
+
+	FILE* pack = NULL;
+	if (fopen_s(&pack, pack_path, "wb") != 0 || !pack)
+	{
+		printf_d("Can't write the pack %s\n", pack_path);
+		files->destroy(&files);
+		free_d(entries);
+		return sfFalse;
+	}
+
+	PackHeader header = { .m_magic = PACK_MAGIC, .m_version = PACK_VERSION, .m_entry_count = entry_count };
+	unsigned long long offset = sizeof(PackHeader) + (unsigned long long)entry_count * sizeof(PackEntry);
+	offset += (PACK_ALIGNMENT - offset % PACK_ALIGNMENT) % PACK_ALIGNMENT;
+	for (unsigned int i = 0; i < entry_count; i++)
+	{
+		entries[i].m_offset = offset;
+		offset += entries[i].m_size;
+		offset += (PACK_ALIGNMENT - offset % PACK_ALIGNMENT) % PACK_ALIGNMENT;
+	}
+
+	sfBool is_written = fwrite(&header, sizeof(PackHeader), 1, pack) == 1
+		&& fwrite(entries, sizeof(PackEntry), entry_count, pack) == entry_count;
+	offset = sizeof(PackHeader) + (unsigned long long)entry_count * sizeof(PackEntry);
+	is_written = is_written && WritePadding(pack, &offset);
+
+	char* buffer = NULL;
+	size_t buffer_size = 0;
+	for (unsigned int i = 0; i < entry_count && is_written; i++)
+	{
+		NEW_CHAR(file_path, MAX_PATH_SIZE)
+			strcpy_s(file_path, MAX_PATH_SIZE, root);
+		strcat_s(file_path, MAX_PATH_SIZE, "\\");
+		strcat_s(file_path, MAX_PATH_SIZE, entries[i].m_path);
+
+		if (entries[i].m_size > buffer_size)
+		{
+			free_d(buffer);
+			buffer_size = (size_t)entries[i].m_size;
+			buffer = calloc_d(char, buffer_size);
+			assert(buffer);
+		}
+		FILE* file = NULL;
+		if (fopen_s(&file, file_path, "rb") != 0 || !file)
+		{
+			printf_d("Can't read %s\n", file_path);
+			is_written = sfFalse;
+			break;
+		}
+		is_written = fread(buffer, 1, (size_t)entries[i].m_size, file) == entries[i].m_size
+			&& fwrite(buffer, 1, (size_t)entries[i].m_size, pack) == entries[i].m_size;
+		fclose(file);
+		offset += entries[i].m_size;
+		is_written = is_written && WritePadding(pack, &offset);
+	}
+	fclose(pack);
+
+	printf_d("Pack %s %s, %u files, %llu bytes\n", pack_path, is_written ? "written" : "failed", entry_count, offset);
+	if (buffer)
+		free_d(buffer);
+	free_d(entries);
+	files->destroy(&files);
+	if (!is_written)
+		remove(pack_path);
+	return is_written;
+}
+
+sfBool MountPackFile(const char* pack_path, const char* resource_directory_)
+{
+	UnmountPackFile();
+
+	if (!fs_map_file(pack_path, &pack_mapping))
+		return sfFalse;
+
+	const PackHeader* header = pack_mapping.m_data;
+	if (pack_mapping.m_size < sizeof(PackHeader) || memcmp(header->m_magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header->m_version != PACK_VERSION
+		|| sizeof(PackHeader) + (unsigned long long)header->m_entry_count * sizeof(PackEntry) > pack_mapping.m_size)
+	{
+		printf_d("%s is not a valid pack\n", pack_path);
+		UnmountPackFile();
+		return sfFalse;
+	}
+	pack_entries = (const PackEntry*)((const char*)pack_mapping.m_data + sizeof(PackHeader));
+	pack_entry_count = header->m_entry_count;
+	SetRoot(pack_root, resource_directory_);
+	FindStaleEntries(pack_path);
+	printf_d("Pack %s mounted, %u files\n\n", pack_path, pack_entry_count);
+	return sfTrue;
+}
+
+void UnmountPackFile(void)
+{
+	fs_unmap_file(&pack_mapping);
+	pack_entries = NULL;
+	pack_entry_count = 0;
+	if (pack_stale_entries)
+		free_d(pack_stale_entries);
+	pack_stale_entries = NULL;
+}
+
+const void* GetPackedFile(const char* path, size_t* size)
+{
+	if (!pack_entries)
+		return NULL;
+
+	PackEntry key;
+	NEW_CHAR(relative_path, MAX_PATH_SIZE)
+		if (!GetRelativePath(pack_root, path, relative_path) || strlen(relative_path) >= PACK_PATH_SIZE)
+			return NULL;
+	strcpy_s(key.m_path, PACK_PATH_SIZE, relative_path);
+
+	const PackEntry* entry = bsearch(&key, pack_entries, pack_entry_count, sizeof(PackEntry), &ComparePackEntries);
+	if (!entry || entry->m_offset + entry->m_size > pack_mapping.m_size || (pack_stale_entries && pack_stale_entries[entry - pack_entries]))
+		return NULL;
+	*size = (size_t)entry->m_size;
+	return (const char*)pack_mapping.m_data + entry->m_offset;
+}
+
+const void* MapResourceFile(const char* path, size_t* size, fs_mapped_file* mapped_file)
+{
+	mapped_file->m_data = NULL;
+	mapped_file->m_size = 0;
+	const void* packed_data = GetPackedFile(path, size);
+	if (packed_data)
+		return packed_data;
+	if (!fs_map_file(path, mapped_file))
+		return NULL;
+	*size = mapped_file->m_size;
+	return mapped_file->m_data;
+}
+
+const void* ReadResourceFile(const char* path, size_t* size, void** owned_data)
+{
+	*owned_data = NULL;
+	fs_mapped_file mapped_file;
+	const void* data = MapResourceFile(path, size, &mapped_file);
+	if (!data || !mapped_file.m_data)
+		return data;
+	*owned_data = calloc_d(char, *size);
+	assert(*owned_data);
+	memcpy(*owned_data, data, *size);
+	fs_unmap_file(&mapped_file);
+	return *owned_data;
+}
+
+// Index of the first entry whose path starts with prefix, the matching entries are contiguous since the index is sorted.
+static unsigned int FindFirstEntryWithPrefix(const char* prefix, size_t prefix_length)
+{
+	unsigned int low = 0, high = pack_entry_count;
+	while (low < high)
+	{
+		unsigned int middle = low + (high - low) / 2;
+		if (strncmp(pack_entries[middle].m_path, prefix, prefix_length) < 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+stdList* SearchPackFilesInfos(const char* path, const char* extension)
+{
+	if (!pack_entries)
+		return NULL;
+
+	NEW_CHAR(prefix, MAX_PATH_SIZE)
+		if (!GetRelativePath(pack_root, path, prefix))
+			return NULL;
+	size_t prefix_length = strlen(prefix);
+	if (prefix_length && prefix[prefix_length - 1] != '\\')
+		strcat_s(prefix, MAX_PATH_SIZE, "\\");
+	prefix_length = strlen(prefix);
+
+	NEW_CHAR(lower_extension, MAX_PATH_SIZE)
+		strcpy_s(lower_extension, MAX_PATH_SIZE, extension);
+	NormalizePackPath(lower_extension);
+
+	stdList* files_list = STD_LIST_CREATE(FilesInfo, 0);
+	for (unsigned int i = FindFirstEntryWithPrefix(prefix, prefix_length); i < pack_entry_count; i++)
+	{
+		const PackEntry* entry = &pack_entries[i];
+		if (strncmp(entry->m_path, prefix, prefix_length) != 0)
+			break;
+		const char* file_extension = strrchr(entry->m_path, '.');
+		// SearchFilesInfos lists the loose file instead.
+		if ((pack_stale_entries && pack_stale_entries[i]) || !file_extension || strrchr(entry->m_path, '\\') > file_extension || strcmp(file_extension + 1, lower_extension) != 0)
+			continue;
+
+		FilesInfo files_info;
+		strcpy_s(files_info.m_path, MAX_PATH_SIZE, pack_root);
+		strcat_s(files_info.m_path, MAX_PATH_SIZE, "\\");
+		strcat_s(files_info.m_path, MAX_PATH_SIZE, entry->m_path);
+		fs_stem(entry->m_path, files_info.m_name, MAX_PATH_SIZE);
+		files_info.m_size = entry->m_size;
+		files_list->push_back(files_list, &files_info);
+	}
+	return files_list;
+}
+
+sfBool IsPackedDirectory(const char* path)
+{
+	if (!pack_entries)
+		return sfFalse;
+
+	NEW_CHAR(prefix, MAX_PATH_SIZE)
+		if (!GetRelativePath(pack_root, path, prefix))
+			return sfFalse;
+	if (prefix[0])
+		strcat_s(prefix, MAX_PATH_SIZE, "\\");
+	size_t prefix_length = strlen(prefix);
+	unsigned int index = FindFirstEntryWithPrefix(prefix, prefix_length);
+	return index < pack_entry_count && strncmp(pack_entries[index].m_path, prefix, prefix_length) == 0;
+}
@@ -0,0 +1,162 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "Tools.h"
+
+/**
+ * @file packfile.h
+ * @brief This file defines the pack file, a single archive holding every asset of the resources directory.
+ *
+ * A pack starts with a PackHeader, followed by the PackEntry index sorted by path, then by every file blob aligned on PACK_ALIGNMENT bytes.
+ * The pack is memory-mapped when mounted: looking a file up is a binary search in the index and returns a pointer into the mapping,
+ * which the managers give to the CSFML *_createFromMemory functions instead of opening the loose file.
+ *
+ * @code
+ * // Building the pack, done by the --build-pack command line option:
+ * BuildPackFile("../Ressources", "../Ressources.pak");
+ *
+ * // Mounting it, done by InitResourcesManager when the pack exists:
+ * MountPackFile("../Ressources.pak", "../Ressources");
+ * size_t size;
+ * const void* data = GetPackedFile("../Ressources/ALL/Textures/placeholder.png", &size);
+ * @endcode
+ */
+
+/**
+ * @def PACK_FILE_EXTENSION
+ * @brief Extension appended to the resources directory to find its pack.
+ */
+#define PACK_FILE_EXTENSION ".pak"
+
+/**
+ * @def PACK_MAGIC
+ * @brief Magic number at the start of every pack.
+ */
+#define PACK_MAGIC "PXHPACK"
+
+/**
+ * @def PACK_VERSION
+ * @brief Version of the pack format. A pack with another version is not mounted.
+ */
+#define PACK_VERSION 1
+
+/**
+ * @def PACK_ALIGNMENT
+ * @brief Alignment in bytes of every blob in the pack.
+ */
+#define PACK_ALIGNMENT 64
+
+/**
+ * @def PACK_PATH_SIZE
+ * @brief Size of the path stored in each index entry, making an entry 256 bytes long.
+ */
+#define PACK_PATH_SIZE 240
+
+/**
+ * @struct PackHeader
+ * @brief Header at the start of a pack.
+ */
+typedef struct PackHeader PackHeader;
+struct PackHeader
+{
+	char m_magic[8]; /**< PACK_MAGIC, null terminated. */
+	unsigned int m_version; /**< PACK_VERSION. */
+	unsigned int m_entry_count; /**< Number of entries in the index following the header. */
+};
+
+/**
+ * @struct PackEntry
+ * @brief Index entry of a file in a pack.
+ */
+typedef struct PackEntry PackEntry;
+struct PackEntry
+{
+	char m_path[PACK_PATH_SIZE]; /**< Path relative to the resources directory, lowercase, with backslashes. */
+	unsigned long long m_offset; /**< Offset of the blob from the start of the pack. */
+	unsigned long long m_size; /**< Size of the blob in bytes. */
+};
+
+/**
+ * @brief Packs every file of a resources directory into a single archive.
+ * @param resource_directory_ Path to the resources directory, e.g. ../Ressources.
+ * @param pack_path Path of the pack to write.
+ * @return sfTrue if the pack was written, sfFalse otherwise.
+ */
+sfBool BuildPackFile(const char* resource_directory_, const char* pack_path);
+
+/**
+ * @brief Memory-maps a pack and uses it for every file of a resources directory.
+ * A loose file of another size than its entry, or written after the pack, was edited since the pack was built: it is loaded instead of its entry.
+ * @param pack_path Path of the pack to mount.
+ * @param resource_directory_ Path of the resources directory the pack was built from.
+ * @return sfTrue if the pack is mounted, sfFalse if it is missing or invalid.
+ */
+sfBool MountPackFile(const char* pack_path, const char* resource_directory_);
+
+/**
+ * @brief Unmaps the mounted pack. Every pointer returned by GetPackedFile becomes invalid.
+ */
+void UnmountPackFile(void);
+
+/**
+ * @brief Looks a file up in the mounted pack.
+ * @param path Path of the file, as it would be opened from the resources directory.
+ * @param size Set to the size of the file in bytes.
+ * @return A read-only pointer to the file content, valid until UnmountPackFile, or NULL if the file is not packed or its loose file was edited since.
+ */
+const void* GetPackedFile(const char* path, size_t* size);
+
+/**
+ * @brief Gives a read-only view of a resource file for the loaders to decode it without a copy.
+ * The file is taken from the mounted pack if it is packed, otherwise the loose file is memory-mapped in mapped_file.
+ * @param path Path of the file, as it would be opened from the resources directory.
+ * @param size Set to the size of the file in bytes.
+ * @param mapped_file Receives the mapping of a loose file, to give to fs_unmap_file once the data is not used anymore. Left empty for a packed file.
+ * @return A read-only pointer to the file content, or NULL if the file can't be read.
+ */
+const void* MapResourceFile(const char* path, size_t* size, fs_mapped_file* mapped_file);
+
+/**
+ * @brief Reads a resource file for the loaders that keep reading it after decoding, like fonts and musics.
+ * A packed file is read in place from the mounted pack. A loose file is copied then unmapped at once, so it stays free to be overwritten and hot reloaded.
+ * @param path Path of the file, as it would be opened from the resources directory.
+ * @param size Set to the size of the file in bytes.
+ * @param owned_data Receives the copy of a loose file, to give to free_d once the data is not used anymore. Set to NULL for a packed file.
+ * @return A read-only pointer to the file content, or NULL if the file can't be read.
+ */
+const void* ReadResourceFile(const char* path, size_t* size, void** owned_data);
+
+/**
+ * @brief Lists the files of a directory from the mounted pack, like SearchFilesInfos does from the filesystem.
+ * @param path Directory to search in, recursively.
+ * @param extension Extension of the files to list, without the dot.
+ * @return A new list of FilesInfo, or NULL if no pack is mounted or if path is outside of its resources directory.
+ */
+stdList* SearchPackFilesInfos(const char* path, const char* extension);
+
+/**
+ * @brief Checks if the mounted pack holds at least one file inside a directory.
+ * @param path Directory to check.
+ * @return sfTrue if the pack has files in that directory, sfFalse otherwise or if no pack is mounted.
+ */
+sfBool IsPackedDirectory(const char* path);
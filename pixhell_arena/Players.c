@@ -29,6 +29,7 @@ void InitPlayers(void)
 		sfRectangleShape_setOrigin(player_shape[i], sfVector2f_Create(25.f, 25.f));
 
 		players[i].position = sfVector2f_Create(935.f + i * 50.f, 540.f);
+		players[i].previous_position = players[i].position;
 		sfRectangleShape_setPosition(player_shape[i], players[i].position);
 
 		direction_circle[i] = sfCircleShape_create();
@@ -51,6 +52,7 @@ void UpdatePlayers(void)
 
 	for (int i = 0; i < PLAYER_NUMBER; i++)
 	{
+		players[i].previous_position = players[i].position;
 		if (players[i].is_dodging)
 		{
 			players[i].dodge_timer += DeltaTime;
@@ -61,8 +63,7 @@ void UpdatePlayers(void)
 			}
 			else
 			{
-				players[i].position = AddVector2f(players[i].position, MultiplyVector2f(players[i].direction, 0.65f));
-				sfRectangleShape_setPosition(player_shape[i], players[i].position);
+				players[i].position = AddVector2f(players[i].position, MultiplyVector2f(players[i].direction, PLAYER_DODGE_SPEED * DeltaTime));
 			}
 		}
 		else
@@ -76,17 +77,16 @@ void UpdatePlayers(void)
 			right_joystick.y = -right_joystick.y;
 			
 			players[i].direction = NormalizeVector2f(left_joystick);
-			players[i].position = AddVector2f(players[i].position, MultiplyVector2f(players[i].direction, 0.25f));
-			sfRectangleShape_setPosition(player_shape[i], players[i].position);
+			players[i].position = AddVector2f(players[i].position, MultiplyVector2f(players[i].direction, PLAYER_SPEED * DeltaTime));
 
 			if (right_joystick.x != 0.f || right_joystick.y != 0.f)
 			{
 				float angle = atan2f(right_joystick.y, right_joystick.x);
-				sfCircleShape_setPosition(direction_circle[i], sfVector2f_Create(players[i].position.x + cosf(angle) * 57.5f, players[i].position.y + sinf(angle) * 57.5f));
+				players[i].aim_offset = sfVector2f_Create(cosf(angle) * 57.5f, sinf(angle) * 57.5f);
 			}
 			else
 			{
-				sfCircleShape_setPosition(direction_circle[i], players[i].position);
+				players[i].aim_offset = sfVector2f_Create(0.f, 0.f);
 			}
 
 			players[i].shoot_timer += DeltaTime;
@@ -123,8 +123,32 @@ void UpdatePlayers(void)
 	players_ui_manager->update(players_ui_manager, NULL);
 }
 
+void CapturePlayers(PlayerSnapshot* snapshot)
+{
+	for (int i = 0; i < PLAYER_NUMBER; i++)
+	{
+		snapshot[i].previous_position = players[i].previous_position;
+		snapshot[i].position = players[i].position;
+		snapshot[i].aim_offset = players[i].aim_offset;
+	}
+}
+
 void DisplayPlayers(WindowManager* window)
 {
+	PlayerSnapshot snapshot[PLAYER_NUMBER];
+	CapturePlayers(snapshot);
+	DisplayPlayersSnapshot(window, snapshot);
+}
+
+void DisplayPlayersSnapshot(WindowManager* window, const PlayerSnapshot* snapshot)
+{
+	for (int i = 0; i < PLAYER_NUMBER; i++)
+	{
+		sfVector2f render_position = AddVector2f(snapshot[i].previous_position, MultiplyVector2f(SubVector2f(snapshot[i].position, snapshot[i].previous_position), RenderAlpha));
+		sfRectangleShape_setPosition(player_shape[i], render_position);
+		sfCircleShape_setPosition(direction_circle[i], AddVector2f(render_position, snapshot[i].aim_offset));
+	}
+
 	window->DrawCircleShape(window, direction_circle[0], NULL);
 	window->DrawCircleShape(window, direction_circle[1], NULL);
 	window->DrawRectangleShape(window, player_shape[0], NULL);
@@ -132,6 +156,13 @@ void DisplayPlayers(WindowManager* window)
 }
 
 void DisplayUIPlayers(WindowManager* window)
+{
+	PlayerSnapshot snapshot[PLAYER_NUMBER];
+	CapturePlayers(snapshot);
+	DisplayUIPlayersSnapshot(window, snapshot);
+}
+
+void DisplayUIPlayersSnapshot(WindowManager* window, const PlayerSnapshot* snapshot)
 {
 
 }
@@ -3,6 +3,8 @@
 #include "Animation.h"
 
 #define PLAYER_NUMBER 2
+#define PLAYER_SPEED 250.f
+#define PLAYER_DODGE_SPEED 650.f
 
 // #######################################
 // #
@@ -19,7 +21,9 @@
 typedef struct PlayerInfo
 {
 	sfVector2f position;
+	sfVector2f previous_position;
 	sfVector2f direction;
+	sfVector2f aim_offset;
 	Animation_Key* anim_key;
 	float shoot_timer;
 	float attack_timer;
@@ -30,10 +34,20 @@ typedef struct PlayerInfo
 	sfBool is_dodging;
 }PlayerInfo;
 
+typedef struct PlayerSnapshot
+{
+	sfVector2f previous_position;
+	sfVector2f position;
+	sfVector2f aim_offset;
+}PlayerSnapshot;
+
 PlayerInfo players[PLAYER_NUMBER];
 
 void InitPlayers(void);
 void UpdatePlayers(void);
 void DisplayPlayers(WindowManager* window);
+void CapturePlayers(PlayerSnapshot* snapshot);
+void DisplayPlayersSnapshot(WindowManager* window, const PlayerSnapshot* snapshot);
 void DisplayUIPlayers(WindowManager* window);
+void DisplayUIPlayersSnapshot(WindowManager* window, const PlayerSnapshot* snapshot);
 void DestroyPlayers(void);
@@ -0,0 +1,210 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "Profiler.h"
+#include "MemoryManagement.h"
+#include <windows.h>
+
+#ifdef PROFILER_ENABLED
+
+#define PROFILER_MAX_THREADS 64
+#define PROFILER_RING_SIZE 16384 /**< Events kept per thread, must be a power of two. */
+#define PROFILER_THREAD_NAME_SIZE 64
+
+typedef struct ProfilerEvent ProfilerEvent;
+struct ProfilerEvent
+{
+	const char* m_name; /**< NULL for an end event. */
+	LONG64 m_time;
+};
+
+typedef struct ProfilerThreadBuffer ProfilerThreadBuffer;
+struct ProfilerThreadBuffer
+{
+	DWORD m_thread_id;
+	char m_thread_name[PROFILER_THREAD_NAME_SIZE];
+	volatile LONG m_is_free;        /**< Set by __ProfilerReleaseThread, the next new thread takes the buffer over. */
+	volatile LONG64 m_write_index;  /**< Published with an interlocked exchange once the event is written. */
+	ProfilerEvent m_events[PROFILER_RING_SIZE];
+};
+
+static ProfilerThreadBuffer* profiler_buffers[PROFILER_MAX_THREADS];
+static volatile LONG profiler_buffer_count = 0;
+static volatile LONG64 profiler_start_time = 0;
+static __declspec(thread) ProfilerThreadBuffer* tls_profiler_buffer = NULL;
+static __declspec(thread) sfBool tls_profiler_is_full = sfFalse;
+
+
+
+static LONG64 GetProfilerTime(void)
+{
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	InterlockedCompareExchange64(&profiler_start_time, time.QuadPart, 0);
+	return time.QuadPart;
+}
+
+static ProfilerThreadBuffer* GetPublishedBuffer(LONG slot)
+{
+	return InterlockedCompareExchangePointer((void* volatile*)&profiler_buffers[slot], NULL, NULL);
+}
+
+// The buffer of an exited thread is reused before a new slot is taken.
+// Its previous events are dropped, the dump would write them with the id and the name of the new thread.
+static ProfilerThreadBuffer* TakeFreeBuffer(void)
+{
+	LONG buffer_count = InterlockedCompareExchange(&profiler_buffer_count, 0, 0);
+	for (LONG i = 0; i < buffer_count && i < PROFILER_MAX_THREADS; i++)
+	{
+		ProfilerThreadBuffer* buffer = GetPublishedBuffer(i);
+		if (buffer && InterlockedCompareExchange(&buffer->m_is_free, 0, 1) == 1)
+		{
+			InterlockedExchange64(&buffer->m_write_index, 0);
+			return buffer;
+		}
+	}
+	return NULL;
+}
+
+static ProfilerThreadBuffer* GetThreadBuffer(void)
+{
+	if (tls_profiler_buffer || tls_profiler_is_full)
+		return tls_profiler_buffer;
+
+	ProfilerThreadBuffer* buffer = TakeFreeBuffer();
+	if (!buffer)
+	{
+		LONG slot = InterlockedIncrement(&profiler_buffer_count) - 1;
+		if (slot >= PROFILER_MAX_THREADS)
+		{
+			InterlockedDecrement(&profiler_buffer_count);
+			tls_profiler_is_full = sfTrue;
+			return NULL;
+		}
+		buffer = calloc_d(ProfilerThreadBuffer, 1);
+		assert(buffer);
+		InterlockedExchangePointer((void* volatile*)&profiler_buffers[slot], buffer);
+	}
+	buffer->m_thread_id = GetCurrentThreadId();
+	sprintf_s(buffer->m_thread_name, PROFILER_THREAD_NAME_SIZE, "Thread %lu", (unsigned long)buffer->m_thread_id);
+	tls_profiler_buffer = buffer;
+	return buffer;
+}
+
+static void PushEvent(const char* name)
+{
+	ProfilerThreadBuffer* buffer = GetThreadBuffer();
+	if (!buffer)
+		return;
+	LONG64 index = buffer->m_write_index;
+	ProfilerEvent* event = &buffer->m_events[index & (PROFILER_RING_SIZE - 1)];
+	event->m_name = name;
+	event->m_time = GetProfilerTime();
+	InterlockedExchange64(&buffer->m_write_index, index + 1);
+}
+
+void __ProfilerBegin(const char* name)
+{
+	PushEvent(name);
+}
+
+void __ProfilerEnd(void)
+{
+	PushEvent(NULL);
+}
+
+void __ProfilerSetThreadName(const char* name)
+{
+	ProfilerThreadBuffer* buffer = GetThreadBuffer();
+	if (buffer)
+		strcpy_s(buffer->m_thread_name, PROFILER_THREAD_NAME_SIZE, name);
+}
+
+void __ProfilerReleaseThread(void)
+{
+	if (tls_profiler_buffer)
+		InterlockedExchange(&tls_profiler_buffer->m_is_free, 1);
+	tls_profiler_buffer = NULL;
+	tls_profiler_is_full = sfFalse;
+}
+
+int __ProfilerDump(const char* path)
+{
+	FILE* file = NULL;
+	if (fopen_s(&file, path, "w") != 0 || !file)
+	{
+		printf_d("Can't write profiler dump %s\n", path);
+		return 0;
+	}
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	double to_microseconds = 1000000.0 / (double)frequency.QuadPart;
+	DWORD process_id = GetCurrentProcessId();
+	LONG buffer_count = InterlockedCompareExchange(&profiler_buffer_count, 0, 0);
+	sfBool is_first = sfTrue;
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (LONG i = 0; i < buffer_count && i < PROFILER_MAX_THREADS; i++)
+	{
+		ProfilerThreadBuffer* buffer = GetPublishedBuffer(i);
+		if (!buffer)
+			continue;
+
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%lu,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+			is_first ? "" : ",\n", (unsigned long)process_id, (unsigned long)buffer->m_thread_id, buffer->m_thread_name);
+		is_first = sfFalse;
+
+		LONG64 end = InterlockedCompareExchange64(&buffer->m_write_index, 0, 0);
+		LONG64 start = end > PROFILER_RING_SIZE ? end - PROFILER_RING_SIZE : 0;
+		for (LONG64 it = start; it < end; it++)
+		{
+			ProfilerEvent event = buffer->m_events[it & (PROFILER_RING_SIZE - 1)];
+			// The thread keeps recording during the dump, an event it wrapped around while it was copied is skipped.
+			if (InterlockedCompareExchange64(&buffer->m_write_index, 0, 0) - PROFILER_RING_SIZE > it)
+				continue;
+			double time = (double)(event.m_time - profiler_start_time) * to_microseconds;
+			if (event.m_name)
+				fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":%lu,\"tid\":%lu}", event.m_name, time, (unsigned long)process_id, (unsigned long)buffer->m_thread_id);
+			else
+				fprintf(file, ",\n{\"ph\":\"E\",\"ts\":%.3f,\"pid\":%lu,\"tid\":%lu}", time, (unsigned long)process_id, (unsigned long)buffer->m_thread_id);
+		}
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	printf_d("Profiler dump written to %s\n", path);
+	return 1;
+}
+
+void __ProfilerShutdown(void)
+{
+	LONG buffer_count = InterlockedExchange(&profiler_buffer_count, 0);
+	for (LONG i = 0; i < buffer_count && i < PROFILER_MAX_THREADS; i++)
+	{
+		ProfilerThreadBuffer* buffer = InterlockedExchangePointer((void* volatile*)&profiler_buffers[i], NULL);
+		if (buffer)
+			free_d(buffer);
+	}
+	tls_profiler_buffer = NULL;
+}
+
+#endif
@@ -0,0 +1,140 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <stdio.h>
+
+/**
+ * @file profiler.h
+ * @brief This file defines a low-overhead, thread-aware zone profiler exporting Chrome trace_event JSON.
+ *
+ * Every thread records its begin/end events in its own ring buffer, without any lock: the recording thread is the only writer of its buffer.
+ * A thread that exits releases its buffer with PROFILE_THREAD_EXIT, so the short-lived threads do not use up the PROFILER_MAX_THREADS buffers.
+ * The dump reads every buffer and writes a file that can be opened in chrome://tracing or https://ui.perfetto.dev.
+ * The whole profiler is compiled out when PROFILER_ENABLED is not defined, which is the case of the release builds.
+ *
+ * @code
+ * // Example usage:
+ * PROFILE_ZONE("Render", Current_state.Render(window););
+ *
+ * PROFILE_BEGIN("LoadFile");
+ * LoadMyFile(path);
+ * PROFILE_END();
+ *
+ * PROFILE_DUMP("profile.json");
+ * @endcode
+ */
+
+#ifdef _DEBUG
+#define PROFILER_ENABLED
+#endif
+
+#ifdef PROFILER_ENABLED
+
+/**
+ * @def PROFILE_BEGIN(name)
+ * @brief Opens a zone on the calling thread. name must be a string literal or a string living until the dump.
+ */
+#define PROFILE_BEGIN(name) __ProfilerBegin(name)
+
+/**
+ * @def PROFILE_END()
+ * @brief Closes the last zone opened on the calling thread.
+ */
+#define PROFILE_END() __ProfilerEnd()
+
+/**
+ * @def PROFILE_ZONE(name, ...)
+ * @brief Runs the given code inside a zone. The code must not return or jump out of the zone.
+ */
+#define PROFILE_ZONE(name, ...) { __ProfilerBegin(name); __VA_ARGS__ __ProfilerEnd(); }
+
+/**
+ * @def PROFILE_THREAD_NAME(name)
+ * @brief Names the calling thread in the trace.
+ */
+#define PROFILE_THREAD_NAME(name) __ProfilerSetThreadName(name)
+
+/**
+ * @def PROFILE_THREAD_EXIT()
+ * @brief Releases the buffer of the calling thread for the next new thread. Must be the last profiler call of a thread that exits.
+ * The events of the thread are in the dumps written until a new thread takes its buffer over.
+ */
+#define PROFILE_THREAD_EXIT() __ProfilerReleaseThread()
+
+/**
+ * @def PROFILE_DUMP(path)
+ * @brief Writes every recorded event to a Chrome trace_event JSON file.
+ */
+#define PROFILE_DUMP(path) __ProfilerDump(path)
+
+/**
+ * @def PROFILE_SHUTDOWN()
+ * @brief Releases the buffers of every thread. No zone must be recorded afterward.
+ */
+#define PROFILE_SHUTDOWN() __ProfilerShutdown()
+
+#else
+
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END() ((void)0)
+#define PROFILE_ZONE(name, ...) { __VA_ARGS__ }
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#define PROFILE_THREAD_EXIT() ((void)0)
+#define PROFILE_DUMP(path) ((void)0)
+#define PROFILE_SHUTDOWN() ((void)0)
+
+#endif
+
+/**
+ * @brief Records the beginning of a zone, see PROFILE_BEGIN.
+ * @param name Name of the zone.
+ */
+void __ProfilerBegin(const char* name);
+
+/**
+ * @brief Records the end of the last zone, see PROFILE_END.
+ */
+void __ProfilerEnd(void);
+
+/**
+ * @brief Names the calling thread, see PROFILE_THREAD_NAME.
+ * @param name Name of the thread, copied.
+ */
+void __ProfilerSetThreadName(const char* name);
+
+/**
+ * @brief Releases the buffer of the calling thread, see PROFILE_THREAD_EXIT.
+ */
+void __ProfilerReleaseThread(void);
+
+/**
+ * @brief Writes the recorded events, see PROFILE_DUMP.
+ * @param path Path of the JSON file to write.
+ * @return 1 if the file has been written, 0 otherwise.
+ */
+int __ProfilerDump(const char* path);
+
+/**
+ * @brief Releases the buffers of every thread, see PROFILE_SHUTDOWN.
+ */
+void __ProfilerShutdown(void);
@@ -2,12 +2,14 @@
 #include "stdlib.h"
 
 stdList* all_projectiles;
+sfBool is_snapshot_full_reported;
 
 void CreateProjectile(sfVector2f position, sfVector2f direction, ProjectileType type, float speed, float damage)
 {
 	if (direction.x == 0 && direction.y == 0) return;
 	ProjectileInfo* projectile = (ProjectileInfo*)malloc(sizeof(ProjectileInfo));
 	projectile->position = position;
+	projectile->previous_position = position;
 	projectile->direction = direction;
 	projectile->type = type;
 	projectile->speed = speed;
@@ -26,6 +28,7 @@ void UpdateProjectiles(void)
 	for (int i = 0; i < all_projectiles->size(all_projectiles); i++)
 	{
 		projectile = all_projectiles->getData(all_projectiles, i);
+		projectile->previous_position = projectile->position;
 		projectile->position = AddVector2f(projectile->position, MultiplyVector2f(projectile->direction, projectile->speed * DeltaTime));
 
 		if (projectile->position.x < 0 || projectile->position.x > 1920 || projectile->position.y < 0 || projectile->position.y > 1080)
@@ -36,18 +39,56 @@ void UpdateProjectiles(void)
 	}
 }
 
-void DisplayProjectiles(WindowManager* window)
+static sfCircleShape* CreateProjectileShape(void)
 {
-	ProjectileInfo* projectile;
 	sfCircleShape* shape = sfCircleShape_create();
 	sfCircleShape_setRadius(shape, 5.f);
 	sfCircleShape_setFillColor(shape, (sfColor) { 255, 255, 0, 255 });
 	sfCircleShape_setOrigin(shape, sfVector2f_Create(5.f, 5.f));
+	return shape;
+}
+
+void CaptureProjectiles(ProjectilesSnapshot* snapshot)
+{
+	ProjectileInfo* projectile;
+	snapshot->count = 0;
+	for (int i = 0; i < all_projectiles->size(all_projectiles) && snapshot->count < MAX_SNAPSHOT_PROJECTILES; i++)
+	{
+		projectile = all_projectiles->getData(all_projectiles, i);
+		snapshot->previous_position[snapshot->count] = projectile->previous_position;
+		snapshot->position[snapshot->count] = projectile->position;
+		snapshot->count++;
+	}
+	// The projectiles over the limit are not drawn, reported once instead of every tick.
+	if (all_projectiles->size(all_projectiles) > MAX_SNAPSHOT_PROJECTILES && !is_snapshot_full_reported)
+	{
+		printf_d("%d projectiles, only the first %d are drawn, raise MAX_SNAPSHOT_PROJECTILES\n", all_projectiles->size(all_projectiles), MAX_SNAPSHOT_PROJECTILES);
+		is_snapshot_full_reported = sfTrue;
+	}
+}
+
+void DisplayProjectilesSnapshot(WindowManager* window, const ProjectilesSnapshot* snapshot)
+{
+	sfCircleShape* shape = CreateProjectileShape();
+
+	for (int i = 0; i < snapshot->count; i++)
+	{
+		sfCircleShape_setPosition(shape, AddVector2f(snapshot->previous_position[i], MultiplyVector2f(SubVector2f(snapshot->position[i], snapshot->previous_position[i]), RenderAlpha)));
+		window->DrawCircleShape(window, shape, NULL);
+	}
+
+	sfCircleShape_destroy(shape);
+}
+
+void DisplayProjectiles(WindowManager* window)
+{
+	ProjectileInfo* projectile;
+	sfCircleShape* shape = CreateProjectileShape();
 
 	for (int i = 0; i < all_projectiles->size(all_projectiles); i++)
 	{
 		projectile = all_projectiles->getData(all_projectiles, i);
-		sfCircleShape_setPosition(shape, projectile->position);
+		sfCircleShape_setPosition(shape, AddVector2f(projectile->previous_position, MultiplyVector2f(SubVector2f(projectile->position, projectile->previous_position), RenderAlpha)));
 		window->DrawCircleShape(window, shape, NULL);
 	}
 
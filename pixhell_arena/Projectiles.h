@@ -11,14 +11,26 @@ typedef enum
 typedef struct
 {
 	sfVector2f position;
+	sfVector2f previous_position;
 	sfVector2f direction;
 	ProjectileType type;
 	float speed;
 	float damage;
 }ProjectileInfo;
 
+#define MAX_SNAPSHOT_PROJECTILES 1024
+
+typedef struct
+{
+	int count;
+	sfVector2f previous_position[MAX_SNAPSHOT_PROJECTILES];
+	sfVector2f position[MAX_SNAPSHOT_PROJECTILES];
+}ProjectilesSnapshot;
+
 void CreateProjectile(sfVector2f position, sfVector2f direction, ProjectileType type, float speed, float damage);
 void InitProjectiles(void);
 void UpdateProjectiles(void);
 void DisplayProjectiles(WindowManager* window);
+void CaptureProjectiles(ProjectilesSnapshot* snapshot);
+void DisplayProjectilesSnapshot(WindowManager* window, const ProjectilesSnapshot* snapshot);
 void DestroyProjectiles(void);
\ No newline at end of file
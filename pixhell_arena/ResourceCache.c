@@ -0,0 +1,211 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "ResourceCache.h"
+#include "MemoryManagement.h"
+#include <windows.h>
+#include <assert.h>
+
+// Header of an element of the cache list, followed by the resource structure of the manager.
+typedef struct CachedResource CachedResource;
+struct CachedResource
+{
+	char m_name[MAX_PATH_SIZE];
+	char m_path[MAX_PATH_SIZE];
+	void* m_registered;
+	size_t m_size;
+};
+
+struct ResourceCache_Data
+{
+	SRWLOCK m_lock;
+	stdList* m_resources; // From the least to the most recently used.
+	size_t m_resource_size;
+	size_t m_size;
+	size_t m_budget;
+	ResourceRegistry* m_registry;
+	void (*m_destroy_resource)(void*);
+};
+
+
+
+static void* GetResource(CachedResource* cached)
+{
+	return cached + 1;
+}
+
+static sfBool IsReferenced(ResourceCache_Data* data, const CachedResource* cached)
+{
+	ResourceEntry* entry = data->m_registry->GetEntry(data->m_registry, data->m_registry->GetHandle(data->m_registry, cached->m_name, NULL));
+	return entry && entry->m_ref_count > 0;
+}
+
+// Must be called with the lock held.
+static void EvictAt(ResourceCache_Data* data, int index)
+{
+	CachedResource* cached = data->m_resources->getData(data->m_resources, index);
+	// The entry may still resolve to it if its last reference was released after the scene was cleared.
+	ResourceEntry* entry = data->m_registry->GetEntry(data->m_registry, data->m_registry->GetHandle(data->m_registry, cached->m_name, NULL));
+	if (entry)
+		InterlockedCompareExchangePointer(&entry->m_scene_resource, NULL, cached->m_registered);
+	printf_d("Resource %s evicted from the cache\n", cached->m_path);
+	data->m_size -= cached->m_size;
+	data->m_destroy_resource(GetResource(cached));
+	data->m_resources->erase(data->m_resources, index);
+}
+
+// Must be called with the lock held.
+static void EvictOverBudget(ResourceCache_Data* data)
+{
+	int index = 0;
+	while (data->m_size > data->m_budget && index < data->m_resources->size(data->m_resources))
+	{
+		if (IsReferenced(data, data->m_resources->getData(data->m_resources, index)))
+		{
+			index++;
+			continue;
+		}
+		EvictAt(data, index);
+	}
+}
+
+static void Store(ResourceCache* cache, const char* name, const char* path, const void* resource, void* registered, size_t size)
+{
+	ResourceCache_Data* data = cache->_Data;
+	CachedResource* cached = (CachedResource*)calloc_d(char, sizeof(CachedResource) + data->m_resource_size);
+	assert(cached);
+	strcpy_s(cached->m_name, MAX_PATH_SIZE, name);
+	strcpy_s(cached->m_path, MAX_PATH_SIZE, path);
+	cached->m_registered = registered;
+	cached->m_size = size;
+	memcpy(GetResource(cached), resource, data->m_resource_size);
+
+	AcquireSRWLockExclusive(&data->m_lock);
+	data->m_resources->push_back(data->m_resources, cached);
+	data->m_size += size;
+	EvictOverBudget(data);
+	ReleaseSRWLockExclusive(&data->m_lock);
+	free_d(cached);
+}
+
+static sfBool Take(ResourceCache* cache, const char* path, void* resource)
+{
+	ResourceCache_Data* data = cache->_Data;
+	sfBool is_found = sfFalse;
+	AcquireSRWLockExclusive(&data->m_lock);
+	for (int i = data->m_resources->size(data->m_resources) - 1; i >= 0 && !is_found; i--)
+	{
+		CachedResource* cached = data->m_resources->getData(data->m_resources, i);
+		if (!fs_path_equals(cached->m_path, path))
+			continue;
+		memcpy(resource, GetResource(cached), data->m_resource_size);
+		data->m_size -= cached->m_size;
+		data->m_resources->erase(data->m_resources, i);
+		is_found = sfTrue;
+	}
+	ReleaseSRWLockExclusive(&data->m_lock);
+	return is_found;
+}
+
+static sfBool Evict(ResourceCache* cache, const char* path)
+{
+	ResourceCache_Data* data = cache->_Data;
+	sfBool is_found = sfFalse;
+	AcquireSRWLockExclusive(&data->m_lock);
+	for (int i = data->m_resources->size(data->m_resources) - 1; i >= 0; i--)
+	{
+		CachedResource* cached = data->m_resources->getData(data->m_resources, i);
+		if (!fs_path_equals(cached->m_path, path))
+			continue;
+		// A referenced resource still resolves by handle, its users hold its pointer.
+		if (IsReferenced(data, cached))
+		{
+			printf_d("Resource %s is referenced, its cached copy is kept until it is released\n", cached->m_path);
+			continue;
+		}
+		EvictAt(data, i);
+		is_found = sfTrue;
+	}
+	ReleaseSRWLockExclusive(&data->m_lock);
+	return is_found;
+}
+
+static void Trim(ResourceCache* cache)
+{
+	AcquireSRWLockExclusive(&cache->_Data->m_lock);
+	EvictOverBudget(cache->_Data);
+	ReleaseSRWLockExclusive(&cache->_Data->m_lock);
+}
+
+static void SetBudget(ResourceCache* cache, size_t budget)
+{
+	AcquireSRWLockExclusive(&cache->_Data->m_lock);
+	cache->_Data->m_budget = budget;
+	EvictOverBudget(cache->_Data);
+	ReleaseSRWLockExclusive(&cache->_Data->m_lock);
+}
+
+static size_t GetSize(ResourceCache* cache)
+{
+	AcquireSRWLockShared(&cache->_Data->m_lock);
+	size_t size = cache->_Data->m_size;
+	ReleaseSRWLockShared(&cache->_Data->m_lock);
+	return size;
+}
+
+static void DestroyResourceCache(ResourceCache** cache)
+{
+	ResourceCache_Data* data = (*cache)->_Data;
+	for (int i = 0; i < data->m_resources->size(data->m_resources); i++)
+		data->m_destroy_resource(GetResource(data->m_resources->getData(data->m_resources, i)));
+	data->m_resources->destroy(&data->m_resources);
+	free_d(data);
+	free_d(*cache);
+	*cache = NULL;
+}
+
+ResourceCache* CreateResourceCache(size_t resource_size, ResourceRegistry* registry, void (*destroy_resource)(void*), size_t budget)
+{
+	ResourceCache* tmp = calloc_d(ResourceCache, 1);
+	ResourceCache_Data* tmp_data = calloc_d(ResourceCache_Data, 1);
+	assert(tmp);
+	assert(tmp_data);
+
+	InitializeSRWLock(&tmp_data->m_lock);
+	tmp_data->m_resources = stdList_Create(sizeof(CachedResource) + resource_size, 0);
+	tmp_data->m_resource_size = resource_size;
+	tmp_data->m_budget = budget;
+	tmp_data->m_registry = registry;
+	tmp_data->m_destroy_resource = destroy_resource;
+
+	tmp->_Data = tmp_data;
+
+	tmp->Store = &Store;
+	tmp->Take = &Take;
+	tmp->Evict = &Evict;
+	tmp->Trim = &Trim;
+	tmp->SetBudget = &SetBudget;
+	tmp->GetSize = &GetSize;
+	tmp->Destroy = &DestroyResourceCache;
+
+	return tmp;
+}
@@ -0,0 +1,128 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "ResourceRegistry.h"
+
+/**
+ * @file resourcecache.h
+ * @brief This file defines the ResourceCache structure, which keeps the resources of the previous scenes alive under a memory budget.
+ * Clearing a scene hands its resources to the cache of their manager instead of destroying them, and loading a scene takes them back
+ * without decoding their file again. The cache forgets its least recently used resources only when its size goes over its budget,
+ * so the assets shared by many scenes stay loaded while the memory stays bounded.
+ * A resource whose name is referenced in the registry of the manager, see AddReference, is never evicted and keeps resolving by handle.
+ * @code
+ * // Clearing a scene:
+ * cache->Store(cache, texture.m_name, texture.m_path.path_data.m_path, &texture, texture.m_texture, size);
+ * // Loading the next one:
+ * Texture texture;
+ * if (!cache->Take(cache, path, &texture))
+ *     texture = CreateTexture(path);
+ * @endcode
+ */
+
+/**
+ * @typedef ResourceCache_Data
+ * @brief Opaque structure that holds the internal data of the cache.
+ */
+typedef struct ResourceCache_Data ResourceCache_Data;
+
+/**
+ * @typedef ResourceCache
+ * @brief Keeps the unused resources of a manager until the budget is exceeded.
+ */
+typedef struct ResourceCache ResourceCache;
+
+/**
+ * @struct ResourceCache
+ * @brief Contains function pointers to store, take back and evict resources. Every function can be called from any thread.
+ */
+struct ResourceCache
+{
+    ResourceCache_Data* _Data; /**< Internal data of the cache. */
+
+    /**
+     * @brief Hands a resource over to the cache, as the most recently used one, then evicts resources until the cache fits in its budget.
+     * @param cache Pointer to the ResourceCache object.
+     * @param name Name of the resource in the registry of the manager.
+     * @param path Path the resource was created from, used to take it back.
+     * @param resource Resource structure of the manager, copied in the cache.
+     * @param registered Pointer resolved by the registry for this resource, cleared from the entry when the resource is evicted.
+     * @param size Memory used by the resource in bytes.
+     */
+    void (*Store)(ResourceCache* cache, const char* name, const char* path, const void* resource, void* registered, size_t size);
+
+    /**
+     * @brief Takes a resource back from the cache.
+     * @param cache Pointer to the ResourceCache object.
+     * @param path Path the resource was created from.
+     * @param resource Receives the resource structure if it was in the cache.
+     * @return sfTrue if the resource was in the cache, it is no longer owned by the cache then.
+     */
+    sfBool (*Take)(ResourceCache* cache, const char* path, void* resource);
+
+    /**
+     * @brief Destroys the unreferenced cached resource created from a path, e.g. when its file changed on disk.
+     * The registry entry stops resolving to it, so the next load decodes the file again instead of taking the stale resource back.
+     * A referenced resource is kept, its users still hold its pointer.
+     * @param cache Pointer to the ResourceCache object.
+     * @param path Path the resource was created from.
+     * @return sfTrue if a resource created from path was evicted.
+     */
+    sfBool (*Evict)(ResourceCache* cache, const char* path);
+
+    /**
+     * @brief Evicts the least recently used unreferenced resources until the cache fits in its budget.
+     * @param cache Pointer to the ResourceCache object.
+     */
+    void (*Trim)(ResourceCache* cache);
+
+    /**
+     * @brief Changes the budget of the cache, evicting resources if it shrinks.
+     * @param cache Pointer to the ResourceCache object.
+     * @param budget Maximum size of the cached resources in bytes. Referenced resources are kept even over the budget.
+     */
+    void (*SetBudget)(ResourceCache* cache, size_t budget);
+
+    /**
+     * @brief Retrieves the memory used by the cached resources.
+     * @param cache Pointer to the ResourceCache object.
+     * @return The size of the cached resources in bytes.
+     */
+    size_t (*GetSize)(ResourceCache* cache);
+
+    /**
+     * @brief Destroys every cached resource, referenced or not, and the cache.
+     * @param cache Pointer to the pointer of the ResourceCache object to destroy.
+     */
+    void (*Destroy)(ResourceCache** cache);
+};
+
+/**
+ * @brief Creates a ResourceCache object.
+ * @param resource_size Size of the resource structure of the manager.
+ * @param registry Registry of the manager, telling which resources are referenced.
+ * @param destroy_resource Function destroying a resource structure of the manager.
+ * @param budget Maximum size of the cached resources in bytes.
+ * @return A pointer to the newly created ResourceCache object.
+ */
+ResourceCache* CreateResourceCache(size_t resource_size, ResourceRegistry* registry, void (*destroy_resource)(void*), size_t budget);
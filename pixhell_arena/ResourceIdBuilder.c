@@ -0,0 +1,265 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "ResourceIdBuilder.h"
+#include "TextureManager.h"
+#include "AudioManager.h"
+#include "FontManager.h"
+#include "MovieManager.h"
+#include "MemoryManagement.h"
+#include <ctype.h>
+
+typedef struct ResourceIdType ResourceIdType;
+struct ResourceIdType
+{
+	const char* m_enum_name;
+	const char* m_value_prefix;
+	const char* m_table_prefix;
+	const char* m_directory;
+	const char* m_extension;
+	const char* const* m_names;
+};
+
+typedef struct ResourceIdEntry ResourceIdEntry;
+struct ResourceIdEntry
+{
+	char m_name[MAX_PATH_SIZE];
+	char m_path[MAX_PATH_SIZE];
+};
+
+static const ResourceIdType resource_id_types[] =
+{
+	{ "TextureId", "TEXTURE_ID_", "texture_id", TEXTURE_DIRECTORY, TEXTURE_EXTENSION, texture_id_names },
+	{ "SoundId", "SOUND_ID_", "sound_id", SOUND_DIRECTORY, SOUND_EXTENSION, sound_id_names },
+	{ "MusicId", "MUSIC_ID_", "music_id", MUSIC_DIRECTORY, MUSIC_EXTENSION, music_id_names },
+	{ "FontId", "FONT_ID_", "font_id", FONT_DIRECTORY, FONT_EXTENSION, font_id_names },
+	{ "MovieId", "MOVIE_ID_", "movie_id", MOVIE_DIRECTORY, MOVIE_EXTENSION, movie_id_names },
+};
+
+#define RESOURCE_ID_TYPE_COUNT (sizeof(resource_id_types) / sizeof(resource_id_types[0]))
+
+
+static int CompareResourceIdEntries(const void* left, const void* right)
+{
+	const ResourceIdEntry* left_entry = left;
+	const ResourceIdEntry* right_entry = right;
+	int result = strcmp(left_entry->m_name, right_entry->m_name);
+	return result ? result : strcmp(left_entry->m_path, right_entry->m_path);
+}
+
+// Scene directories are walked in any order, sorting keeps the generated values stable between machines.
+static ResourceIdEntry* SortResourceIdEntries(stdList* entries, int* count)
+{
+	*count = 0;
+	if (!entries->size(entries))
+		return NULL;
+	ResourceIdEntry* sorted = calloc_d(ResourceIdEntry, entries->size(entries));
+	for (int i = 0; i < entries->size(entries); i++)
+		sorted[i] = *STD_GETDATA(entries, ResourceIdEntry, i);
+	qsort(sorted, entries->size(entries), sizeof(ResourceIdEntry), CompareResourceIdEntries);
+
+	// The managers resolve a name in every scene, so one identifier covers every asset sharing it.
+	for (int i = 0; i < entries->size(entries); i++)
+		if (*count == 0 || strcmp(sorted[*count - 1].m_name, sorted[i].m_name) != 0)
+			sorted[(*count)++] = sorted[i];
+	return sorted;
+}
+
+static void WriteIdentifier(FILE* file, const char* prefix, const char* name)
+{
+	fputs(prefix, file);
+	for (; *name; name++)
+		fputc(isalnum((unsigned char)*name) ? toupper((unsigned char)*name) : '_', file);
+}
+
+static void CollectSceneEntries(stdList* entries, const char* resource_directory_, const char* scene, const ResourceIdType* type)
+{
+	NEW_CHAR(directory, MAX_PATH_SIZE)
+		sprintf_s(directory, MAX_PATH_SIZE, "%s/%s/%s", resource_directory_, scene, type->m_directory);
+	if (fs_status(directory) != FS_TYPE_DIRECTORY)
+		return;
+
+	size_t root_length = strlen(resource_directory_) + 1;
+	stdList* files_infos = SearchFilesInfos(directory, type->m_extension);
+	for (int i = 0; i < files_infos->size(files_infos); i++)
+	{
+		const FilesInfo* files_info = STD_GETDATA(files_infos, FilesInfo, i);
+		ResourceIdEntry entry = { 0 };
+		for (size_t j = 0; files_info->m_name[j] && j < MAX_PATH_SIZE - 1; j++)
+			entry.m_name[j] = (char)tolower((unsigned char)files_info->m_name[j]);
+		if (strcmp(entry.m_name, "placeholder") == 0)
+			continue;
+		strcpy_s(entry.m_path, MAX_PATH_SIZE, strlen(files_info->m_path) > root_length ? files_info->m_path + root_length : files_info->m_path);
+		for (char* c = entry.m_path; *c; c++)
+			if (*c == '\\')
+				*c = '/';
+		entries->push_back(entries, &entry);
+	}
+	files_infos->destroy(&files_infos);
+}
+
+static stdList* CollectResourceIdEntries(const char* resource_directory_, const ResourceIdType* type)
+{
+	stdList* entries = STD_LIST_CREATE(ResourceIdEntry, 0);
+	DIR* dir = opendir(resource_directory_);
+	if (!dir)
+		return entries;
+	struct dirent* scene;
+	while ((scene = readdir(dir)) != NULL)
+	{
+		if (scene->d_type != DT_DIR || strcmp(scene->d_name, ".") == 0 || strcmp(scene->d_name, "..") == 0)
+			continue;
+		CollectSceneEntries(entries, resource_directory_, scene->d_name, type);
+	}
+	closedir(dir);
+	return entries;
+}
+
+static void WriteHeader(FILE* file, const char* output_name, ResourceIdEntry* const* entries, const int* counts)
+{
+	fprintf(file, "// Generated by BuildResourceIds (pixhell_arena.exe --build-resource-ids), do not edit.\n");
+	fprintf(file, "#pragma once\n\n");
+	fprintf(file, "/**\n * @file %s.h\n * @brief Compile-time identifiers of the assets of the resources directory, one enum per asset type.\n */\n", output_name);
+	for (int t = 0; t < (int)RESOURCE_ID_TYPE_COUNT; t++)
+	{
+		const ResourceIdType* type = &resource_id_types[t];
+		fprintf(file, "\ntypedef enum %s %s;\n", type->m_enum_name, type->m_enum_name);
+		fprintf(file, "enum %s\n{\n", type->m_enum_name);
+		for (int i = 0; i < counts[t]; i++)
+		{
+			fputs("    ", file);
+			WriteIdentifier(file, type->m_value_prefix, entries[t][i].m_name);
+			fprintf(file, ", /**< %s */\n", entries[t][i].m_path);
+		}
+		fputs("    ", file);
+		WriteIdentifier(file, type->m_value_prefix, "count");
+		fprintf(file, "\n};\n\n");
+		fprintf(file, "extern const char* const %s_names[]; /**< Name of each identifier, NULL terminated. */\n", type->m_table_prefix);
+		fprintf(file, "extern const char* const %s_paths[]; /**< Path of each identifier from the resources directory, NULL terminated. */\n", type->m_table_prefix);
+	}
+}
+
+static void WriteSource(FILE* file, const char* output_name, ResourceIdEntry* const* entries, const int* counts)
+{
+	fprintf(file, "// Generated by BuildResourceIds (pixhell_arena.exe --build-resource-ids), do not edit.\n");
+	fprintf(file, "#include \"%s.h\"\n", output_name);
+	fprintf(file, "#include <stddef.h>\n");
+	for (int t = 0; t < (int)RESOURCE_ID_TYPE_COUNT; t++)
+	{
+		const ResourceIdType* type = &resource_id_types[t];
+		fprintf(file, "\nconst char* const %s_names[] =\n{\n", type->m_table_prefix);
+		for (int i = 0; i < counts[t]; i++)
+			fprintf(file, "    \"%s\",\n", entries[t][i].m_name);
+		fprintf(file, "    NULL\n};\n");
+		fprintf(file, "\nconst char* const %s_paths[] =\n{\n", type->m_table_prefix);
+		for (int i = 0; i < counts[t]; i++)
+			fprintf(file, "    \"%s\",\n", entries[t][i].m_path);
+		fprintf(file, "    NULL\n};\n");
+	}
+}
+
+static sfBool WriteGeneratedFile(const char* output_path, const char* extension, const char* output_name,
+	void (*write)(FILE*, const char*, ResourceIdEntry* const*, const int*), ResourceIdEntry* const* entries, const int* counts)
+{
+	NEW_CHAR(path, MAX_PATH_SIZE)
+		sprintf_s(path, MAX_PATH_SIZE, "%s%s", output_path, extension);
+	FILE* file = NULL;
+	if (fopen_s(&file, path, "wb") != 0 || !file)
+	{
+		printf_d("Can't write the resource identifiers %s\n", path);
+		return sfFalse;
+	}
+	write(file, output_name, entries, counts);
+	fclose(file);
+	return sfTrue;
+}
+
+sfBool BuildResourceIds(const char* resource_directory_, const char* output_path)
+{
+	if (fs_status(resource_directory_) != FS_TYPE_DIRECTORY)
+	{
+		printf_d("Can't build the resource identifiers, %s is not a directory\n", resource_directory_);
+		return sfFalse;
+	}
+
+	ResourceIdEntry* entries[RESOURCE_ID_TYPE_COUNT] = { 0 };
+	int counts[RESOURCE_ID_TYPE_COUNT] = { 0 };
+	for (int t = 0; t < (int)RESOURCE_ID_TYPE_COUNT; t++)
+	{
+		stdList* collected = CollectResourceIdEntries(resource_directory_, &resource_id_types[t]);
+		entries[t] = SortResourceIdEntries(collected, &counts[t]);
+		collected->destroy(&collected);
+	}
+
+	// The generated source includes the header by its name, not by the path it was written to.
+	const char* output_name = output_path;
+	for (const char* c = output_path; *c; c++)
+		if (*c == '/' || *c == '\\')
+			output_name = c + 1;
+	sfBool is_written = WriteGeneratedFile(output_path, ".h", output_name, WriteHeader, entries, counts)
+		&& WriteGeneratedFile(output_path, ".c", output_name, WriteSource, entries, counts);
+	if (is_written)
+		printf_d("Resource identifiers built, %d textures, %d sounds, %d musics, %d fonts, %d movies\n\n",
+			counts[0], counts[1], counts[2], counts[3], counts[4]);
+
+	for (int t = 0; t < (int)RESOURCE_ID_TYPE_COUNT; t++)
+		if (entries[t])
+			free_d(entries[t]);
+	return is_written;
+}
+
+sfBool CheckResourceIds(const char* resource_directory_)
+{
+	// Without the loose directory, e.g. when only the pack is shipped, there is nothing to compare the identifiers with.
+	if (fs_status(resource_directory_) != FS_TYPE_DIRECTORY)
+		return sfTrue;
+
+	sfBool is_up_to_date = sfTrue;
+	for (int t = 0; t < (int)RESOURCE_ID_TYPE_COUNT; t++)
+	{
+		const ResourceIdType* type = &resource_id_types[t];
+		stdList* collected = CollectResourceIdEntries(resource_directory_, type);
+		int count;
+		ResourceIdEntry* entries = SortResourceIdEntries(collected, &count);
+		collected->destroy(&collected);
+
+		// Both lists are sorted by name, as the generator writes them.
+		int i = 0, j = 0;
+		while (i < count || type->m_names[j])
+		{
+			int result = i == count ? 1 : !type->m_names[j] ? -1 : strcmp(entries[i].m_name, type->m_names[j]);
+			if (result < 0)
+				printf_d("%s has no %s, run --build-resource-ids\n", entries[i].m_path, type->m_enum_name);
+			else if (result > 0)
+				printf_d("The %s %s has no file anymore, run --build-resource-ids\n", type->m_enum_name, type->m_names[j]);
+			if (result)
+				is_up_to_date = sfFalse;
+			if (result <= 0)
+				i++;
+			if (result >= 0)
+				j++;
+		}
+		if (entries)
+			free_d(entries);
+	}
+	return is_up_to_date;
+}
@@ -0,0 +1,58 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "Tools.h"
+
+/**
+ * @file resourceidbuilder.h
+ * @brief This file defines the generator of ResourceIds.h and ResourceIds.c, the compile-time identifiers of the assets.
+ *
+ * The generator walks every scene of the resources directory and writes one enum per asset type, with one value per asset name,
+ * and a table of the names and paths indexed by these values. Code asking for an asset through its identifier fails to compile
+ * when the asset is renamed or removed, where a name string only prints "not found" at runtime.
+ * The files are generated in the source directory and committed, run the generator again after adding or renaming an asset.
+ * InitResourcesManager checks them against the resources directory with CheckResourceIds and prints the assets they miss.
+ *
+ * @code
+ * // From the command line, in the project directory:
+ * // pixhell_arena.exe --build-resource-ids
+ * sfSprite_setTexture(sprite, GetTextureById(TEXTURE_ID_LOADING), sfTrue);
+ * @endcode
+ */
+
+/**
+ * @brief Walks a resources directory and writes the identifiers of its assets, replacing the existing files.
+ * @param resource_directory_ Path to the resources directory.
+ * @param output_path Path of the generated files, without extension. ".h" and ".c" are appended to it.
+ * @return sfTrue if both files were written, sfFalse otherwise.
+ */
+sfBool BuildResourceIds(const char* resource_directory_, const char* output_path);
+
+/**
+ * @brief Compares the compiled identifiers with the assets of a resources directory, and prints every asset added or removed since they were generated.
+ * @param resource_directory_ Path to the resources directory.
+ * @return sfTrue if the identifiers match the assets or if the directory does not exist, sfFalse if they must be generated again.
+ *
+ * @note Called by InitResourcesManager, a stale ResourceIds.h still compiles but resolves its identifiers to the wrong assets.
+ */
+sfBool CheckResourceIds(const char* resource_directory_);
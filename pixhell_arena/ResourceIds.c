@@ -0,0 +1,65 @@
+// Generated by BuildResourceIds (pixhell_arena.exe --build-resource-ids), do not edit.
+#include "ResourceIds.h"
+#include <stddef.h>
+
+const char* const texture_id_names[] =
+{
+    "ingamep1",
+    "ingamep2",
+    "loading",
+    "menu_spritesheet",
+    NULL
+};
+
+const char* const texture_id_paths[] =
+{
+    "Game/Textures/InGameP1.png",
+    "Game/Textures/InGameP2.png",
+    "ALL/Textures/loading.png",
+    "ALL/Textures/Menu_Spritesheet.png",
+    NULL
+};
+
+const char* const sound_id_names[] =
+{
+    "button_click",
+    NULL
+};
+
+const char* const sound_id_paths[] =
+{
+    "ALL/Sounds/button_click.wav",
+    NULL
+};
+
+const char* const music_id_names[] =
+{
+    "evergreen",
+    NULL
+};
+
+const char* const music_id_paths[] =
+{
+    "ALL/Musics/Evergreen.ogg",
+    NULL
+};
+
+const char* const font_id_names[] =
+{
+    NULL
+};
+
+const char* const font_id_paths[] =
+{
+    NULL
+};
+
+const char* const movie_id_names[] =
+{
+    NULL
+};
+
+const char* const movie_id_paths[] =
+{
+    NULL
+};
@@ -0,0 +1,58 @@
+// Generated by BuildResourceIds (pixhell_arena.exe --build-resource-ids), do not edit.
+#pragma once
+
+/**
+ * @file ResourceIds.h
+ * @brief Compile-time identifiers of the assets of the resources directory, one enum per asset type.
+ */
+
+typedef enum TextureId TextureId;
+enum TextureId
+{
+    TEXTURE_ID_INGAMEP1, /**< Game/Textures/InGameP1.png */
+    TEXTURE_ID_INGAMEP2, /**< Game/Textures/InGameP2.png */
+    TEXTURE_ID_LOADING, /**< ALL/Textures/loading.png */
+    TEXTURE_ID_MENU_SPRITESHEET, /**< ALL/Textures/Menu_Spritesheet.png */
+    TEXTURE_ID_COUNT
+};
+
+extern const char* const texture_id_names[]; /**< Name of each identifier, NULL terminated. */
+extern const char* const texture_id_paths[]; /**< Path of each identifier from the resources directory, NULL terminated. */
+
+typedef enum SoundId SoundId;
+enum SoundId
+{
+    SOUND_ID_BUTTON_CLICK, /**< ALL/Sounds/button_click.wav */
+    SOUND_ID_COUNT
+};
+
+extern const char* const sound_id_names[]; /**< Name of each identifier, NULL terminated. */
+extern const char* const sound_id_paths[]; /**< Path of each identifier from the resources directory, NULL terminated. */
+
+typedef enum MusicId MusicId;
+enum MusicId
+{
+    MUSIC_ID_EVERGREEN, /**< ALL/Musics/Evergreen.ogg */
+    MUSIC_ID_COUNT
+};
+
+extern const char* const music_id_names[]; /**< Name of each identifier, NULL terminated. */
+extern const char* const music_id_paths[]; /**< Path of each identifier from the resources directory, NULL terminated. */
+
+typedef enum FontId FontId;
+enum FontId
+{
+    FONT_ID_COUNT
+};
+
+extern const char* const font_id_names[]; /**< Name of each identifier, NULL terminated. */
+extern const char* const font_id_paths[]; /**< Path of each identifier from the resources directory, NULL terminated. */
+
+typedef enum MovieId MovieId;
+enum MovieId
+{
+    MOVIE_ID_COUNT
+};
+
+extern const char* const movie_id_names[]; /**< Name of each identifier, NULL terminated. */
+extern const char* const movie_id_paths[]; /**< Path of each identifier from the resources directory, NULL terminated. */
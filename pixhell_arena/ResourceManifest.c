@@ -0,0 +1,297 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "ResourceManifest.h"
+#include "MemoryManagement.h"
+#include <windows.h>
+
+typedef struct ManifestEntry ManifestEntry;
+struct ManifestEntry
+{
+	sfBool m_is_directory;
+	unsigned long long m_size;
+	unsigned long long m_mtime;
+	char m_path[MAX_PATH_SIZE];
+};
+
+static stdList* manifest_entries;
+static char manifest_root[MAX_PATH_SIZE];
+
+
+static sfBool GetEntryAttributes(const char* path, sfBool* is_directory, unsigned long long* size, unsigned long long* mtime)
+{
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data))
+		return sfFalse;
+	*is_directory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? sfTrue : sfFalse;
+	*size = ((unsigned long long)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+	*mtime = ((unsigned long long)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+	return sfTrue;
+}
+
+static void NormalizeSeparators(char* path)
+{
+	for (; *path; path++)
+		if (*path == '/')
+			*path = '\\';
+}
+
+static void BuildFullPath(char* full_path, const char* relative_path)
+{
+	strcpy_s(full_path, MAX_PATH_SIZE, manifest_root);
+	if (relative_path[0])
+	{
+		strcat_s(full_path, MAX_PATH_SIZE, "\\");
+		strcat_s(full_path, MAX_PATH_SIZE, relative_path);
+	}
+}
+
+static void WalkDirectory(stdList* entries, const char* relative_path)
+{
+	NEW_CHAR(full_path, MAX_PATH_SIZE)
+		BuildFullPath(full_path, relative_path);
+
+	ManifestEntry directory = { .m_is_directory = sfTrue };
+	strcpy_s(directory.m_path, MAX_PATH_SIZE, relative_path);
+	if (!GetEntryAttributes(full_path, &directory.m_is_directory, &directory.m_size, &directory.m_mtime))
+		return;
+	entries->push_back(entries, &directory);
+
+	DIR* dir = opendir(full_path);
+	if (!dir)
+		return;
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != NULL)
+	{
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+			continue;
+		NEW_CHAR(child_path, MAX_PATH_SIZE)
+			if (relative_path[0])
+			{
+				strcpy_s(child_path, MAX_PATH_SIZE, relative_path);
+				strcat_s(child_path, MAX_PATH_SIZE, "\\");
+			}
+		strcat_s(child_path, MAX_PATH_SIZE, entry->d_name);
+
+		if (entry->d_type == DT_DIR)
+		{
+			WalkDirectory(entries, child_path);
+			continue;
+		}
+		if (relative_path[0] == '\0' && strcmp(entry->d_name, RESOURCE_MANIFEST_NAME) == 0)
+			continue;
+
+		NEW_CHAR(child_full_path, MAX_PATH_SIZE)
+			BuildFullPath(child_full_path, child_path);
+		ManifestEntry file = { 0 };
+		strcpy_s(file.m_path, MAX_PATH_SIZE, child_path);
+		if (GetEntryAttributes(child_full_path, &file.m_is_directory, &file.m_size, &file.m_mtime))
+			entries->push_back(entries, &file);
+	}
+	closedir(dir);
+}
+
+static sfBool WriteManifest(stdList* entries)
+{
+	NEW_CHAR(manifest_path, MAX_PATH_SIZE)
+		BuildFullPath(manifest_path, RESOURCE_MANIFEST_NAME);
+
+	FILE* file = NULL;
+	if (fopen_s(&file, manifest_path, "wb") != 0 || !file)
+	{
+		printf_d("Can't write the resource manifest %s\n", manifest_path);
+		return sfFalse;
+	}
+	fprintf(file, "PIXHELL_MANIFEST %d\n", RESOURCE_MANIFEST_VERSION);
+	for (int i = 0; i < entries->size(entries); i++)
+	{
+		const ManifestEntry* entry = STD_GETDATA(entries, ManifestEntry, i);
+		fprintf(file, "%c %llu %llu %s\n", entry->m_is_directory ? 'D' : 'F', entry->m_size, entry->m_mtime, entry->m_path);
+	}
+	fclose(file);
+	return sfTrue;
+}
+
+static char* ReadWholeFile(const char* path)
+{
+	FILE* file = NULL;
+	if (fopen_s(&file, path, "rb") != 0 || !file)
+		return NULL;
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	char* buffer = size > 0 ? calloc_d(char, (size_t)size + 1) : NULL;
+	if (buffer && fread(buffer, 1, (size_t)size, file) != (size_t)size)
+	{
+		free_d(buffer);
+		buffer = NULL;
+	}
+	fclose(file);
+	return buffer;
+}
+
+static stdList* ParseManifest(char* buffer)
+{
+	char* context = NULL;
+	char* line = strtok_s(buffer, "\n", &context);
+	int version = 0;
+	if (!line || sscanf_s(line, "PIXHELL_MANIFEST %d", &version) != 1 || version != RESOURCE_MANIFEST_VERSION)
+		return NULL;
+
+	stdList* entries = STD_LIST_CREATE(ManifestEntry, 0);
+	while ((line = strtok_s(NULL, "\n", &context)) != NULL)
+	{
+		ManifestEntry entry = { 0 };
+		char type = 0;
+		int path_offset = 0;
+		if (sscanf_s(line, "%c %llu %llu %n", &type, 1, &entry.m_size, &entry.m_mtime, &path_offset) != 3 || !path_offset)
+		{
+			entries->destroy(&entries);
+			return NULL;
+		}
+		entry.m_is_directory = type == 'D' ? sfTrue : sfFalse;
+		strcpy_s(entry.m_path, MAX_PATH_SIZE, line + path_offset);
+		size_t length = strlen(entry.m_path);
+		if (length && entry.m_path[length - 1] == '\r')
+			entry.m_path[length - 1] = '\0';
+		entries->push_back(entries, &entry);
+	}
+	return entries;
+}
+
+// A directory modification time changes when one of its files is added, removed or renamed,
+// a file size or modification time when it is rewritten in place.
+static sfBool IsManifestUpToDate(stdList* entries)
+{
+	for (int i = 0; i < entries->size(entries); i++)
+	{
+		const ManifestEntry* entry = STD_GETDATA(entries, ManifestEntry, i);
+		NEW_CHAR(full_path, MAX_PATH_SIZE)
+			BuildFullPath(full_path, entry->m_path);
+		sfBool is_directory;
+		unsigned long long size, mtime;
+		if (!GetEntryAttributes(full_path, &is_directory, &size, &mtime) || is_directory != entry->m_is_directory || mtime != entry->m_mtime)
+			return sfFalse;
+		if (!is_directory && size != entry->m_size)
+			return sfFalse;
+	}
+	return sfTrue;
+}
+
+static void SetManifestRoot(const char* resource_directory_)
+{
+	DestroyResourceManifest();
+	strcpy_s(manifest_root, MAX_PATH_SIZE, resource_directory_);
+	NormalizeSeparators(manifest_root);
+	size_t length = strlen(manifest_root);
+	if (length && manifest_root[length - 1] == '\\')
+		manifest_root[length - 1] = '\0';
+}
+
+sfBool BuildResourceManifest(const char* resource_directory_)
+{
+	SetManifestRoot(resource_directory_);
+
+	stdList* entries = STD_LIST_CREATE(ManifestEntry, 0);
+	WalkDirectory(entries, "");
+	if (!entries->size(entries))
+	{
+		printf_d("Can't build the resource manifest, %s is not a directory\n", manifest_root);
+		entries->destroy(&entries);
+		return sfFalse;
+	}
+	manifest_entries = entries;
+	printf_d("Resource manifest built, %d entries\n\n", entries->size(entries));
+	return WriteManifest(entries);
+}
+
+sfBool LoadResourceManifest(const char* resource_directory_)
+{
+	SetManifestRoot(resource_directory_);
+
+	NEW_CHAR(manifest_path, MAX_PATH_SIZE)
+		BuildFullPath(manifest_path, RESOURCE_MANIFEST_NAME);
+	char* buffer = ReadWholeFile(manifest_path);
+	if (buffer)
+	{
+		stdList* entries = ParseManifest(buffer);
+		free_d(buffer);
+		if (entries && IsManifestUpToDate(entries))
+		{
+			manifest_entries = entries;
+			printf_d("Resource manifest loaded, %d entries\n\n", entries->size(entries));
+			return sfTrue;
+		}
+		if (entries)
+			entries->destroy(&entries);
+		printf_d("Resource manifest out of date, rebuilding it\n\n");
+	}
+	BuildResourceManifest(resource_directory_);
+	return manifest_entries != NULL;
+}
+
+stdList* SearchManifestFilesInfos(const char* path, const char* extension)
+{
+	if (!manifest_entries)
+		return NULL;
+
+	NEW_CHAR(directory, MAX_PATH_SIZE)
+		strcpy_s(directory, MAX_PATH_SIZE, path);
+	NormalizeSeparators(directory);
+	size_t root_length = strlen(manifest_root);
+	if (strncmp(directory, manifest_root, root_length) != 0 || (directory[root_length] != '\\' && directory[root_length] != '\0'))
+		return NULL;
+	const char* relative_directory = directory[root_length] ? directory + root_length + 1 : "";
+	size_t relative_length = strlen(relative_directory);
+	if (relative_length && relative_directory[relative_length - 1] == '\\')
+		relative_length--;
+
+	stdList* files_list = STD_LIST_CREATE(FilesInfo, 0);
+	for (int i = 0; i < manifest_entries->size(manifest_entries); i++)
+	{
+		const ManifestEntry* entry = STD_GETDATA(manifest_entries, ManifestEntry, i);
+		if (entry->m_is_directory)
+			continue;
+		if (relative_length && (strncmp(entry->m_path, relative_directory, relative_length) != 0 || entry->m_path[relative_length] != '\\'))
+			continue;
+		const char* file_name = strrchr(entry->m_path, '\\');
+		file_name = file_name ? file_name + 1 : entry->m_path;
+		const char* file_extension = strrchr(file_name, '.');
+		if (!file_extension || strcmp(file_extension + 1, extension) != 0)
+			continue;
+
+		FilesInfo files_info;
+		size_t stem_length = (size_t)(file_extension - file_name);
+		strncpy_s(files_info.m_name, MAX_PATH_SIZE, file_name, stem_length);
+		BuildFullPath(files_info.m_path, entry->m_path);
+		files_info.m_size = entry->m_size;
+		files_list->push_back(files_list, &files_info);
+	}
+	return files_list;
+}
+
+void DestroyResourceManifest(void)
+{
+	if (manifest_entries)
+		manifest_entries->destroy(&manifest_entries);
+	manifest_entries = NULL;
+}
@@ -0,0 +1,82 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "Tools.h"
+
+/**
+ * @file resourcemanifest.h
+ * @brief This file defines the resource manifest, a flat list of every asset of the resources directory.
+ *
+ * Walking the resources directory opens every file to know if it is a file, once per manager and per scene.
+ * The manifest does this walk once and writes every asset path, size and modification time in RESOURCE_MANIFEST_NAME.
+ * The next runs read it in one go and only check the attributes of each entry: a directory modification time changes when a file is added, removed or renamed in it,
+ * a file size or modification time when it is rewritten.
+ * SearchFilesInfos then answers from the manifest without touching the filesystem.
+ *
+ * @code
+ * // Example usage, done by InitResourcesManager:
+ * LoadResourceManifest("../Ressources");
+ * stdList* files = SearchFilesInfos("../Ressources/ALL/Textures", "png"); // Answered by the manifest.
+ * @endcode
+ */
+
+/**
+ * @def RESOURCE_MANIFEST_NAME
+ * @brief Name of the manifest file, written at the root of the resources directory.
+ */
+#define RESOURCE_MANIFEST_NAME "manifest.txt"
+
+/**
+ * @def RESOURCE_MANIFEST_VERSION
+ * @brief Version written in the manifest header. A manifest with another version is rebuilt.
+ */
+#define RESOURCE_MANIFEST_VERSION 1
+
+/**
+ * @brief Loads the manifest of a resources directory, or builds and writes it if it is missing or out of date.
+ * @param resource_directory_ Path to the resources directory.
+ * @return sfTrue if the manifest is usable, sfFalse if the directory could not be walked.
+ */
+sfBool LoadResourceManifest(const char* resource_directory_);
+
+/**
+ * @brief Walks a resources directory and writes its manifest, replacing the existing one.
+ * @param resource_directory_ Path to the resources directory.
+ * @return sfTrue if the manifest was written, sfFalse otherwise.
+ *
+ * @note Also makes the new manifest the one answering SearchFilesInfos.
+ */
+sfBool BuildResourceManifest(const char* resource_directory_);
+
+/**
+ * @brief Lists the files of a directory from the manifest, like SearchFilesInfos does from the filesystem.
+ * @param path Directory to search in, recursively. Must be inside the resources directory of the manifest.
+ * @param extension Extension of the files to list, without the dot.
+ * @return A new list of FilesInfo, or NULL if no manifest is loaded or if path is outside of its directory.
+ */
+stdList* SearchManifestFilesInfos(const char* path, const char* extension);
+
+/**
+ * @brief Frees the loaded manifest. SearchFilesInfos walks the filesystem again afterward.
+ */
+void DestroyResourceManifest(void);
@@ -0,0 +1,242 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "ResourceRegistry.h"
+#include "MemoryManagement.h"
+#include <windows.h>
+#include <assert.h>
+#include <ctype.h>
+
+#define RESOURCE_REGISTRY_INITIAL_CAPACITY 64
+
+typedef struct ResourceSlot ResourceSlot;
+struct ResourceSlot
+{
+	unsigned int m_hash;
+	ResourceHandle m_handle; // INVALID_RESOURCE_HANDLE for an empty slot.
+};
+
+struct ResourceRegistry_Data
+{
+	SRWLOCK m_lock;
+	ResourceSlot* m_slots;
+	size_t m_capacity; // Always a power of two.
+	ResourceEntry* m_pages[RESOURCE_REGISTRY_MAX_PAGES];
+	volatile LONG m_count;
+};
+
+static void LowerName(char* lower_name, const char* name)
+{
+	size_t i = 0;
+	for (; name[i] && i < MAX_PATH_SIZE - 1; i++)
+		lower_name[i] = (char)tolower((unsigned char)name[i]);
+	lower_name[i] = '\0';
+}
+
+// FNV-1a
+static unsigned int HashName(const char* name)
+{
+	unsigned int hash = 2166136261u;
+	for (const char* c = name; *c; c++)
+		hash = (hash ^ (unsigned char)*c) * 16777619u;
+	return hash;
+}
+
+static ResourceEntry* GetEntryUnchecked(ResourceRegistry_Data* data, ResourceHandle handle)
+{
+	size_t index = (size_t)handle - 1;
+	return &data->m_pages[index / RESOURCE_REGISTRY_PAGE_SIZE][index % RESOURCE_REGISTRY_PAGE_SIZE];
+}
+
+// Must be called with the lock held. Returns the slot of the name, or the empty slot where it belongs.
+static ResourceSlot* FindSlot(ResourceRegistry_Data* data, const char* lower_name, unsigned int hash)
+{
+	size_t mask = data->m_capacity - 1;
+	for (size_t i = hash & mask;; i = (i + 1) & mask)
+	{
+		ResourceSlot* slot = &data->m_slots[i];
+		if (slot->m_handle == INVALID_RESOURCE_HANDLE)
+			return slot;
+		if (slot->m_hash == hash && strcmp(GetEntryUnchecked(data, slot->m_handle)->m_name, lower_name) == 0)
+			return slot;
+	}
+}
+
+// Must be called with the lock held exclusively.
+static void GrowSlots(ResourceRegistry_Data* data)
+{
+	ResourceSlot* old_slots = data->m_slots;
+	size_t old_capacity = data->m_capacity;
+	data->m_capacity *= 2;
+	data->m_slots = calloc_d(ResourceSlot, data->m_capacity);
+	assert(data->m_slots);
+	for (size_t i = 0; i < old_capacity; i++)
+	{
+		if (old_slots[i].m_handle == INVALID_RESOURCE_HANDLE)
+			continue;
+		size_t mask = data->m_capacity - 1;
+		size_t j = old_slots[i].m_hash & mask;
+		while (data->m_slots[j].m_handle != INVALID_RESOURCE_HANDLE)
+			j = (j + 1) & mask;
+		data->m_slots[j] = old_slots[i];
+	}
+	free_d(old_slots);
+}
+
+// Must be called with the lock held exclusively.
+static ResourceHandle AddEntry(ResourceRegistry_Data* data, const char* lower_name, unsigned int hash)
+{
+	size_t index = (size_t)data->m_count;
+	if (index >= (size_t)RESOURCE_REGISTRY_PAGE_SIZE * RESOURCE_REGISTRY_MAX_PAGES)
+		return INVALID_RESOURCE_HANDLE;
+	if ((index + 1) * 10 > data->m_capacity * 7)
+		GrowSlots(data);
+
+	if (!data->m_pages[index / RESOURCE_REGISTRY_PAGE_SIZE])
+	{
+		data->m_pages[index / RESOURCE_REGISTRY_PAGE_SIZE] = calloc_d(ResourceEntry, RESOURCE_REGISTRY_PAGE_SIZE);
+		assert(data->m_pages[index / RESOURCE_REGISTRY_PAGE_SIZE]);
+	}
+	ResourceHandle handle = (ResourceHandle)index + 1;
+	strcpy_s(GetEntryUnchecked(data, handle)->m_name, MAX_PATH_SIZE, lower_name);
+
+	ResourceSlot* slot = FindSlot(data, lower_name, hash);
+	slot->m_hash = hash;
+	slot->m_handle = handle;
+	// The entry is complete before its handle can be resolved by GetEntry.
+	InterlockedIncrement(&data->m_count);
+	return handle;
+}
+
+static ResourceHandle GetHandle(ResourceRegistry* registry, const char* name, sfBool* is_new)
+{
+	ResourceRegistry_Data* data = registry->_Data;
+	NEW_CHAR(lower_name, MAX_PATH_SIZE)
+		LowerName(lower_name, name);
+	unsigned int hash = HashName(lower_name);
+	if (is_new)
+		*is_new = sfFalse;
+
+	AcquireSRWLockShared(&data->m_lock);
+	ResourceHandle handle = FindSlot(data, lower_name, hash)->m_handle;
+	ReleaseSRWLockShared(&data->m_lock);
+	if (handle != INVALID_RESOURCE_HANDLE)
+		return handle;
+
+	AcquireSRWLockExclusive(&data->m_lock);
+	handle = FindSlot(data, lower_name, hash)->m_handle;
+	if (handle == INVALID_RESOURCE_HANDLE)
+	{
+		handle = AddEntry(data, lower_name, hash);
+		if (is_new && handle != INVALID_RESOURCE_HANDLE)
+			*is_new = sfTrue;
+	}
+	ReleaseSRWLockExclusive(&data->m_lock);
+	return handle;
+}
+
+static ResourceEntry* GetEntry(ResourceRegistry* registry, ResourceHandle handle)
+{
+	ResourceRegistry_Data* data = registry->_Data;
+	if (handle == INVALID_RESOURCE_HANDLE || handle > (ResourceHandle)data->m_count)
+		return NULL;
+	return GetEntryUnchecked(data, handle);
+}
+
+static void AddGlobalResource(ResourceRegistry* registry, const char* name, void* resource)
+{
+	ResourceEntry* entry = GetEntry(registry, GetHandle(registry, name, NULL));
+	if (entry)
+		InterlockedCompareExchangePointer(&entry->m_global_resource, resource, NULL);
+}
+
+static void AddSceneResource(ResourceRegistry* registry, const char* name, void* resource)
+{
+	ResourceEntry* entry = GetEntry(registry, GetHandle(registry, name, NULL));
+	if (entry)
+		InterlockedCompareExchangePointer(&entry->m_scene_resource, resource, NULL);
+}
+
+static void ClearSceneResources(ResourceRegistry* registry)
+{
+	ResourceRegistry_Data* data = registry->_Data;
+	LONG count = data->m_count;
+	for (LONG i = 0; i < count; i++)
+	{
+		ResourceEntry* entry = GetEntryUnchecked(data, (ResourceHandle)i + 1);
+		if (entry->m_ref_count <= 0)
+			InterlockedExchangePointer(&entry->m_scene_resource, NULL);
+	}
+}
+
+static LONG AddReference(ResourceRegistry* registry, ResourceHandle handle)
+{
+	ResourceEntry* entry = GetEntry(registry, handle);
+	return entry ? InterlockedIncrement(&entry->m_ref_count) : 0;
+}
+
+static LONG RemoveReference(ResourceRegistry* registry, ResourceHandle handle)
+{
+	ResourceEntry* entry = GetEntry(registry, handle);
+	if (!entry)
+		return 0;
+	LONG ref_count = InterlockedDecrement(&entry->m_ref_count);
+	assert(ref_count >= 0);
+	return ref_count;
+}
+
+static void DestroyResourceRegistry(ResourceRegistry** registry)
+{
+	ResourceRegistry_Data* data = (*registry)->_Data;
+	for (size_t i = 0; i < RESOURCE_REGISTRY_MAX_PAGES && data->m_pages[i]; i++)
+		free_d(data->m_pages[i]);
+	free_d(data->m_slots);
+	free_d(data);
+	free_d(*registry);
+	*registry = NULL;
+}
+
+ResourceRegistry* CreateResourceRegistry(void)
+{
+	ResourceRegistry* tmp = calloc_d(ResourceRegistry, 1);
+	ResourceRegistry_Data* tmp_data = calloc_d(ResourceRegistry_Data, 1);
+	assert(tmp);
+	assert(tmp_data);
+
+	InitializeSRWLock(&tmp_data->m_lock);
+	tmp_data->m_capacity = RESOURCE_REGISTRY_INITIAL_CAPACITY;
+	tmp_data->m_slots = calloc_d(ResourceSlot, tmp_data->m_capacity);
+	assert(tmp_data->m_slots);
+
+	tmp->_Data = tmp_data;
+
+	tmp->GetHandle = &GetHandle;
+	tmp->GetEntry = &GetEntry;
+	tmp->AddGlobalResource = &AddGlobalResource;
+	tmp->AddSceneResource = &AddSceneResource;
+	tmp->ClearSceneResources = &ClearSceneResources;
+	tmp->AddReference = &AddReference;
+	tmp->RemoveReference = &RemoveReference;
+	tmp->Destroy = &DestroyResourceRegistry;
+
+	return tmp;
+}
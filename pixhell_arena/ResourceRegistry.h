@@ -0,0 +1,172 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "FileSystem.h"
+#include "SFML/Config.h"
+
+/**
+ * @file resourceregistry.h
+ * @brief This file defines the ResourceRegistry structure, which maps resource names to stable integer handles.
+ *
+ * Every resource manager owns a registry. A name is hashed once, into an open-addressing table, and gets a handle that never changes.
+ * Resolving a handle is an array access without any lock, so hot paths resolve their names once at init and use handles every frame.
+ * A name asked for but never loaded keeps its entry, empty, so the next lookups of a missing resource are as cheap as the others.
+ *
+ * @code
+ * // At init:
+ * ResourceHandle player_handle = GetTextureHandle("player");
+ * // Every frame:
+ * sfSprite_setTexture(sprite, GetTextureFromHandle(player_handle), sfFalse);
+ * @endcode
+ */
+
+/**
+ * @def INVALID_RESOURCE_HANDLE
+ * @brief Handle resolving to no entry, returned when the registry is full.
+ */
+#define INVALID_RESOURCE_HANDLE 0u
+
+/**
+ * @def RESOURCE_REGISTRY_PAGE_SIZE
+ * @brief Number of entries allocated at once. Entries never move, so a handle is resolved without taking the lock.
+ */
+#define RESOURCE_REGISTRY_PAGE_SIZE 256
+
+/**
+ * @def RESOURCE_REGISTRY_MAX_PAGES
+ * @brief Maximum number of entry pages of a registry.
+ */
+#define RESOURCE_REGISTRY_MAX_PAGES 256
+
+/**
+ * @typedef ResourceHandle
+ * @brief Stable identifier of a resource name in a ResourceRegistry, starting at 1.
+ */
+typedef unsigned int ResourceHandle;
+
+/**
+ * @typedef ResourceEntry
+ * @brief The resources registered under a name.
+ */
+typedef struct ResourceEntry ResourceEntry;
+
+/**
+ * @struct ResourceEntry
+ * @brief The resources registered under a name, a global one wins over a scene one like in the lookups by name.
+ */
+struct ResourceEntry
+{
+    char m_name[MAX_PATH_SIZE];          /**< Lower-cased name of the resource. */
+    void* volatile m_global_resource;    /**< Entry of the global list of the manager, NULL if none. */
+    void* volatile m_scene_resource;     /**< Resource of the current scene, NULL if none. */
+    volatile LONG m_ref_count;           /**< References taken with AddReference, a referenced scene resource outlives its scene. */
+};
+
+/**
+ * @typedef ResourceRegistry_Data
+ * @brief Opaque structure that holds the internal data of the registry.
+ */
+typedef struct ResourceRegistry_Data ResourceRegistry_Data;
+
+/**
+ * @typedef ResourceRegistry
+ * @brief Maps resource names to stable handles.
+ */
+typedef struct ResourceRegistry ResourceRegistry;
+
+/**
+ * @struct ResourceRegistry
+ * @brief Contains function pointers to register resources and resolve their names and handles. Every function can be called from any thread.
+ */
+struct ResourceRegistry
+{
+    ResourceRegistry_Data* _Data; /**< Internal data of the registry. */
+
+    /**
+     * @brief Finds the handle of a name, adding an empty entry the first time the name is asked for.
+     * @param registry Pointer to the ResourceRegistry object.
+     * @param name Name of the resource, compared without case.
+     * @param is_new Set to sfTrue if the entry was added by this call, can be NULL.
+     * @return The handle of the name, INVALID_RESOURCE_HANDLE if the registry is full.
+     */
+    ResourceHandle (*GetHandle)(ResourceRegistry* registry, const char* name, sfBool* is_new);
+
+    /**
+     * @brief Resolves a handle.
+     * @param registry Pointer to the ResourceRegistry object.
+     * @param handle Handle returned by the registry.
+     * @return The entry of the handle, NULL for INVALID_RESOURCE_HANDLE.
+     */
+    ResourceEntry* (*GetEntry)(ResourceRegistry* registry, ResourceHandle handle);
+
+    /**
+     * @brief Registers a global resource, the first one registered under a name is kept.
+     * @param registry Pointer to the ResourceRegistry object.
+     * @param name Name of the resource.
+     * @param resource Entry of the global list, must not move until the registry is destroyed.
+     */
+    void (*AddGlobalResource)(ResourceRegistry* registry, const char* name, void* resource);
+
+    /**
+     * @brief Registers a resource of the current scene, the first one registered under a name is kept.
+     * @param registry Pointer to the ResourceRegistry object.
+     * @param name Name of the resource.
+     * @param resource The resource, until ClearSceneResources.
+     */
+    void (*AddSceneResource)(ResourceRegistry* registry, const char* name, void* resource);
+
+    /**
+     * @brief Forgets the resources of the current scene, the handles stay valid and resolve to empty entries.
+     * Referenced entries keep their resource, the manager keeps it alive in its ResourceCache.
+     * @param registry Pointer to the ResourceRegistry object.
+     */
+    void (*ClearSceneResources)(ResourceRegistry* registry);
+
+    /**
+     * @brief Takes a reference on a handle, its scene resource is then kept when the scene is cleared.
+     * @param registry Pointer to the ResourceRegistry object.
+     * @param handle Handle returned by the registry.
+     * @return The new number of references, 0 for INVALID_RESOURCE_HANDLE.
+     */
+    LONG (*AddReference)(ResourceRegistry* registry, ResourceHandle handle);
+
+    /**
+     * @brief Releases a reference taken with AddReference.
+     * @param registry Pointer to the ResourceRegistry object.
+     * @param handle Handle returned by the registry.
+     * @return The number of references left, 0 for INVALID_RESOURCE_HANDLE.
+     */
+    LONG (*RemoveReference)(ResourceRegistry* registry, ResourceHandle handle);
+
+    /**
+     * @brief Destroys the registry and every entry.
+     * @param registry Pointer to the pointer of the ResourceRegistry object to destroy.
+     */
+    void (*Destroy)(ResourceRegistry** registry);
+};
+
+/**
+ * @brief Creates an empty ResourceRegistry.
+ * @return Pointer to the newly created ResourceRegistry object.
+ */
+ResourceRegistry* CreateResourceRegistry(void);
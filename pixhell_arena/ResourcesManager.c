@@ -21,37 +21,204 @@
 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #include "ResourcesManager.h"
+#include "Profiler.h"
+#include "ResourceIdBuilder.h"
 
-float __TextureProgressBar, __MovieProgressBar, __SoundProgressBar,__MusicProgressBar ,__FontProgressBar;
+LoadingProgress scene_loading_progress;
+
+typedef struct CriticalAsset CriticalAsset;
+struct CriticalAsset
+{
+	char m_scene[MAX_PATH_SIZE];
+	char m_name[MAX_PATH_SIZE];
+};
+
+static SRWLOCK prefetch_lock = SRWLOCK_INIT;
+static SceneLoader scene_loader;
+static SceneLoader prefetch_loader;
+static char prefetch_scene_name[MAX_PATH_SIZE];
+static sfBool has_prefetched_scene;
+
+static SRWLOCK critical_asset_lock = SRWLOCK_INIT;
+static stdList* critical_asset_list;
+
+// Must be called with critical_asset_lock held, a NULL name matches any asset of the scene.
+static sfBool HasCriticalAsset(const char* scene_name, const char* name)
+{
+	if (critical_asset_list != NULL)
+		FOR_EACH_LIST(critical_asset_list, CriticalAsset, i, it,
+			if (_stricmp(it->m_scene, scene_name) == 0 && (!name || _stricmp(it->m_name, name) == 0))
+				return sfTrue;
+				)
+	return sfFalse;
+}
+
+// A scene without any declared critical asset is entirely critical, so LoadScene waits for all of it.
+static void MarkCriticalAssets(const char* scene_name, SceneLoader* loader)
+{
+	AcquireSRWLockShared(&critical_asset_lock);
+	sfBool has_critical_assets = HasCriticalAsset(scene_name, NULL);
+	FOR_EACH_LIST(loader->m_jobs, SceneLoadJob, i, job,
+		job->m_is_critical = !has_critical_assets || HasCriticalAsset(scene_name, job->m_file_info.m_name);
+		)
+	ReleaseSRWLockShared(&critical_asset_lock);
+}
+
+// Every category is queued before the first file loads, so the loading bar never goes backward.
+static void StartSceneLoader(const char* scene_name, SceneLoader* loader, sfBool is_prefetch)
+{
+	InterlockedExchange64(&scene_loading_progress.m_loaded_bytes, 0);
+	InterlockedExchange64(&scene_loading_progress.m_total_bytes, 0);
+	__InitSceneLoader(loader, &scene_loading_progress, is_prefetch ? NULL : GetThreadCancelToken());
+	if (is_prefetch)
+	{
+		PrefetchSceneTexture(scene_name, loader);
+		PrefetchSceneFont(scene_name, loader);
+		PrefetchSceneSound(scene_name, loader);
+		PrefetchSceneMovie(scene_name, loader);
+	}
+	else
+	{
+		LoadSceneTexture(scene_name, loader);
+		LoadSceneFont(scene_name, loader);
+		LoadSceneSound(scene_name, loader);
+		LoadSceneMovie(scene_name, loader);
+	}
+	MarkCriticalAssets(scene_name, loader);
+	__StartSceneLoader(loader);
+}
+
+// Must be called with prefetch_lock held.
+static void ClearPrefetchedScene(void)
+{
+	__FinishSceneLoader(&prefetch_loader);
+	ClearPrefetchedSceneTexture();
+	ClearPrefetchedSceneFont();
+	ClearPrefetchedSceneSound();
+	ClearPrefetchedSceneMovie();
+	has_prefetched_scene = sfFalse;
+}
 
 void InitResourcesManager(const char* resource_directory_)
 {
 	strcpy_s(resource_directory, MAX_PATH_SIZE, resource_directory_);
+	NEW_CHAR(pack_path, MAX_PATH_SIZE)
+		strcpy_s(pack_path, MAX_PATH_SIZE, resource_directory);
+	strcat_s(pack_path, MAX_PATH_SIZE, PACK_FILE_EXTENSION);
+	MountPackFile(pack_path, resource_directory);
+	LoadResourceManifest(resource_directory);
+	CheckResourceIds(resource_directory);
 	InitTextureManager();
 	InitFontManager();
 	InitSoundManager();
 	InitMovieManager();
 }
 
+void PrefetchScene(const char* scene_name)
+{
+	AcquireSRWLockExclusive(&prefetch_lock);
+	if (!has_prefetched_scene || strcmp(prefetch_scene_name, scene_name) != 0)
+	{
+		ClearPrefetchedScene();
+		__FinishSceneLoader(&scene_loader);
+		strcpy_s(prefetch_scene_name, MAX_PATH_SIZE, scene_name);
+		has_prefetched_scene = sfTrue;
+		printf_d("--------------------Starting prefetching the %s scene--------------------\n\n", scene_name);
+		StartSceneLoader(scene_name, &prefetch_loader, sfTrue);
+	}
+	ReleaseSRWLockExclusive(&prefetch_lock);
+}
+
 void LoadScene(const char* scene_name)
 {
+	AcquireSRWLockExclusive(&prefetch_lock);
+	if (has_prefetched_scene && strcmp(prefetch_scene_name, scene_name) == 0)
+	{
+		printf_d("--------------------Waiting for the prefetched %s scene--------------------\n\n", scene_name);
+		__FinishSceneLoader(&prefetch_loader);
+		__FinishSceneLoader(&scene_loader);
+		CommitPrefetchedSceneTexture();
+		CommitPrefetchedSceneFont();
+		CommitPrefetchedSceneSound();
+		CommitPrefetchedSceneMovie();
+		has_prefetched_scene = sfFalse;
+		ReleaseSRWLockExclusive(&prefetch_lock);
+		return;
+	}
+	if (has_prefetched_scene)
+		ClearPrefetchedScene();
+	__FinishSceneLoader(&scene_loader);
+
 	printf_d("--------------------Starting loading the %s scene--------------------\n\n", scene_name);
-	LoadSceneTexture(scene_name,&__TextureProgressBar);
-	LoadSceneFont(scene_name, &__FontProgressBar);
-	LoadSceneSound(scene_name, &__SoundProgressBar, &__MusicProgressBar);
-	LoadSceneMovie(scene_name, &__MovieProgressBar);
-	printf_d("--------------------Finish loading the %s scene--------------------\n\n", scene_name);
+	StartSceneLoader(scene_name, &scene_loader, sfFalse);
+	if (__WaitCriticalSceneLoads(&scene_loader))
+		printf_d("--------------------Finish loading the critical assets of the %s scene--------------------\n\n", scene_name);
+	else
+	{
+		// Superseded by another state change, the loader threads stop at the next file.
+		__FinishSceneLoader(&scene_loader);
+		ClearSceneTexture();
+		ClearSceneFont();
+		ClearSceneSound();
+		ClearSceneMovie();
+		printf_d("--------------------Cancelled loading the %s scene--------------------\n\n", scene_name);
+	}
+	ReleaseSRWLockExclusive(&prefetch_lock);
+}
+
+void CancelSceneLoad(void)
+{
+	CancelLoad(&scene_loader.m_cancel_token);
+}
+
+void DeclareCriticalAsset(const char* scene_name, const char* asset_name)
+{
+	AcquireSRWLockExclusive(&critical_asset_lock);
+	if (!HasCriticalAsset(scene_name, asset_name))
+	{
+		if (critical_asset_list == NULL)
+			critical_asset_list = STD_LIST_CREATE(CriticalAsset, 0);
+		CriticalAsset critical_asset;
+		strcpy_s(critical_asset.m_scene, MAX_PATH_SIZE, scene_name);
+		strcpy_s(critical_asset.m_name, MAX_PATH_SIZE, asset_name);
+		critical_asset_list->push_back(critical_asset_list, &critical_asset);
+	}
+	ReleaseSRWLockExclusive(&critical_asset_lock);
+}
+
+void SetResourceLoadingMode(ResourceLoadingMode mode)
+{
+	resource_loading_mode = mode;
+}
+
+void SetHeadlessResources(sfBool enable)
+{
+	is_headless_resources = enable;
 }
 
 void DestroyResourcesManager(void)
 {
+	StopFileWatcher();
+	__WaitAsyncLoads();
+	AcquireSRWLockExclusive(&prefetch_lock);
+	ClearPrefetchedScene();
+	__FinishSceneLoader(&scene_loader);
+	ReleaseSRWLockExclusive(&prefetch_lock);
+	if (critical_asset_list != NULL)
+		critical_asset_list->destroy(&critical_asset_list);
 	DestroyTexturesManager();
 	DestroyFontsManager();
 	DestroySoundsManager();
 	DestroyMoviesManager();
+	DestroyResourceManifest();
+	UnmountPackFile();
 }
 
 float GetLoadingValue()
 {
-	return (__TextureProgressBar + __FontProgressBar + __MusicProgressBar + __SoundProgressBar + __MovieProgressBar) / 5.f;
+	LONG64 total = InterlockedCompareExchange64(&scene_loading_progress.m_total_bytes, 0, 0);
+	LONG64 loaded = InterlockedCompareExchange64(&scene_loading_progress.m_loaded_bytes, 0, 0);
+	if (total <= 0 || loaded >= total)
+		return 1.f;
+	return (float)((double)loaded / (double)total);
 }
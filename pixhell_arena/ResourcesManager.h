@@ -26,6 +26,10 @@
 #include "FontManager.h"
 #include "MovieManager.h"
 #include "SpriteManager.h"
+#include "ResourceManifest.h"
+#include "ResourceIdBuilder.h"
+#include "PackFile.h"
+#include "FileWatcher.h"
 
 /**
  * @file resourcesmanager.h
@@ -38,13 +42,62 @@
   */
 void InitResourcesManager(const char* resource_directory_);
 
+/**
+ * @brief Sets how the global resources are loaded by the next InitResourcesManager, RESOURCE_LOADING_EAGER by default.
+ * In the lazy modes only the placeholders are loaded up front, every other global resource is loaded by the first Get asking for it.
+ * @param mode The loading mode of the global resources.
+ *
+ * @note In RESOURCE_LOADING_ASYNC the Get functions return the placeholder until the resource is loaded, so callers keeping the returned pointer keep the placeholder.
+ * Such callers wait for IsTextureLoadedById before keeping a texture, or take it again once it is loaded.
+ */
+void SetResourceLoadingMode(ResourceLoadingMode mode);
+
+/**
+ * @brief Loads the next resources without a graphics context, for StartGameHeadless on a machine without a GPU. Must be called before InitResourcesManager.
+ * Textures keep their decoded sfImage and fonts their file bytes, no sfTexture, sfFont or movie is created.
+ * The texture and font getters then return NULL, which the sprites and texts of the states ignore.
+ * @param enable sfTrue to load the resources headless, sfFalse by default.
+ */
+void SetHeadlessResources(sfBool enable);
+
 /**
  * @brief Loads all the resources for a specific scene.
  * This function typically loads textures, sounds, fonts, movies, and other resources required for the scene.
+ * The files are loaded critical first, then biggest first, by a pool of up to MAX_THREAD threads.
  * @param scene_name Name of the scene whose resources should be loaded.
+ *
+ * @note If the scene declared critical assets with DeclareCriticalAsset, only those are loaded when this returns.
+ * The other resources stream in the background, their Get functions return the placeholder until they are loaded.
+ * @note The load uses the token set with SetThreadCancelToken, a cancelled load stops at the next file and releases the scene resources.
  */
 void LoadScene(const char* scene_name);
 
+/**
+ * @brief Stops the files of the last LoadScene still streaming in the background at the next file, e.g. when the state changes.
+ * The next LoadScene waits for the loader to stop instead of for the rest of the previous scene.
+ */
+void CancelSceneLoad(void);
+
+/**
+ * @brief Declares a resource the scene needs for its first frame, so LoadScene returns without waiting for the rest of the scene.
+ * A scene without any declared critical asset is entirely critical. Declaring the same asset twice does nothing.
+ * @param scene_name Name of the scene, as given to LoadScene.
+ * @param asset_name Name of the resource file without its extension, compared without case.
+ */
+void DeclareCriticalAsset(const char* scene_name, const char* asset_name);
+
+/**
+ * @brief Starts loading the resources of a scene in the background, while the current scene keeps its own.
+ * The next LoadScene of the same scene only waits for what is left to load, then swaps the prefetched resources in.
+ * Prefetching another scene, or loading another one, drops the prefetched resources.
+ * @param scene_name Name of the scene whose resources should be prefetched.
+ *
+ * @note The files are loaded by the scene loader tasks of the thread manager, this thread only queues them.
+ * It still blocks until a LoadScene on another thread has its critical assets, until a prefetch of a different scene is dropped,
+ * and until the streamed resources of the current scene are loaded.
+ */
+void PrefetchScene(const char* scene_name);
+
 /**
  * @brief Destroys the resources manager and releases all allocated resources.
  * This function is called when shutting down the application to free up memory and unload resources.
@@ -53,6 +106,7 @@ void DestroyResourcesManager(void);
 
 /**
  * @brief Retrieves the current loading progress of the resources manager.
+ * The progress is weighted by file size, so a big sprite sheet counts more than a small sound.
  * @return A float value representing the percentage of resources loaded (0.0 to 1.0).
  */
 float GetLoadingValue();
@@ -1,9 +1,65 @@
 #include "Game.h"
 #include "LoadingState.h"
+#include "JobScheduler.h"
 
 
-int main(void)
-{              
+int main(int argc, char** argv)
+{
+	unsigned int frame_rate = 0;
+	sfBool is_hot_reload_enabled = sfFalse;
+	sfBool is_headless = sfFalse;
+	unsigned int headless_frame_count = 0;
+	const char* headless_state = "InGame";
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--benchmark-parallel-for") == 0)
+		{
+			RunParallelForBenchmark(100000);
+			return 0;
+		}
+		if (strcmp(argv[i], "--benchmark-filesystem") == 0)
+		{
+			fs_run_benchmark("../FileSystemBenchmark", 10000);
+			return 0;
+		}
+		if (strcmp(argv[i], "--build-manifest") == 0)
+			return BuildResourceManifest("../Ressources") ? 0 : 1;
+		if (strcmp(argv[i], "--build-pack") == 0)
+			return BuildPackFile("../Ressources", "../Ressources" PACK_FILE_EXTENSION) ? 0 : 1;
+		if (strcmp(argv[i], "--build-resource-ids") == 0)
+			return BuildResourceIds("../Ressources", "ResourceIds") ? 0 : 1;
+		if (strcmp(argv[i], "--hot-reload") == 0)
+			is_hot_reload_enabled = sfTrue;
+		if (strcmp(argv[i], "--lazy") == 0)
+			SetResourceLoadingMode(RESOURCE_LOADING_LAZY);
+		if (strcmp(argv[i], "--async-load") == 0)
+			SetResourceLoadingMode(RESOURCE_LOADING_ASYNC);
+		if (strcmp(argv[i], "--pipelined") == 0)
+			SetPipelinedMode(sfTrue);
+		if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+			frame_rate = (unsigned int)strtoul(argv[++i], NULL, 10);
+		if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc)
+		{
+			is_headless = sfTrue;
+			headless_frame_count = (unsigned int)strtoul(argv[++i], NULL, 10);
+			// The state name is optional, a flag following the frame count is not one.
+			if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0)
+				headless_state = argv[++i];
+		}
+	}
+
+	if (is_headless)
+	{
+		SetHeadlessResources(sfTrue);
+		InitResourcesManager("../Ressources");
+		StartGameHeadless(CreateHeadlessWindowManager(1920, 1080), headless_state, headless_frame_count);
+		return 0;
+	}
+
 	InitResourcesManager("../Ressources");
-	StartGame(CreateWindowManager(1920, 1080, "BreakerEngine", sfDefaultStyle, NULL), "MainMenu", "Loading", &ResetLoadingState);
+	if (is_hot_reload_enabled)
+		StartFileWatcher("../Ressources");
+	WindowManager* window_manager = CreateWindowManager(1920, 1080, "BreakerEngine", sfDefaultStyle, NULL);
+	window_manager->SetTargetFrameRate(window_manager, frame_rate);
+	StartGame(window_manager, "MainMenu", "Loading", &ResetLoadingState);
 }
\ No newline at end of file
@@ -0,0 +1,461 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "SpriteSheet.h"
+#include "TextureCache.h"
+#include "PackFile.h"
+#include "MemoryManagement.h"
+#include <ctype.h>
+
+#define SPRITE_SHEET_MAX_BLOCK_LINES 8
+
+typedef struct SpriteSheetHeader SpriteSheetHeader;
+struct SpriteSheetHeader
+{
+	char m_magic[8];
+	unsigned int m_version;
+	unsigned int m_section_count;
+	unsigned long long m_source_size;
+	unsigned long long m_source_mtime;
+	char m_source_path[MAX_PATH_SIZE];
+};
+
+typedef struct SheetSection SheetSection;
+struct SheetSection
+{
+	char m_name[SPRITE_SHEET_MAX_NAME_SIZE];
+	unsigned int m_width;
+	unsigned int m_height;
+	stdList* m_frames;
+};
+
+// A section in the sidecar, followed by its frames.
+typedef struct SheetSectionHeader SheetSectionHeader;
+struct SheetSectionHeader
+{
+	char m_name[SPRITE_SHEET_MAX_NAME_SIZE];
+	unsigned int m_width;
+	unsigned int m_height;
+	unsigned int m_frame_count;
+};
+
+struct SpriteSheet_Data
+{
+	SpriteFrame* m_frames;
+	int m_frame_count;
+	ResourceRegistry* m_registry; // The scene resource of an entry is its SpriteFrame.
+};
+
+// The sections of every descriptor of a directory, parsed by the first sheet loaded from it.
+typedef struct SheetDirectory SheetDirectory;
+struct SheetDirectory
+{
+	char m_path[MAX_PATH_SIZE];
+	stdList* m_sections;
+};
+
+static stdList* sheet_directories;
+static SRWLOCK sheet_directory_lock = SRWLOCK_INIT;
+
+
+
+// Size and modification time of a loose file, packed descriptors have no sidecar.
+static sfBool GetSourceAttributes(const char* path, unsigned long long* size, unsigned long long* mtime)
+{
+	size_t packed_size = 0;
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (GetPackedFile(path, &packed_size) || !GetFileAttributesExA(path, GetFileExInfoStandard, &data))
+		return sfFalse;
+	*size = ((unsigned long long)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+	*mtime = ((unsigned long long)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+	return sfTrue;
+}
+
+// The sidecar is named after the FNV-1a hash of the normalized descriptor path, like the texture cache files.
+static void BuildSidecarPath(char* sidecar_path, const char* path)
+{
+	unsigned long long hash = 14695981039346656037ull;
+	for (const char* c = path; *c; c++)
+	{
+		char normalized = *c == '/' ? '\\' : (char)tolower((unsigned char)*c);
+		hash = (hash ^ (unsigned char)normalized) * 1099511628211ull;
+	}
+	sprintf_s(sidecar_path, MAX_PATH_SIZE, "%s%s\\%016llx%s", resource_directory, TEXTURE_CACHE_EXTENSION, hash, SPRITE_SHEET_SIDECAR_EXTENSION);
+}
+
+static void DestroySections(stdList** sections)
+{
+	stdList* list = *sections;
+	for (int i = 0; i < list->size(list); i++)
+		STD_GETDATA(list, SheetSection, i)->m_frames->destroy(&STD_GETDATA(list, SheetSection, i)->m_frames);
+	list->destroy(sections);
+}
+
+static SheetSection* AddSection(stdList* sections, const char* name)
+{
+	SheetSection section = { 0 };
+	strncpy_s(section.m_name, SPRITE_SHEET_MAX_NAME_SIZE, name, _TRUNCATE);
+	section.m_frames = STD_LIST_CREATE(SpriteFrame, 0);
+	sections->push_back(sections, &section);
+	return sections->getData(sections, sections->size(sections) - 1);
+}
+
+// Numbers are written with a space between the thousands, like "10 235".
+static sfBool ParseNumber(const char* line, int* value)
+{
+	sfBool has_digit = sfFalse;
+	*value = 0;
+	for (; *line; line++)
+	{
+		if (isdigit((unsigned char)*line))
+		{
+			*value = *value * 10 + (*line - '0');
+			has_digit = sfTrue;
+		}
+		else if (!isspace((unsigned char)*line))
+			return sfFalse;
+	}
+	return has_digit;
+}
+
+static sfBool ParseSize(char* line, int* width, int* height)
+{
+	char* separator = strchr(line, 'x');
+	if (!separator)
+		return sfFalse;
+	*separator = '\0';
+	sfBool is_size = ParseNumber(line, width) && ParseNumber(separator + 1, height);
+	*separator = 'x';
+	return is_size;
+}
+
+static void AddFrame(SheetSection* section, const char* name, sfIntRect rect)
+{
+	SpriteFrame frame = { .m_rect = rect };
+	strncpy_s(frame.m_name, SPRITE_SHEET_MAX_NAME_SIZE, name, _TRUNCATE);
+	int use_count = 1;
+	for (int i = 0; i < section->m_frames->size(section->m_frames); i++)
+		if (_stricmp(STD_GETDATA(section->m_frames, SpriteFrame, i)->m_name, frame.m_name) == 0)
+			use_count++;
+	if (use_count > 1)
+	{
+		NEW_CHAR(suffix, 16)
+			sprintf_s(suffix, 16, "_%d", use_count);
+		frame.m_name[SPRITE_SHEET_MAX_NAME_SIZE - strlen(suffix) - 1] = '\0';
+		strcat_s(frame.m_name, SPRITE_SHEET_MAX_NAME_SIZE, suffix);
+	}
+	section->m_frames->push_back(section->m_frames, &frame);
+	if ((unsigned int)(rect.left + rect.width) > section->m_width)
+		section->m_width = (unsigned int)(rect.left + rect.width);
+	if ((unsigned int)(rect.top + rect.height) > section->m_height)
+		section->m_height = (unsigned int)(rect.top + rect.height);
+}
+
+// Returns the y the next sprite starts at.
+static int ParseBlock(stdList* sections, const char* descriptor_name, char** lines, int line_count, int cursor)
+{
+	if (line_count == 1)
+	{
+		AddSection(sections, lines[0]);
+		return 0;
+	}
+	sfIntRect rect = { 0, cursor, 0, 0 };
+	sfBool has_size = sfFalse;
+	for (int i = 1; i < line_count; i++)
+	{
+		int value = 0;
+		if (!has_size && ParseSize(lines[i], &rect.width, &rect.height))
+			has_size = sfTrue;
+		else if (ParseNumber(lines[i], &value))
+			rect.top = has_size ? value - rect.height : value;
+	}
+	if (!has_size || rect.top < 0)
+	{
+		printf_d("Sprite sheet descriptor block %s ignored, it has no valid size\n", lines[0]);
+		return cursor;
+	}
+	if (!sections->size(sections))
+		AddSection(sections, descriptor_name);
+	AddFrame(sections->getData(sections, sections->size(sections) - 1), lines[0], rect);
+	return rect.top + rect.height;
+}
+
+static stdList* ParseDescriptor(char* text, const char* descriptor_name)
+{
+	stdList* sections = STD_LIST_CREATE(SheetSection, 0);
+	char* lines[SPRITE_SHEET_MAX_BLOCK_LINES];
+	int line_count = 0;
+	int cursor = 0;
+	char* line = text;
+	while (line)
+	{
+		char* next_line = strchr(line, '\n');
+		if (next_line)
+			*next_line++ = '\0';
+		size_t length = strlen(line);
+		while (length && isspace((unsigned char)line[length - 1]))
+			line[--length] = '\0';
+
+		if (length && line_count < SPRITE_SHEET_MAX_BLOCK_LINES)
+			lines[line_count++] = line;
+		if ((!length || !next_line) && line_count)
+		{
+			cursor = ParseBlock(sections, descriptor_name, lines, line_count, cursor);
+			line_count = 0;
+		}
+		line = next_line;
+	}
+	return sections;
+}
+
+static stdList* ReadSidecar(const char* path, unsigned long long source_size, unsigned long long source_mtime)
+{
+	NEW_CHAR(sidecar_path, MAX_PATH_SIZE)
+		BuildSidecarPath(sidecar_path, path);
+	fs_mapped_file mapped_file;
+	if (!fs_map_file(sidecar_path, &mapped_file))
+		return NULL;
+
+	const unsigned char* data = mapped_file.m_data;
+	const unsigned char* end = data + mapped_file.m_size;
+	const SpriteSheetHeader* header = (const SpriteSheetHeader*)data;
+	stdList* sections = NULL;
+	if (mapped_file.m_size >= sizeof(SpriteSheetHeader) && memcmp(header->m_magic, SPRITE_SHEET_MAGIC, sizeof(SPRITE_SHEET_MAGIC)) == 0 && header->m_version == SPRITE_SHEET_VERSION
+		&& header->m_source_size == source_size && header->m_source_mtime == source_mtime && fs_path_equals(header->m_source_path, path))
+	{
+		sections = STD_LIST_CREATE(SheetSection, 0);
+		data += sizeof(SpriteSheetHeader);
+		for (unsigned int i = 0; i < header->m_section_count && sections; i++)
+		{
+			SheetSectionHeader stored;
+			if ((size_t)(end - data) < sizeof(SheetSectionHeader))
+			{
+				DestroySections(&sections);
+				break;
+			}
+			memcpy(&stored, data, sizeof(SheetSectionHeader));
+			data += sizeof(SheetSectionHeader);
+			size_t frame_count = stored.m_frame_count;
+			if ((size_t)(end - data) / sizeof(SpriteFrame) < frame_count)
+			{
+				DestroySections(&sections);
+				break;
+			}
+			stored.m_name[SPRITE_SHEET_MAX_NAME_SIZE - 1] = '\0';
+			SheetSection* section = AddSection(sections, stored.m_name);
+			section->m_width = stored.m_width;
+			section->m_height = stored.m_height;
+			for (size_t j = 0; j < frame_count; j++, data += sizeof(SpriteFrame))
+				section->m_frames->push_back(section->m_frames, (void*)data);
+		}
+	}
+	fs_unmap_file(&mapped_file);
+	return sections;
+}
+
+static void WriteSidecar(const char* path, stdList* sections, unsigned long long source_size, unsigned long long source_mtime)
+{
+	NEW_CHAR(cache_directory, MAX_PATH_SIZE)
+		strcpy_s(cache_directory, MAX_PATH_SIZE, resource_directory);
+	strcat_s(cache_directory, MAX_PATH_SIZE, TEXTURE_CACHE_EXTENSION);
+	if (fs_status(cache_directory) == FS_TYPE_NONE)
+		fs_create_directory(cache_directory);
+
+	SpriteSheetHeader header = { .m_magic = SPRITE_SHEET_MAGIC, .m_version = SPRITE_SHEET_VERSION, .m_source_size = source_size, .m_source_mtime = source_mtime };
+	header.m_section_count = (unsigned int)sections->size(sections);
+	strcpy_s(header.m_source_path, MAX_PATH_SIZE, path);
+
+	// Written aside then moved over the sidecar, so another process never reads it half written.
+	NEW_CHAR(sidecar_path, MAX_PATH_SIZE)
+		BuildSidecarPath(sidecar_path, path);
+	NEW_CHAR(temporary_path, MAX_PATH_SIZE)
+		sprintf_s(temporary_path, MAX_PATH_SIZE, "%s.%lu.tmp", sidecar_path, GetCurrentProcessId());
+	FILE* file = NULL;
+	if (fopen_s(&file, temporary_path, "wb") != 0 || !file)
+		return;
+	sfBool is_written = fwrite(&header, sizeof(SpriteSheetHeader), 1, file) == 1;
+	for (int i = 0; i < sections->size(sections) && is_written; i++)
+	{
+		const SheetSection* section = STD_GETDATA(sections, SheetSection, i);
+		stdList* frames = section->m_frames;
+		SheetSectionHeader stored = { .m_width = section->m_width, .m_height = section->m_height, .m_frame_count = (unsigned int)frames->size(frames) };
+		strcpy_s(stored.m_name, SPRITE_SHEET_MAX_NAME_SIZE, section->m_name);
+		is_written = fwrite(&stored, sizeof(SheetSectionHeader), 1, file) == 1;
+		for (int j = 0; j < frames->size(frames) && is_written; j++)
+			is_written = fwrite(frames->getData(frames, j), sizeof(SpriteFrame), 1, file) == 1;
+	}
+	fclose(file);
+	if (!is_written || !MoveFileExA(temporary_path, sidecar_path, MOVEFILE_REPLACE_EXISTING))
+		remove(temporary_path);
+}
+
+static stdList* LoadDescriptor(const char* path)
+{
+	unsigned long long source_size = 0, source_mtime = 0;
+	sfBool has_sidecar = GetSourceAttributes(path, &source_size, &source_mtime);
+	stdList* sections = has_sidecar ? ReadSidecar(path, source_size, source_mtime) : NULL;
+	if (sections)
+		return sections;
+
+	fs_mapped_file mapped_file;
+	size_t size = 0;
+	const void* data = MapResourceFile(path, &size, &mapped_file);
+	if (!data)
+		return NULL;
+	char* text = calloc_d(char, size + 1);
+	assert(text);
+	memcpy(text, data, size);
+	fs_unmap_file(&mapped_file);
+	NEW_CHAR(descriptor_name, MAX_PATH_SIZE)
+		fs_stem(path, descriptor_name, MAX_PATH_SIZE);
+	sections = ParseDescriptor(text, descriptor_name);
+	free_d(text);
+	if (has_sidecar)
+		WriteSidecar(path, sections, source_size, source_mtime);
+	return sections;
+}
+
+static sfBool GetRect(SpriteSheet* sheet, const char* name, sfIntRect* rect)
+{
+	ResourceRegistry* registry = sheet->_Data->m_registry;
+	ResourceEntry* entry = registry->GetEntry(registry, registry->GetHandle(registry, name, NULL));
+	const SpriteFrame* frame = entry ? entry->m_scene_resource : NULL;
+	if (frame)
+		*rect = frame->m_rect;
+	return frame ? sfTrue : sfFalse;
+}
+
+static int GetFrameCount(SpriteSheet* sheet)
+{
+	return sheet->_Data->m_frame_count;
+}
+
+static const SpriteFrame* GetFrame(SpriteSheet* sheet, int index)
+{
+	assert(index >= 0 && index < sheet->_Data->m_frame_count);
+	return &sheet->_Data->m_frames[index];
+}
+
+static void DestroySpriteSheet(SpriteSheet** sheet)
+{
+	SpriteSheet_Data* data = (*sheet)->_Data;
+	data->m_registry->Destroy(&data->m_registry);
+	if (data->m_frames)
+		free_d(data->m_frames);
+	free_d(data);
+	free_d(*sheet);
+	*sheet = NULL;
+}
+
+static SpriteSheet* CreateSpriteSheet(stdList* frames)
+{
+	SpriteSheet* tmp = calloc_d(SpriteSheet, 1);
+	SpriteSheet_Data* tmp_data = calloc_d(SpriteSheet_Data, 1);
+	assert(tmp);
+	assert(tmp_data);
+
+	tmp_data->m_frame_count = frames->size(frames);
+	tmp_data->m_frames = tmp_data->m_frame_count ? calloc_d(SpriteFrame, tmp_data->m_frame_count) : NULL;
+	tmp_data->m_registry = CreateResourceRegistry();
+	for (int i = 0; i < tmp_data->m_frame_count; i++)
+	{
+		tmp_data->m_frames[i] = *STD_GETDATA(frames, SpriteFrame, i);
+		tmp_data->m_registry->AddSceneResource(tmp_data->m_registry, tmp_data->m_frames[i].m_name, &tmp_data->m_frames[i]);
+	}
+
+	tmp->_Data = tmp_data;
+
+	tmp->GetRect = &GetRect;
+	tmp->GetFrameCount = &GetFrameCount;
+	tmp->GetFrame = &GetFrame;
+	tmp->Destroy = &DestroySpriteSheet;
+
+	return tmp;
+}
+
+// Must be called with sheet_directory_lock held exclusively. The sections of every descriptor are merged, the frame lists move to the directory.
+static SheetDirectory* LoadSheetDirectory(const char* directory)
+{
+	SheetDirectory sheet_directory = { 0 };
+	strcpy_s(sheet_directory.m_path, MAX_PATH_SIZE, directory);
+	sheet_directory.m_sections = STD_LIST_CREATE(SheetSection, 0);
+	stdList* descriptors = SearchFilesInfos(directory, SPRITE_SHEET_DESCRIPTOR_EXTENSION);
+	for (int i = 0; i < descriptors->size(descriptors); i++)
+	{
+		stdList* sections = LoadDescriptor(STD_GETDATA(descriptors, FilesInfo, i)->m_path);
+		if (!sections)
+			continue;
+		for (int j = 0; j < sections->size(sections); j++)
+			sheet_directory.m_sections->push_back(sheet_directory.m_sections, sections->getData(sections, j));
+		sections->destroy(&sections);
+	}
+	descriptors->destroy(&descriptors);
+
+	if (sheet_directories == NULL)
+		sheet_directories = STD_LIST_CREATE(SheetDirectory, 0);
+	sheet_directories->push_back(sheet_directories, &sheet_directory);
+	return sheet_directories->getData(sheet_directories, sheet_directories->size(sheet_directories) - 1);
+}
+
+SpriteSheet* LoadSpriteSheet(const char* texture_path, unsigned int width, unsigned int height)
+{
+	NEW_CHAR(directory, MAX_PATH_SIZE)
+		fs_view_copy(fs_view_parent(fs_view(texture_path)), directory, MAX_PATH_SIZE);
+	NEW_CHAR(name, MAX_PATH_SIZE)
+		fs_stem(texture_path, name, MAX_PATH_SIZE);
+
+	SpriteSheet* sheet = NULL;
+	AcquireSRWLockExclusive(&sheet_directory_lock);
+	SheetDirectory* sheet_directory = NULL;
+	for (int i = 0; sheet_directories != NULL && i < sheet_directories->size(sheet_directories) && !sheet_directory; i++)
+		if (fs_path_equals(STD_GETDATA(sheet_directories, SheetDirectory, i)->m_path, directory))
+			sheet_directory = sheet_directories->getData(sheet_directories, i);
+	if (!sheet_directory)
+		sheet_directory = LoadSheetDirectory(directory);
+
+	stdList* sections = sheet_directory->m_sections;
+	for (int i = 0; i < sections->size(sections) && !sheet; i++)
+	{
+		const SheetSection* section = STD_GETDATA(sections, SheetSection, i);
+		if (_stricmp(section->m_name, name) != 0 || !section->m_frames->size(section->m_frames))
+			continue;
+		if (section->m_width <= width && section->m_height <= height)
+			sheet = CreateSpriteSheet(section->m_frames);
+		else
+			printf_d("Sprite sheet %s is %ux%u, its descriptor needs %ux%u, no sprite loaded\n", texture_path, width, height, section->m_width, section->m_height);
+	}
+	ReleaseSRWLockExclusive(&sheet_directory_lock);
+	return sheet;
+}
+
+void ClearSpriteSheetCache(void)
+{
+	AcquireSRWLockExclusive(&sheet_directory_lock);
+	if (sheet_directories != NULL)
+	{
+		for (int i = 0; i < sheet_directories->size(sheet_directories); i++)
+			DestroySections(&STD_GETDATA(sheet_directories, SheetDirectory, i)->m_sections);
+		sheet_directories->destroy(&sheet_directories);
+		sheet_directories = NULL;
+	}
+	ReleaseSRWLockExclusive(&sheet_directory_lock);
+}
@@ -0,0 +1,160 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "Tools.h"
+#include "ResourceRegistry.h"
+
+/**
+ * @file spritesheet.h
+ * @brief This file defines the SpriteSheet structure, which names the rectangles of a sprite sheet from its descriptor file.
+ *
+ * A descriptor is a text file next to the sheets it describes, made of blocks separated by empty lines.
+ * A block is the name of a sprite, optionally the y of its top, its size as WIDTHxHEIGHT, then optionally the y of its bottom.
+ * Without a top, a sprite starts where the previous one ends, sprites are always on the left side of the sheet.
+ * A block made of a single line starts a new section and names the sheet it describes, like "InGameP2" in InGame.txt.
+ * The name is the file name of the sheet without its extension, compared without case. Sprites before the first section describe the sheet named like the descriptor.
+ * The descriptors of a directory are parsed once, by the first sheet loaded from it, see ClearSpriteSheetCache.
+ * A name used twice in a section gets a suffix on its next uses: "Coop", then "Coop_2".
+ *
+ * The parsed descriptor is written in a binary sidecar in the texture cache directory, see TEXTURE_CACHE_EXTENSION,
+ * and read back from it as long as the descriptor does not change. The sidecar is written aside then moved in place.
+ *
+ * @code
+ * SpriteSheet* sheet = LoadSpriteSheet("../Ressources/ALL/Textures/Menu_Spritesheet.png", 1920, 14310);
+ * sfIntRect rect;
+ * if (sheet && sheet->GetRect(sheet, "Selection Star", &rect))
+ *     sfSprite_setTextureRect(sprite, rect);
+ * @endcode
+ */
+
+/**
+ * @def SPRITE_SHEET_DESCRIPTOR_EXTENSION
+ * @brief Extension of the descriptor files.
+ */
+#define SPRITE_SHEET_DESCRIPTOR_EXTENSION "txt"
+
+/**
+ * @def SPRITE_SHEET_SIDECAR_EXTENSION
+ * @brief Extension of the binary sidecar files.
+ */
+#define SPRITE_SHEET_SIDECAR_EXTENSION ".sheet"
+
+/**
+ * @def SPRITE_SHEET_MAGIC
+ * @brief Magic number at the start of every sidecar file.
+ */
+#define SPRITE_SHEET_MAGIC "PXHSHT"
+
+/**
+ * @def SPRITE_SHEET_VERSION
+ * @brief Version of the sidecar file format. A sidecar with another version is stale.
+ */
+#define SPRITE_SHEET_VERSION 2
+
+/**
+ * @def SPRITE_SHEET_MAX_NAME_SIZE
+ * @brief Size of the buffer of a sprite name, longer names are truncated.
+ */
+#define SPRITE_SHEET_MAX_NAME_SIZE 64
+
+/**
+ * @typedef SpriteFrame
+ * @brief A named rectangle of a sprite sheet.
+ */
+typedef struct SpriteFrame SpriteFrame;
+
+/**
+ * @struct SpriteFrame
+ * @brief A named rectangle of a sprite sheet, as written in the sidecar.
+ */
+struct SpriteFrame
+{
+    char m_name[SPRITE_SHEET_MAX_NAME_SIZE]; /**< Name of the sprite. */
+    sfIntRect m_rect;                        /**< Rectangle of the sprite in the sheet. */
+};
+
+/**
+ * @typedef SpriteSheet_Data
+ * @brief Opaque structure that holds the internal data of the sprite sheet.
+ */
+typedef struct SpriteSheet_Data SpriteSheet_Data;
+
+/**
+ * @typedef SpriteSheet
+ * @brief The named rectangles of a sprite sheet.
+ */
+typedef struct SpriteSheet SpriteSheet;
+
+/**
+ * @struct SpriteSheet
+ * @brief Contains function pointers to look the rectangles of a sheet up by name. Every function can be called from any thread.
+ */
+struct SpriteSheet
+{
+    SpriteSheet_Data* _Data; /**< Internal data of the sprite sheet. */
+
+    /**
+     * @brief Finds the rectangle of a sprite, with a single hash lookup.
+     * @param sheet Pointer to the SpriteSheet object.
+     * @param name Name of the sprite, compared without case.
+     * @param rect Receives the rectangle of the sprite in the sheet.
+     * @return sfTrue if the sheet has a sprite of that name, sfFalse otherwise.
+     */
+    sfBool (*GetRect)(SpriteSheet* sheet, const char* name, sfIntRect* rect);
+
+    /**
+     * @brief Retrieves the number of sprites of the sheet.
+     * @param sheet Pointer to the SpriteSheet object.
+     * @return The number of sprites.
+     */
+    int (*GetFrameCount)(SpriteSheet* sheet);
+
+    /**
+     * @brief Retrieves a sprite by its position in the descriptor.
+     * @param sheet Pointer to the SpriteSheet object.
+     * @param index Index of the sprite, lower than GetFrameCount.
+     * @return The sprite.
+     */
+    const SpriteFrame* (*GetFrame)(SpriteSheet* sheet, int index);
+
+    /**
+     * @brief Destroys the sprite sheet.
+     * @param sheet Pointer to the pointer of the SpriteSheet object to destroy.
+     */
+    void (*Destroy)(SpriteSheet** sheet);
+};
+
+/**
+ * @brief Finds the descriptor section named after a sheet in the descriptors of its directory and builds its index.
+ * @param texture_path Path of the sheet texture file.
+ * @param width Width of the sheet in pixels, every sprite must fit in it.
+ * @param height Height of the sheet in pixels, every sprite must fit in it.
+ * @return The sprite sheet, or NULL if no descriptor describes the texture.
+ */
+SpriteSheet* LoadSpriteSheet(const char* texture_path, unsigned int width, unsigned int height);
+
+/**
+ * @brief Forgets the parsed descriptors of every directory, the next LoadSpriteSheet of a directory parses them again.
+ * Called by the file watcher when a descriptor changes and when the texture manager is destroyed.
+ */
+void ClearSpriteSheetCache(void);
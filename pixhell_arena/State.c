@@ -5,6 +5,27 @@
 
 
 stdList* stateList = NULL;
+stdList* stateSnapshotList = NULL;
+stdList* stateSceneList = NULL;
+stdList* stateInitStepList = NULL;
+
+typedef struct
+{
+	char name[256];
+	StateSnapshotInfo info;
+} StateSnapshotEntry;
+
+typedef struct
+{
+	char name[256];
+	char scene_name[256];
+} StateSceneEntry;
+
+typedef struct
+{
+	char name[256];
+	sfBool(*init_step)(WindowManager*);
+} StateInitStepEntry;
 
 DECLARE_BLANK_STATE(NULLSTATE)
 
@@ -35,3 +56,77 @@ StateInfo GetState(const char* name)
 	};
 }
 
+void __RegisterStateSnapshot(const char* name, StateSnapshotInfo snapshot_info)
+{
+	if (stateSnapshotList == NULL)
+	{
+		stateSnapshotList = STD_LIST_CREATE(StateSnapshotEntry, 0);
+	}
+	StateSnapshotEntry entry;
+	strcpy_s(entry.name, 256, name);
+	entry.info = snapshot_info;
+	stateSnapshotList->push_back(stateSnapshotList, &entry);
+}
+
+sfBool GetStateSnapshot(const char* name, StateSnapshotInfo* snapshot_info)
+{
+	if (stateSnapshotList == NULL)
+		return sfFalse;
+
+	FOR_EACH_LIST(stateSnapshotList, StateSnapshotEntry, i, it,
+		if (strcmp(name, it->name) == 0)
+		{
+			*snapshot_info = it->info;
+			return sfTrue;
+		}
+			);
+	return sfFalse;
+}
+
+void __RegisterStateInitStep(const char* name, sfBool(*init_step)(WindowManager*))
+{
+	if (stateInitStepList == NULL)
+	{
+		stateInitStepList = STD_LIST_CREATE(StateInitStepEntry, 0);
+	}
+	StateInitStepEntry entry;
+	strcpy_s(entry.name, 256, name);
+	entry.init_step = init_step;
+	stateInitStepList->push_back(stateInitStepList, &entry);
+}
+
+sfBool(*GetStateInitStep(const char* name))(WindowManager*)
+{
+	if (stateInitStepList == NULL)
+		return NULL;
+
+	FOR_EACH_LIST(stateInitStepList, StateInitStepEntry, i, it,
+		if (strcmp(name, it->name) == 0)
+			return it->init_step;
+			);
+	return NULL;
+}
+
+void __RegisterStateScene(const char* name, const char* scene_name)
+{
+	if (stateSceneList == NULL)
+	{
+		stateSceneList = STD_LIST_CREATE(StateSceneEntry, 0);
+	}
+	StateSceneEntry entry;
+	strcpy_s(entry.name, 256, name);
+	strcpy_s(entry.scene_name, 256, scene_name);
+	stateSceneList->push_back(stateSceneList, &entry);
+}
+
+const char* GetStateScene(const char* name)
+{
+	if (stateSceneList == NULL)
+		return NULL;
+
+	FOR_EACH_LIST(stateSceneList, StateSceneEntry, i, it,
+		if (strcmp(name, it->name) == 0)
+			return it->scene_name;
+			);
+	return NULL;
+}
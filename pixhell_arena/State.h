@@ -145,6 +145,89 @@ struct StateInfo
     void (*Destroy)(WindowManager*);
 };
 
+/**
+ * @struct StateSnapshotInfo
+ * @brief Describes how a state hands its render data over to the render thread when the game runs in pipelined mode.
+ *
+ * Capture runs on the simulation thread right after a batch of updates and copies everything rendering needs into the snapshot.
+ * Render and UIRender run on the main thread at the same time as the next batch of updates, so they must only read the snapshot.
+ */
+typedef struct StateSnapshotInfo StateSnapshotInfo;
+struct StateSnapshotInfo
+{
+    size_t snapshot_size; /**< Size in bytes of the snapshot structure of the state. */
+
+    /**
+     * @brief Copies the render data of the state into a snapshot.
+     * @param snapshot The snapshot buffer to fill, snapshot_size bytes long.
+     */
+    void (*Capture)(void* snapshot);
+
+    /**
+     * @brief Renders the state visuals from a snapshot.
+     * @param window_manager Pointer to the WindowManager object for rendering.
+     * @param snapshot The read-only snapshot to render.
+     */
+    void (*Render)(WindowManager*, const void* snapshot);
+
+    /**
+     * @brief Renders the user interface of the state from a snapshot.
+     * @param window_manager Pointer to the WindowManager object for UI rendering.
+     * @param snapshot The read-only snapshot to render.
+     */
+    void (*UIRender)(WindowManager*, const void* snapshot);
+};
+
+    /**
+     * @brief Opts a state into the pipelined mode.
+     *
+     * The state must define Capture##stateName, RenderSnapshot##stateName and UIRenderSnapshot##stateName, working on a snapshotType structure.
+     *
+     * @param stateName The name of the state.
+     * @param snapshotType The structure holding the render data of the state.
+     */
+#define REGISTER_STATE_SNAPSHOT(stateName, snapshotType)                     \
+    static void AddStateSnapshot##stateName##ToStateList()                     \
+    {                                                                          \
+        StateSnapshotInfo info = {.snapshot_size = sizeof(snapshotType),       \
+                                  .Capture = &Capture##stateName,              \
+                                  .Render = &RenderSnapshot##stateName,        \
+                                  .UIRender = &UIRenderSnapshot##stateName};   \
+        __RegisterStateSnapshot(#stateName, info);                             \
+    }                                                                          \
+    DECLARE_SECTION_PRAGMA                                                     \
+     __declspec(allocate(".CRT$XCU")) void (*p_register_snapshot_##stateName##_function)() = AddStateSnapshot##stateName##ToStateList; \
+
+    /**
+     * @brief Splits the setup of a state into steps run on the main thread once its Init is done.
+     *
+     * The state must define sfBool InitStep##stateName(WindowManager*), which does a small part of the setup and returns sfTrue once everything is set up.
+     * The loading screen keeps animating between the steps, each frame running as many steps as fit in INIT_STEP_BUDGET_US.
+     *
+     * @param stateName The name of the state.
+     */
+#define REGISTER_STATE_INIT_STEP(stateName)                                  \
+    static void AddStateInitStep##stateName##ToStateList()                     \
+    {                                                                          \
+        __RegisterStateInitStep(#stateName, &InitStep##stateName);             \
+    }                                                                          \
+    DECLARE_SECTION_PRAGMA                                                     \
+     __declspec(allocate(".CRT$XCU")) void (*p_register_init_step_##stateName##_function)() = AddStateInitStep##stateName##ToStateList; \
+
+    /**
+     * @brief Declares the resource scene loaded by the Init of a state, so PrefetchState can load it ahead of time.
+     *
+     * @param stateName The name of the state.
+     * @param sceneName The name of the scene given to LoadScene by the state, as a string literal.
+     */
+#define REGISTER_STATE_SCENE(stateName, sceneName)                           \
+    static void AddStateScene##stateName##ToStateList()                        \
+    {                                                                          \
+        __RegisterStateScene(#stateName, sceneName);                           \
+    }                                                                          \
+    DECLARE_SECTION_PRAGMA                                                     \
+     __declspec(allocate(".CRT$XCU")) void (*p_register_scene_##stateName##_function)() = AddStateScene##stateName##ToStateList; \
+
 /**
  * @brief Registers a state with the global state manager.
  *
@@ -165,3 +248,46 @@ void __RegisterState(StateInfo stateInfo);
  * @return The StateInfo structure associated with the specified state name.
  */
 StateInfo GetState(const char* name);
+
+/**
+ * @brief Registers the snapshot functions of a state, see REGISTER_STATE_SNAPSHOT.
+ * @param name The name of the state.
+ * @param snapshot_info The snapshot functions of the state.
+ */
+void __RegisterStateSnapshot(const char* name, StateSnapshotInfo snapshot_info);
+
+/**
+ * @brief Retrieves the snapshot functions of a state.
+ * @param name The name of the state.
+ * @param snapshot_info Filled with the snapshot functions if the state opted into the pipelined mode.
+ * @return sfTrue if the state registered snapshot functions, sfFalse otherwise.
+ */
+sfBool GetStateSnapshot(const char* name, StateSnapshotInfo* snapshot_info);
+
+/**
+ * @brief Registers the incremental init of a state, see REGISTER_STATE_INIT_STEP.
+ * @param name The name of the state.
+ * @param init_step The function running one step of the setup, returning sfTrue once the setup is complete.
+ */
+void __RegisterStateInitStep(const char* name, sfBool(*init_step)(WindowManager*));
+
+/**
+ * @brief Retrieves the incremental init of a state.
+ * @param name The name of the state.
+ * @return The init step function, NULL if the state did not register one.
+ */
+sfBool(*GetStateInitStep(const char* name))(WindowManager*);
+
+/**
+ * @brief Registers the resource scene of a state, see REGISTER_STATE_SCENE.
+ * @param name The name of the state.
+ * @param scene_name The name of the scene loaded by the state.
+ */
+void __RegisterStateScene(const char* name, const char* scene_name);
+
+/**
+ * @brief Retrieves the resource scene of a state.
+ * @param name The name of the state.
+ * @return The name of the scene, NULL if the state did not register one.
+ */
+const char* GetStateScene(const char* name);
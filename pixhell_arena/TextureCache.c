@@ -0,0 +1,226 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "TextureCache.h"
+#include "PackFile.h"
+#include "MemoryManagement.h"
+#include <ctype.h>
+
+#define TEXTURE_CACHE_RUN_FLAG 0x80000000u
+#define TEXTURE_CACHE_MAX_RUN 0x7FFFFFFFu
+#define TEXTURE_CACHE_MIN_RUN 3
+
+typedef struct TextureCacheHeader TextureCacheHeader;
+struct TextureCacheHeader
+{
+	char m_magic[8];
+	unsigned int m_version;
+	unsigned int m_is_compressed;
+	unsigned int m_width;
+	unsigned int m_height;
+	unsigned long long m_source_size;
+	unsigned long long m_source_mtime;
+	unsigned long long m_data_size;
+	char m_source_path[MAX_PATH_SIZE];
+};
+
+
+// Size and modification time of a loose file, packed files have none since they are not cached.
+static sfBool GetSourceAttributes(const char* path, unsigned long long* size, unsigned long long* mtime)
+{
+	size_t packed_size = 0;
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (GetPackedFile(path, &packed_size) || !GetFileAttributesExA(path, GetFileExInfoStandard, &data))
+		return sfFalse;
+	*size = ((unsigned long long)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+	*mtime = ((unsigned long long)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+	return sfTrue;
+}
+
+// The cache file is named after the FNV-1a hash of the normalized source path.
+static void BuildCachePath(char* cache_path, const char* path)
+{
+	unsigned long long hash = 14695981039346656037ull;
+	for (const char* c = path; *c; c++)
+	{
+		char normalized = *c == '/' ? '\\' : (char)tolower((unsigned char)*c);
+		hash = (hash ^ (unsigned char)normalized) * 1099511628211ull;
+	}
+	sprintf_s(cache_path, MAX_PATH_SIZE, "%s%s\\%016llx.rgba", resource_directory, TEXTURE_CACHE_EXTENSION, hash);
+}
+
+// Encodes the pixels as runs of one repeated pixel and literal spans, each introduced by a word holding its length.
+// Returns 0 if the encoded pixels don't fit in capacity words.
+static size_t CompressPixels(const unsigned int* pixels, size_t count, unsigned int* output, size_t capacity)
+{
+	size_t i = 0, written = 0;
+	while (i < count)
+	{
+		size_t run = 1;
+		while (i + run < count && pixels[i + run] == pixels[i] && run < TEXTURE_CACHE_MAX_RUN)
+			run++;
+		if (run >= TEXTURE_CACHE_MIN_RUN)
+		{
+			if (written + 2 > capacity)
+				return 0;
+			output[written++] = TEXTURE_CACHE_RUN_FLAG | (unsigned int)run;
+			output[written++] = pixels[i];
+			i += run;
+			continue;
+		}
+
+		size_t start = i, length = 0;
+		while (i < count && length < TEXTURE_CACHE_MAX_RUN)
+		{
+			if (i + 2 < count && pixels[i] == pixels[i + 1] && pixels[i] == pixels[i + 2])
+				break;
+			i++;
+			length++;
+		}
+		if (written + 1 + length > capacity)
+			return 0;
+		output[written++] = (unsigned int)length;
+		memcpy(output + written, pixels + start, length * sizeof(unsigned int));
+		written += length;
+	}
+	return written;
+}
+
+static sfBool DecompressPixels(const unsigned int* input, size_t input_count, unsigned int* pixels, size_t count)
+{
+	size_t read = 0, i = 0;
+	while (read < input_count)
+	{
+		unsigned int token = input[read++];
+		size_t length = token & TEXTURE_CACHE_MAX_RUN;
+		if (i + length > count)
+			return sfFalse;
+		if (token & TEXTURE_CACHE_RUN_FLAG)
+		{
+			if (read >= input_count)
+				return sfFalse;
+			unsigned int pixel = input[read++];
+			for (size_t j = 0; j < length; j++)
+				pixels[i + j] = pixel;
+		}
+		else
+		{
+			if (read + length > input_count)
+				return sfFalse;
+			memcpy(pixels + i, input + read, length * sizeof(unsigned int));
+			read += length;
+		}
+		i += length;
+	}
+	return i == count;
+}
+
+sfTexture* LoadCachedTexture(const char* path)
+{
+	unsigned long long source_size, source_mtime;
+	if (!GetSourceAttributes(path, &source_size, &source_mtime))
+		return NULL;
+
+	NEW_CHAR(cache_path, MAX_PATH_SIZE)
+		BuildCachePath(cache_path, path);
+	fs_mapped_file mapped_file;
+	if (!fs_map_file(cache_path, &mapped_file))
+		return NULL;
+
+	if (mapped_file.m_size < sizeof(TextureCacheHeader))
+	{
+		fs_unmap_file(&mapped_file);
+		return NULL;
+	}
+
+	const TextureCacheHeader* header = mapped_file.m_data;
+	const unsigned int* data = (const unsigned int*)(header + 1);
+	size_t pixel_count = (size_t)header->m_width * header->m_height;
+	sfTexture* texture = NULL;
+	if (memcmp(header->m_magic, TEXTURE_CACHE_MAGIC, sizeof(TEXTURE_CACHE_MAGIC)) == 0 && header->m_version == TEXTURE_CACHE_VERSION && header->m_source_size == source_size && header->m_source_mtime == source_mtime
+		&& fs_path_equals(header->m_source_path, path) && mapped_file.m_size - sizeof(TextureCacheHeader) == header->m_data_size
+		&& (header->m_is_compressed || header->m_data_size == pixel_count * sizeof(unsigned int)) && pixel_count)
+	{
+		const unsigned int* pixels = data;
+		unsigned int* decompressed_pixels = NULL;
+		if (header->m_is_compressed)
+		{
+			decompressed_pixels = calloc_d(unsigned int, pixel_count);
+			assert(decompressed_pixels);
+			pixels = DecompressPixels(data, (size_t)header->m_data_size / sizeof(unsigned int), decompressed_pixels, pixel_count) ? decompressed_pixels : NULL;
+		}
+		if (pixels)
+		{
+			texture = sfTexture_create(header->m_width, header->m_height);
+			if (texture)
+				sfTexture_updateFromPixels(texture, (const sfUint8*)pixels, header->m_width, header->m_height, 0, 0);
+		}
+		if (decompressed_pixels)
+			free_d(decompressed_pixels);
+	}
+	fs_unmap_file(&mapped_file);
+	return texture;
+}
+
+sfBool StoreCachedTexture(const char* path, const sfImage* image)
+{
+	TextureCacheHeader header = { .m_magic = TEXTURE_CACHE_MAGIC, .m_version = TEXTURE_CACHE_VERSION };
+	if (!GetSourceAttributes(path, &header.m_source_size, &header.m_source_mtime))
+		return sfFalse;
+
+	NEW_CHAR(cache_directory, MAX_PATH_SIZE)
+		strcpy_s(cache_directory, MAX_PATH_SIZE, resource_directory);
+	strcat_s(cache_directory, MAX_PATH_SIZE, TEXTURE_CACHE_EXTENSION);
+	if (fs_status(cache_directory) == FS_TYPE_NONE)
+		fs_create_directory(cache_directory);
+
+	sfVector2u size = sfImage_getSize(image);
+	size_t pixel_count = (size_t)size.x * size.y;
+	const unsigned int* pixels = (const unsigned int*)sfImage_getPixelsPtr(image);
+	if (!pixel_count || !pixels)
+		return sfFalse;
+	header.m_width = size.x;
+	header.m_height = size.y;
+	strcpy_s(header.m_source_path, MAX_PATH_SIZE, path);
+
+	unsigned int* compressed_pixels = calloc_d(unsigned int, pixel_count);
+	assert(compressed_pixels);
+	size_t compressed_count = CompressPixels(pixels, pixel_count, compressed_pixels, pixel_count);
+	header.m_is_compressed = compressed_count ? 1 : 0;
+	const unsigned int* data = compressed_count ? compressed_pixels : pixels;
+	header.m_data_size = (compressed_count ? compressed_count : pixel_count) * sizeof(unsigned int);
+
+	NEW_CHAR(cache_path, MAX_PATH_SIZE)
+		BuildCachePath(cache_path, path);
+	FILE* file = NULL;
+	sfBool is_written = sfFalse;
+	if (fopen_s(&file, cache_path, "wb") == 0 && file)
+	{
+		is_written = fwrite(&header, sizeof(TextureCacheHeader), 1, file) == 1
+			&& fwrite(data, 1, (size_t)header.m_data_size, file) == header.m_data_size;
+		fclose(file);
+		if (!is_written)
+			remove(cache_path);
+	}
+	free_d(compressed_pixels);
+	return is_written;
+}
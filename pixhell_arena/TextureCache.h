@@ -0,0 +1,79 @@
+/*
+	Author: GRALLAN Yann
+
+	Description: An advanced game engine for CSFML
+
+	Date: 2025/01/22
+
+	MIT License
+
+	Copyright (c) 2025 GRALLAN Yann
+
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "Tools.h"
+
+/**
+ * @file texturecache.h
+ * @brief This file defines the texture cache, which keeps the decoded pixels of every texture on disk to skip the PNG decoding on the next launches.
+ *
+ * Each texture file gets a cache file in the directory named after the resources directory followed by TEXTURE_CACHE_EXTENSION.
+ * A cache file holds the source path, size and modification time, then the RGBA pixels, run-length encoded when it makes them smaller.
+ * A cache file whose source changed is stale and gets rewritten the next time the texture is created from its PNG.
+ * Packed textures are not cached, they are decoded from the pack.
+ *
+ * @code
+ * // Done by CreateTexture:
+ * sfTexture* texture = LoadCachedTexture(path);
+ * if (!texture)
+ * {
+ *     sfImage* image = sfImage_createFromFile(path);
+ *     texture = sfTexture_createFromImage(image, NULL);
+ *     StoreCachedTexture(path, image);
+ *     sfImage_destroy(image);
+ * }
+ * @endcode
+ */
+
+/**
+ * @def TEXTURE_CACHE_EXTENSION
+ * @brief Extension appended to the resources directory to name the cache directory.
+ */
+#define TEXTURE_CACHE_EXTENSION ".texcache"
+
+/**
+ * @def TEXTURE_CACHE_MAGIC
+ * @brief Magic number at the start of every cache file.
+ */
+#define TEXTURE_CACHE_MAGIC "PXHTEXC"
+
+/**
+ * @def TEXTURE_CACHE_VERSION
+ * @brief Version of the cache file format. A cache file with another version is stale.
+ */
+#define TEXTURE_CACHE_VERSION 1
+
+/**
+ * @brief Creates a texture from its cache file, without decoding the PNG.
+ * @param path Path of the texture file.
+ * @return The texture, or NULL if the texture is packed, not cached yet or if its cache file is stale.
+ */
+sfTexture* LoadCachedTexture(const char* path);
+
+/**
+ * @brief Writes the cache file of a texture from its decoded image. Does nothing for a packed texture.
+ * @param path Path of the texture file the image was decoded from.
+ * @param image Decoded image.
+ * @return sfTrue if the cache file was written, sfFalse otherwise.
+ */
+sfBool StoreCachedTexture(const char* path, const sfImage* image);
@@ -21,31 +21,205 @@
 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #include "TextureManager.h"
+#include "PackFile.h"
+#include "TextureCache.h"
+#include "MemoryManagement.h"
+#include <assert.h>
 
-stdList* global_texture_list, * scene_texture_list;
+stdList* global_texture_list, * scene_texture_list, * prefetch_texture_list;
 Texture texture_place_holder;
+static SRWLOCK texture_list_lock = SRWLOCK_INIT;
+static ResourceRegistry* texture_registry;
+static ResourceCache* texture_cache;
+static size_t texture_budget = DEFAULT_TEXTURE_BUDGET;
 
 
+// Bottom of the page starting at top, moved up until it cuts no sprite of the sheet. A sprite taller than a page is cut anyway.
+static unsigned int FindPageBottom(SpriteSheet* sheet, unsigned int top, unsigned int height, unsigned int max_size)
+{
+	unsigned int bottom = top + max_size;
+	if (bottom >= height)
+		return height;
+	unsigned int cut = bottom;
+	sfBool is_moved = sheet != NULL;
+	while (is_moved)
+	{
+		is_moved = sfFalse;
+		for (int i = 0; i < sheet->GetFrameCount(sheet); i++)
+		{
+			sfIntRect rect = sheet->GetFrame(sheet, i)->m_rect;
+			if ((unsigned int)rect.top < cut && (unsigned int)(rect.top + rect.height) > cut)
+			{
+				cut = (unsigned int)rect.top;
+				is_moved = sfTrue;
+			}
+		}
+	}
+	return cut > top ? cut : bottom;
+}
+
+// A sheet over the maximum size of the GPU is split in horizontal pages, GetSpriteRegion picks the page of each sprite.
+static void CreateTexturePages(Texture* texture, const sfImage* image, const char* path)
+{
+	unsigned int max_size = sfTexture_getMaximumSize();
+	sfVector2u size = sfImage_getSize(image);
+	unsigned int page_width = size.x < max_size ? size.x : max_size;
+	if (size.x > max_size)
+		printf_d("Texture %s is wider than %u pixels, its right side is cropped\n\n", path, max_size);
+
+	texture->m_page_count = 0;
+	for (unsigned int top = 0; top < size.y; top = FindPageBottom(texture->m_sheet, top, size.y, max_size))
+		texture->m_page_count++;
+	texture->m_pages = calloc_d(TexturePage, texture->m_page_count);
+	assert(texture->m_pages);
+	unsigned int top = 0;
+	for (int i = 0; i < texture->m_page_count; i++)
+	{
+		unsigned int bottom = FindPageBottom(texture->m_sheet, top, size.y, max_size);
+		sfIntRect area = { 0, (int)top, (int)page_width, (int)(bottom - top) };
+		texture->m_pages[i].m_texture = sfTexture_createFromImage(image, &area);
+		texture->m_pages[i].m_top = (int)top;
+		top = bottom;
+	}
+	texture->m_texture = texture->m_pages[0].m_texture;
+	printf_d("Texture %s is split in %d pages\n\n", path, texture->m_page_count);
+}
+
 Texture CreateTexture(const char* path)
 {
-	Texture tmp;
+	Texture tmp = { 0 };
 	Path tmpPath = fs_create_path(path);
-	tmp.m_texture = sfTexture_createFromFile(path, NULL);
-	sfVector2f size = { (float)sfTexture_getSize(tmp.m_texture).x, (float)sfTexture_getSize(tmp.m_texture).y };
+	tmp.m_texture = is_headless_resources ? NULL : LoadCachedTexture(path);
+	if (tmp.m_texture)
+	{
+		sfVector2u texture_size = sfTexture_getSize(tmp.m_texture);
+		tmp.m_sheet = LoadSpriteSheet(path, texture_size.x, texture_size.y);
+	}
+	else
+	{
+		fs_mapped_file mapped_file;
+		size_t file_size = 0;
+		const void* data = MapResourceFile(path, &file_size, &mapped_file);
+		sfImage* image = data ? sfImage_createFromMemory(data, file_size) : sfImage_createFromFile(path);
+		fs_unmap_file(&mapped_file);
+		if (image && is_headless_resources)
+		{
+			// Without a graphics context nothing is uploaded, the pixels stay on the CPU.
+			sfVector2u image_size = sfImage_getSize(image);
+			tmp.m_sheet = LoadSpriteSheet(path, image_size.x, image_size.y);
+			tmp.m_image = image;
+		}
+		else if (image)
+		{
+			sfVector2u image_size = sfImage_getSize(image);
+			unsigned int max_size = sfTexture_getMaximumSize();
+			tmp.m_sheet = LoadSpriteSheet(path, image_size.x, image_size.y);
+			// The pages are not cached, the cache loads a texture in one piece.
+			if (image_size.x > max_size || image_size.y > max_size)
+				CreateTexturePages(&tmp, image, path);
+			else
+			{
+				tmp.m_texture = sfTexture_createFromImage(image, NULL);
+				StoreCachedTexture(path, image);
+			}
+			sfImage_destroy(image);
+		}
+	}
 	tmp.m_path = tmpPath;
-	strcpy_s(tmp.m_name, MAX_PATH_SIZE, tmpPath.stem(&tmpPath).path_data.m_path);
+	tmp.m_load_state = RESOURCE_LOADED;
+	fs_stem(path, tmp.m_name, MAX_PATH_SIZE);
 	ToLower(tmp.m_name);
 	printf_d("Texture {\n\tPath : %s\n\tName: %s\n } loaded\n\n", tmp.m_path.path_data.m_path, tmp.m_name);
 	return tmp;
 }
 
+static Texture CreateUnloadedTexture(const char* path)
+{
+	Texture tmp = { 0 };
+	tmp.m_path = fs_create_path(path);
+	fs_stem(path, tmp.m_name, MAX_PATH_SIZE);
+	ToLower(tmp.m_name);
+	tmp.m_load_state = RESOURCE_UNLOADED;
+	return tmp;
+}
+
+static void LoadTextureOnFirstUse(void* resource)
+{
+	Texture* texture = resource;
+	Texture loaded = CreateTexture(texture->m_path.path_data.m_path);
+	texture->m_texture = loaded.m_texture;
+	texture->m_sheet = loaded.m_sheet;
+	texture->m_pages = loaded.m_pages;
+	texture->m_page_count = loaded.m_page_count;
+	texture->m_image = loaded.m_image;
+}
+
+static sfTexture* RequireTexture(Texture* texture)
+{
+	if (__RequireResource(&texture->m_load_state, &LoadTextureOnFirstUse, texture))
+		return texture->m_texture;
+	return texture_place_holder.m_texture;
+}
+
+static size_t GetTextureMemorySize(const Texture* texture)
+{
+	size_t memory_size = 0;
+	for (int i = 0; i < texture->m_page_count; i++)
+	{
+		sfVector2u size = sfTexture_getSize(texture->m_pages[i].m_texture);
+		memory_size += (size_t)size.x * size.y * 4;
+	}
+	if (!texture->m_pages && texture->m_texture)
+	{
+		sfVector2u size = sfTexture_getSize(texture->m_texture);
+		memory_size += (size_t)size.x * size.y * 4;
+	}
+	if (texture->m_image)
+	{
+		sfVector2u size = sfImage_getSize(texture->m_image);
+		memory_size += (size_t)size.x * size.y * 4;
+	}
+	return memory_size;
+}
+
+static void DestroyCachedTexture(void* texture)
+{
+	DeleteTexture(texture);
+}
+
+// Instead of being destroyed with its scene, the texture waits in the cache in case a next scene uses it again.
+static void RetireTexture(Texture* texture)
+{
+	texture_cache->Store(texture_cache, texture->m_name, texture->m_path.path_data.m_path, texture, texture->m_texture, GetTextureMemorySize(texture));
+}
+
+static Texture TakeOrCreateTexture(const char* path)
+{
+	Texture tmp;
+	if (!texture_cache->Take(texture_cache, path, &tmp))
+		tmp = CreateTexture(path);
+	return tmp;
+}
+
+// The global list is complete, its entries no longer move.
+static void RegisterGlobalTextures(void)
+{
+	texture_registry = CreateResourceRegistry();
+	// Registered first, so the handle of an identifier is the identifier plus one.
+	for (int i = 0; i < TEXTURE_ID_COUNT; i++)
+		texture_registry->GetHandle(texture_registry, texture_id_names[i], NULL);
+	FOR_EACH_LIST(global_texture_list, Texture, it, tmp,
+		texture_registry->AddGlobalResource(texture_registry, tmp->m_name, tmp);
+		)
+}
+
 void InitTextureManager(void)
 {
 	NEW_CHAR(resources_path, MAX_PATH_SIZE)
 		strcpy_s(resources_path, MAX_PATH_SIZE, resource_directory);
 	strcat_s(resources_path, MAX_PATH_SIZE, "/ALL/Textures");
 	Path fs_path = fs_create_path(resources_path);
-	if (fs_path.exist(&fs_path))
+	if ((fs_path.exist(&fs_path) || IsPackedDirectory(fs_path.path_data.m_path)))
 	{
 		if (global_texture_list == NULL)
 		{
@@ -53,15 +227,19 @@ void InitTextureManager(void)
 
 			global_texture_list = stdList_Create(sizeof(Texture), 0);
 			scene_texture_list = stdList_Create(sizeof(Texture), 0);
+			prefetch_texture_list = stdList_Create(sizeof(Texture), 0);
 			stdList* filesInfos = SearchFilesInfos(fs_path.path_data.m_path, "png"); 
 			for (int i = 0; i < filesInfos->size(filesInfos); i++) 
 			{
-				Texture tmp = CreateTexture(((FilesInfo*)filesInfos->getData(filesInfos, i))->m_path);
+				const char* file_path = ((FilesInfo*)filesInfos->getData(filesInfos, i))->m_path;
+				Texture tmp = __IsLoadedEagerly(file_path) ? CreateTexture(file_path) : CreateUnloadedTexture(file_path);
 				if (strcmp(tmp.m_name, "placeholder") == 0) 
 					texture_place_holder = tmp;
 				else global_texture_list->push_back(global_texture_list, &tmp);
 			} 
 			filesInfos->destroy(&filesInfos);
+			RegisterGlobalTextures();
+			texture_cache = CreateResourceCache(sizeof(Texture), texture_registry, &DestroyCachedTexture, texture_budget);
 		}
 	}
 	else
@@ -72,69 +250,248 @@ void InitTextureManager(void)
 }
 
 
-void Load_Texture(const char* path)
+void Load_Texture(const char* path, const CancelToken* cancel_token)
 {
-	Texture tmp = CreateTexture(path);
+	Texture tmp = TakeOrCreateTexture(path);
+	if (IsLoadCancelled(cancel_token))
+	{
+		RetireTexture(&tmp);
+		return;
+	}
+	AcquireSRWLockExclusive(&texture_list_lock);
 	scene_texture_list->push_back(scene_texture_list, &tmp);
+	ReleaseSRWLockExclusive(&texture_list_lock);
+	texture_registry->AddSceneResource(texture_registry, tmp.m_name, tmp.m_texture);
 }
 
-void LoadSceneTexture(const char* scene, float* progressValue)
+void LoadSceneTexture(const char* scene, SceneLoader* loader)
 {
 	ClearSceneTexture();
-	__LoadScene(scene, "png", "Textures",progressValue, &Load_Texture);
+	__LoadScene(scene, TEXTURE_EXTENSION, TEXTURE_DIRECTORY, loader, &Load_Texture);
 }
 
 
 
+static void Prefetch_Texture(const char* path, const CancelToken* cancel_token)
+{
+	Texture tmp = TakeOrCreateTexture(path);
+	if (IsLoadCancelled(cancel_token))
+	{
+		RetireTexture(&tmp);
+		return;
+	}
+	AcquireSRWLockExclusive(&texture_list_lock);
+	prefetch_texture_list->push_back(prefetch_texture_list, &tmp);
+	ReleaseSRWLockExclusive(&texture_list_lock);
+}
+
+void PrefetchSceneTexture(const char* scene, SceneLoader* loader)
+{
+	ClearPrefetchedSceneTexture();
+	__LoadScene(scene, TEXTURE_EXTENSION, TEXTURE_DIRECTORY, loader, &Prefetch_Texture);
+}
+
+void CommitPrefetchedSceneTexture(void)
+{
+	ClearSceneTexture();
+	stdList* tmp = scene_texture_list;
+	scene_texture_list = prefetch_texture_list;
+	prefetch_texture_list = tmp;
+	FOR_EACH_LIST(scene_texture_list, Texture, it, scene_texture,
+		texture_registry->AddSceneResource(texture_registry, scene_texture->m_name, scene_texture->m_texture);
+		)
+}
+
+void ClearPrefetchedSceneTexture(void)
+{
+	if (prefetch_texture_list != NULL)
+	{
+		for (int i = 0; i < prefetch_texture_list->size(prefetch_texture_list); i++)
+			RetireTexture(STD_GETDATA(prefetch_texture_list, Texture, i));
+		prefetch_texture_list->clear(prefetch_texture_list);
+	}
+}
+
 void ClearSceneTexture(void)
 {
 	if (scene_texture_list != NULL)
 	{
+		texture_registry->ClearSceneResources(texture_registry);
 		for (int i = 0; i < scene_texture_list->size(scene_texture_list); i++)
-			sfTexture_destroy(STD_GETDATA(scene_texture_list, Texture, i)->m_texture);
+			RetireTexture(STD_GETDATA(scene_texture_list, Texture, i));
 		scene_texture_list->clear(scene_texture_list);
 	}
 }
 
+void SetTextureBudget(size_t budget)
+{
+	texture_budget = budget;
+	if (texture_cache)
+		texture_cache->SetBudget(texture_cache, budget);
+}
+
+ResourceHandle GetTextureHandle(const char* name)
+{
+	return texture_registry ? texture_registry->GetHandle(texture_registry, name, NULL) : INVALID_RESOURCE_HANDLE;
+}
+
+sfTexture* GetTextureById(TextureId id)
+{
+	return GetTextureFromHandle((ResourceHandle)id + 1);
+}
+
+sfBool IsTextureLoadedById(TextureId id)
+{
+	ResourceEntry* entry = texture_registry ? texture_registry->GetEntry(texture_registry, (ResourceHandle)id + 1) : NULL;
+	// Without a global texture there is nothing to wait for, the Get functions return the placeholder anyway.
+	if (!entry || !entry->m_global_resource)
+		return sfTrue;
+	RequireTexture(entry->m_global_resource);
+	return ((Texture*)entry->m_global_resource)->m_load_state == RESOURCE_LOADED ? sfTrue : sfFalse;
+}
+
+sfTexture* GetTextureFromHandle(ResourceHandle handle)
+{
+	ResourceEntry* entry = texture_registry ? texture_registry->GetEntry(texture_registry, handle) : NULL;
+	if (entry)
+	{
+		if (entry->m_global_resource)
+			return RequireTexture(entry->m_global_resource);
+		if (entry->m_scene_resource)
+			return entry->m_scene_resource;
+	}
+	return texture_place_holder.m_texture;
+}
+
 sfTexture* GetTexture(const char* name)
 {
-	if (global_texture_list != NULL)
-		FOR_EACH_LIST(global_texture_list, Texture, it, tmp,
-			if (strcmp(tmp->m_name, name) == 0)
-				return tmp->m_texture;
-				)
+	sfBool is_new = sfFalse;
+	ResourceHandle handle = texture_registry ? texture_registry->GetHandle(texture_registry, name, &is_new) : INVALID_RESOURCE_HANDLE;
+	sfTexture* texture = GetTextureFromHandle(handle);
+	if (!texture && !is_headless_resources)
+		printf_d("No texture placeholder found, put a placeholder.png in your %s/ALL/Textures folder", resource_directory);
+	// Only the first lookup of a missing name prints, the next ones hit its empty entry.
+	else if (is_new && texture == texture_place_holder.m_texture)
+		printf_d("Texture %s not found, placeholder returned", name);
+	return texture;
+}
 
-		if (scene_texture_list != NULL)
-			FOR_EACH_LIST(scene_texture_list, Texture, it, tmp,
-				if (strcmp(tmp->m_name, name) == 0)
-					return tmp->m_texture;
-					)
+// The texture struct of a name, to read its sprite sheet. The global one first, like in GetTexture.
+static Texture* FindTextureByName(const char* name)
+{
+	ResourceEntry* entry = texture_registry ? texture_registry->GetEntry(texture_registry, texture_registry->GetHandle(texture_registry, name, NULL)) : NULL;
+	if (!entry)
+		return NULL;
+	if (entry->m_global_resource)
+		return RequireTexture(entry->m_global_resource) != texture_place_holder.m_texture ? entry->m_global_resource : NULL;
+	Texture* texture = NULL;
+	AcquireSRWLockShared(&texture_list_lock);
+	for (int i = 0; i < scene_texture_list->size(scene_texture_list) && !texture; i++)
+	{
+		Texture* scene_texture = STD_GETDATA(scene_texture_list, Texture, i);
+		if (entry->m_scene_resource && scene_texture->m_texture == entry->m_scene_resource)
+			texture = scene_texture;
+	}
+	ReleaseSRWLockShared(&texture_list_lock);
+	return texture;
+}
 
-			if (texture_place_holder.m_texture)
-			{
-				printf_d("Texture %s not found, placeholder returned", name);
-				return texture_place_holder.m_texture;
-			}
+TextureRegion GetSpriteRegion(const char* texture_name, const char* sprite_name)
+{
+	TextureRegion region;
+	Texture* texture = FindTextureByName(texture_name);
+	if (texture && texture->m_sheet && texture->m_sheet->GetRect(texture->m_sheet, sprite_name, &region.m_rect))
+	{
+		region.m_texture = texture->m_texture;
+		int page_top = 0;
+		for (int i = 0; i < texture->m_page_count && region.m_rect.top >= texture->m_pages[i].m_top; i++)
+		{
+			region.m_texture = texture->m_pages[i].m_texture;
+			page_top = texture->m_pages[i].m_top;
+		}
+		region.m_rect.top -= page_top;
+		return region;
+	}
+	printf_d("Sprite %s not found in texture %s, placeholder returned\n", sprite_name, texture_name);
+	region.m_texture = texture_place_holder.m_texture;
+	sfVector2u size = { 0, 0 };
+	if (region.m_texture)
+		size = sfTexture_getSize(region.m_texture);
+	region.m_rect = (sfIntRect){ 0, 0, (int)size.x, (int)size.y };
+	return region;
+}
+
+TextureRegion GetSpriteRegionById(TextureId id, const char* sprite_name)
+{
+	return GetSpriteRegion(texture_id_names[id], sprite_name);
+}
 
-	printf_d("No texture placeholder found, put a placeholder.png in your %s/ALL/Textures folder", resource_directory);
+static Texture* FindLoadedTexture(const char* path)
+{
+	if (texture_place_holder.m_texture && fs_path_equals(texture_place_holder.m_path.path_data.m_path, path))
+		return &texture_place_holder;
+	if (global_texture_list != NULL)
+		FOR_EACH_LIST(global_texture_list, Texture, it, tmp,
+			if (tmp->m_load_state == RESOURCE_LOADED && fs_path_equals(tmp->m_path.path_data.m_path, path))
+				return tmp;
+				)
+	if (scene_texture_list != NULL)
+		FOR_EACH_LIST(scene_texture_list, Texture, it, tmp,
+			if (fs_path_equals(tmp->m_path.path_data.m_path, path))
+				return tmp;
+				)
 	return NULL;
 }
 
+sfBool ReloadTexture(const char* path, sfTexture* texture)
+{
+	// The swap writes the texture, a concurrent FindTextureByName must not read it halfway.
+	AcquireSRWLockExclusive(&texture_list_lock);
+	Texture* loaded_texture = FindLoadedTexture(path);
+	// The pages of a split sheet do not match the size of the new texture, it is picked up on the next load.
+	if (loaded_texture && loaded_texture->m_pages)
+		printf_d("Texture %s is split in pages, it is not reloaded\n", path);
+	else if (loaded_texture)
+		sfTexture_swap(loaded_texture->m_texture, texture);
+	ReleaseSRWLockExclusive(&texture_list_lock);
+	sfTexture_destroy(texture);
+	// A cached copy would be taken back by the next scene with the old pixels.
+	sfBool is_evicted = texture_cache->Evict(texture_cache, path);
+	return loaded_texture || is_evicted ? sfTrue : sfFalse;
+}
+
 void DestroyTexturesManager(void)
 {
 	ClearSceneTexture();
 	if (global_texture_list != NULL)
 	{
 		for (int i = 0; i < global_texture_list->size(global_texture_list); i++)
-			sfTexture_destroy(STD_GETDATA(global_texture_list, Texture, i)->m_texture);
+			DeleteTexture(STD_GETDATA(global_texture_list, Texture, i));
 		global_texture_list->clear(global_texture_list);
 	}
 	scene_texture_list->destroy(&scene_texture_list);
+	ClearPrefetchedSceneTexture();
+	prefetch_texture_list->destroy(&prefetch_texture_list);
 	assert(global_texture_list);
 	global_texture_list->destroy(&global_texture_list);
+	texture_cache->Destroy(&texture_cache);
+	texture_registry->Destroy(&texture_registry);
+	ClearSpriteSheetCache();
 }
 
 void DeleteTexture(Texture* texture)
 {
-	sfTexture_destroy(texture->m_texture);
+	for (int i = 0; i < texture->m_page_count; i++)
+		sfTexture_destroy(texture->m_pages[i].m_texture);
+	if (texture->m_pages)
+		free_d(texture->m_pages);
+	else if (texture->m_texture)
+		sfTexture_destroy(texture->m_texture);
+	if (texture->m_image)
+		sfImage_destroy(texture->m_image);
+	texture->m_image = NULL;
+	if (texture->m_sheet)
+		texture->m_sheet->Destroy(&texture->m_sheet);
+	texture->m_pages = NULL;
+	texture->m_page_count = 0;
 }
@@ -22,12 +22,55 @@
 */
 #pragma once
 #include "Tools.h"
+#include "ResourceCache.h"
+#include "SpriteSheet.h"
+#include "ResourceIds.h"
 
 /**
  * @file texturemanager.h
  * @brief This file contains all the data to load textures for the engine.
  */
 
+/**
+ * @def TEXTURE_EXTENSION
+ * @brief Extension of the textures files.
+ */
+#define TEXTURE_EXTENSION "png"
+
+/**
+ * @def TEXTURE_DIRECTORY
+ * @brief Name of the textures directory inside a scene directory.
+ */
+#define TEXTURE_DIRECTORY "Textures"
+
+/**
+ * @def DEFAULT_TEXTURE_BUDGET
+ * @brief Default size in bytes of the textures of the previous scenes kept loaded, see SetTextureBudget.
+ */
+#define DEFAULT_TEXTURE_BUDGET (64 * 1024 * 1024)
+
+/**
+ * @struct TextureRegion
+ * @brief A rectangle of a texture, a named sprite of a sheet or a whole texture.
+ */
+typedef struct TextureRegion TextureRegion;
+struct TextureRegion
+{
+    sfTexture* m_texture;          /**< Texture holding the pixels. */
+    sfIntRect m_rect;              /**< Rectangle of the pixels in the texture. */
+};
+
+/**
+ * @struct TexturePage
+ * @brief A horizontal strip of a texture larger than sfTexture_getMaximumSize, see GetSpriteRegion.
+ */
+typedef struct TexturePage TexturePage;
+struct TexturePage
+{
+    sfTexture* m_texture;          /**< Pointer to the SFML texture of the strip. */
+    int m_top;                     /**< Y of the top of the strip in the texture file. */
+};
+
 /**
  * @struct Texture
  * @brief Represents a texture object, storing the texture data and its metadata.
@@ -35,9 +78,14 @@
 typedef struct Texture Texture;
 struct Texture
 {
-    sfTexture* m_texture;          /**< Pointer to the SFML texture object. */
+    sfTexture* m_texture;          /**< Pointer to the SFML texture object, the first page when the texture is split. */
     Path m_path;                   /**< Path to the texture file. */
     char m_name[MAX_PATH_SIZE];    /**< Name of the texture used for identification. */
+    volatile LONG m_load_state;    /**< ResourceLoadState of the texture, see __RequireResource. */
+    SpriteSheet* m_sheet;          /**< Named rectangles of the texture, or NULL if no descriptor describes it. */
+    TexturePage* m_pages;          /**< Pages of a texture too large for the GPU, or NULL if it fits in m_texture. */
+    int m_page_count;              /**< Number of pages in m_pages. */
+    sfImage* m_image;              /**< Decoded pixels kept instead of m_texture when the resources are headless, see SetHeadlessResources. */
 };
 
 /**
@@ -62,15 +110,34 @@ void InitTextureManager(void);
 /**
  * @brief Loads all textures associated with a specific scene.
  * @param scene Name of the scene for which textures should be loaded.
+ * @param loader Loader the files are queued on, they load once it is started.
  */
-void LoadSceneTexture(const char* scene, float* progressValue);
+void LoadSceneTexture(const char* scene, SceneLoader* loader);
 
 /**
  * @brief Clears all textures associated with the current scene.
- * This function frees memory and unloads scene-specific textures.
+ * They are handed to the cache of the manager, the next scenes take them back without loading them again.
  */
 void ClearSceneTexture(void);
 
+/**
+ * @brief Loads the textures of a scene into a separate list, without touching the textures of the current scene.
+ * @param scene Name of the scene for which textures should be prefetched.
+ * @param loader Loader the files are queued on, they load once it is started.
+ */
+void PrefetchSceneTexture(const char* scene, SceneLoader* loader);
+
+/**
+ * @brief Replaces the textures of the current scene by the prefetched ones.
+ * The textures of the previous scene are freed.
+ */
+void CommitPrefetchedSceneTexture(void);
+
+/**
+ * @brief Frees the prefetched textures that were never committed.
+ */
+void ClearPrefetchedSceneTexture(void);
+
 /**
  * @brief Retrieves a texture object by its name.
  * @param name Name of the texture to retrieve.
@@ -78,6 +145,67 @@ void ClearSceneTexture(void);
  */
 sfTexture* GetTexture(const char* name);
 
+/**
+ * @brief Retrieves a named sprite of a sprite sheet, as listed in the descriptor of the sheet, see spritesheet.h.
+ * When the sheet is split in pages, the page holding the sprite is returned with the rectangle moved into it.
+ * @param texture_name Name of the sheet texture.
+ * @param sprite_name Name of the sprite in the descriptor, compared without case.
+ * @return The texture and the rectangle of the sprite in it, or the placeholder and its whole rectangle if the sprite is not found.
+ */
+TextureRegion GetSpriteRegion(const char* texture_name, const char* sprite_name);
+
+/**
+ * @brief Retrieves a named sprite of a sprite sheet by the generated identifier of the sheet, see GetSpriteRegion.
+ * @param id Identifier of the sheet texture.
+ * @param sprite_name Name of the sprite in the descriptor, compared without case.
+ * @return The texture and the rectangle of the sprite in it, or the placeholder and its whole rectangle if the sprite is not found.
+ */
+TextureRegion GetSpriteRegionById(TextureId id, const char* sprite_name);
+
+/**
+ * @brief Retrieves the stable handle of a texture name, to resolve it every frame with GetTextureFromHandle instead of looking the name up.
+ * @param name Name of the texture, compared without case. It does not have to be loaded yet.
+ * @return The handle of the name.
+ */
+ResourceHandle GetTextureHandle(const char* name);
+
+/**
+ * @brief Retrieves a texture object by its handle, without any name lookup.
+ * @param handle Handle returned by GetTextureHandle.
+ * @return Pointer to the texture object, or the placeholder while no texture of that name is loaded.
+ */
+sfTexture* GetTextureFromHandle(ResourceHandle handle);
+
+/**
+ * @brief Retrieves a texture object by its generated identifier, see ResourceIds.h. A renamed or removed texture fails to compile instead of returning the placeholder.
+ * @param id Identifier of the texture.
+ * @return Pointer to the texture object, or the placeholder while it is not loaded.
+ */
+sfTexture* GetTextureById(TextureId id);
+
+/**
+ * @brief Tells if a global texture is loaded, and requests its load if it is not, see SetResourceLoadingMode.
+ * In RESOURCE_LOADING_ASYNC mode, a caller keeping the texture or the regions of its sheet waits for it, GetTextureById returns the placeholder until then.
+ * @param id Identifier of the texture.
+ * @return sfTrue once the texture is loaded, or if no global texture has this identifier.
+ */
+sfBool IsTextureLoadedById(TextureId id);
+
+/**
+ * @brief Sets the size of the textures of the previous scenes kept loaded. The least recently used ones are destroyed over it.
+ * @param budget Budget in bytes, DEFAULT_TEXTURE_BUDGET by default.
+ */
+void SetTextureBudget(size_t budget);
+
+/**
+ * @brief Replaces the pixels of the loaded texture created from path, used by the hot reload.
+ * The content is swapped in place, so every sprite keeps its pointer and shows the new pixels. Must be called from the main thread.
+ * @param path Path of the texture file.
+ * @param texture Texture decoded from the modified file, destroyed by this function.
+ * @return sfTrue if a loaded or cached texture was created from path, sfFalse otherwise. The cached one is destroyed.
+ */
+sfBool ReloadTexture(const char* path, sfTexture* texture);
+
 /**
  * @brief Destroys the texture manager and releases all associated resources.
  * This function is called when shutting down the application to free up memory and unload textures.
@@ -22,101 +22,269 @@
 */
 #include "ThreadManager.h"
 #include "MemoryManagement.h"
+#include "Profiler.h"
+#include <windows.h>
 
-struct ThreadManager_Data
+#define THREAD_MANAGER_QUEUE_PER_WORKER 16
+
+struct ThreadTask
 {
-	size_t m_limit;
-	size_t m_actual_size;
-	stdList* m_thread_list;
+	void (*func)(void*);
+	void* func_data;
+	volatile LONG m_is_finish;
+	sfBool m_data_is_copied;
+	sfBool m_is_released;
 };
 
-typedef struct ThreadFunctionInfo ThreadFunctionInfo;
-struct ThreadFunctionInfo
+typedef struct MainThreadTask MainThreadTask;
+struct MainThreadTask
 {
 	void (*func)(void*);
 	void* func_data;
-	sfThread* m_thread;
-	sfBool m_is_finish;
 	sfBool m_data_is_copied;
+	MainThreadTask* m_next;
+};
+
+struct ThreadManager_Data
+{
+	size_t m_limit;
+	sfThread** m_workers;
+
+	ThreadTask** m_queue;
+	size_t m_queue_capacity;
+	size_t m_queue_head;
+	size_t m_queue_count;
+
+	SRWLOCK m_lock;
+	CONDITION_VARIABLE m_task_available;
+	CONDITION_VARIABLE m_slot_available;
+	CONDITION_VARIABLE m_task_done;
+
+	volatile LONG m_pending;
+	sfBool m_is_running;
+
+	SRWLOCK m_task_list_lock;
+	stdList* m_task_list;
+
+	SRWLOCK m_main_lock;
+	MainThreadTask* m_main_head;
+	MainThreadTask* m_main_tail;
 };
 
 
 
 static size_t GetThreadCount(const ThreadManager* thread_manager)
 {
-	return thread_manager->_Data->m_actual_size;
+	return (size_t)InterlockedCompareExchange(&thread_manager->_Data->m_pending, 0, 0);
 }
 
-static void ThreadFunction(void* data)
+static sfBool IsTaskFinished(const ThreadTask* task)
 {
-	ThreadFunctionInfo* thread_info = data;
-	thread_info->func(thread_info->func_data);
-	thread_info->m_is_finish = sfTrue;
+	return InterlockedCompareExchange((volatile LONG*)&task->m_is_finish, 0, 0) != 0;
 }
 
-static ThreadFunctionInfo* CreateThreadFunction(void (*func)(void*), void* data)
+static void WorkerFunction(void* data)
 {
-	ThreadFunctionInfo* thread_function_info = calloc_d(ThreadFunctionInfo, 1);
-	assert(thread_function_info);
-	thread_function_info->func = func;
-	thread_function_info->func_data = data;
-	thread_function_info->m_thread = sfThread_create(&ThreadFunction, thread_function_info);
-	thread_function_info->m_is_finish = sfFalse;
-	return thread_function_info;
+	ThreadManager_Data* manager_data = data;
+	for (;;)
+	{
+		AcquireSRWLockExclusive(&manager_data->m_lock);
+		while (!manager_data->m_queue_count && manager_data->m_is_running)
+			SleepConditionVariableSRW(&manager_data->m_task_available, &manager_data->m_lock, INFINITE, 0);
+		if (!manager_data->m_queue_count)
+		{
+			ReleaseSRWLockExclusive(&manager_data->m_lock);
+			PROFILE_THREAD_EXIT();
+			return;
+		}
+		ThreadTask* task = manager_data->m_queue[manager_data->m_queue_head];
+		manager_data->m_queue_head = (manager_data->m_queue_head + 1) % manager_data->m_queue_capacity;
+		manager_data->m_queue_count--;
+		WakeConditionVariable(&manager_data->m_slot_available);
+		ReleaseSRWLockExclusive(&manager_data->m_lock);
+
+		task->func(task->func_data);
+
+		AcquireSRWLockExclusive(&manager_data->m_lock);
+		InterlockedExchange(&task->m_is_finish, 1);
+		InterlockedDecrement(&manager_data->m_pending);
+		WakeAllConditionVariable(&manager_data->m_task_done);
+		ReleaseSRWLockExclusive(&manager_data->m_lock);
+	}
 }
 
-static void DestroyThreadFunction(ThreadFunctionInfo** thread_function_info)
+static void DestroyTask(ThreadTask** task)
 {
-	ThreadFunctionInfo* abbreviate_thread_function_info = *thread_function_info;
-	sfThread_wait(abbreviate_thread_function_info->m_thread);
-	sfThread_destroy(abbreviate_thread_function_info->m_thread);
-	if (abbreviate_thread_function_info->m_data_is_copied)
-		free_d(abbreviate_thread_function_info->func_data);
-	free_d(abbreviate_thread_function_info);
-	*thread_function_info = NULL;
+	if ((*task)->m_data_is_copied)
+		free_d((*task)->func_data);
+	free_d(*task);
+	*task = NULL;
 }
 
 static void UpdateThreadManager(ThreadManager* thread_manager)
 {
-	stdList* thread_list = thread_manager->_Data->m_thread_list;
-	do
+	stdList* task_list = thread_manager->_Data->m_task_list;
+	AcquireSRWLockExclusive(&thread_manager->_Data->m_task_list_lock);
+	for (int i = (int)task_list->size(task_list) - 1; i >= 0; i--)
 	{
-		for (int i = 0; i < thread_list->size(thread_list); i++)
+		ThreadTask** task = STD_GETDATA(task_list, ThreadTask*, i);
+		if ((*task)->m_is_released && IsTaskFinished(*task))
 		{
-			if ((*STD_GETDATA(thread_list, ThreadFunctionInfo*, i))->m_is_finish)
-			{
-				DestroyThreadFunction(STD_GETDATA(thread_list, ThreadFunctionInfo*, i));
-				thread_manager->_Data->m_actual_size--;
-				thread_list->erase(thread_list, i);
-			}
+			DestroyTask(task);
+			task_list->erase(task_list, i);
 		}
-	} while (thread_manager->_Data->m_limit == thread_manager->_Data->m_actual_size);
+	}
+	ReleaseSRWLockExclusive(&thread_manager->_Data->m_task_list_lock);
+}
+
+static ThreadTask* AddNewTask(ThreadManager* thread_manager, void (*func)(void*), void* func_data, sfBool copy_data, size_t data_size)
+{
+	ThreadManager_Data* manager_data = thread_manager->_Data;
+	UpdateThreadManager(thread_manager);
+	if (copy_data)
+	{
+		void* tmp = calloc_d(char, data_size);
+		assert(tmp);
+		memcpy(tmp, func_data, data_size);
+		func_data = tmp;
+	}
+	ThreadTask* task = calloc_d(ThreadTask, 1);
+	assert(task);
+	task->func = func;
+	task->func_data = func_data;
+	task->m_data_is_copied = copy_data;
+	AcquireSRWLockExclusive(&manager_data->m_task_list_lock);
+	manager_data->m_task_list->push_back(manager_data->m_task_list, &task);
+	ReleaseSRWLockExclusive(&manager_data->m_task_list_lock);
+
+	AcquireSRWLockExclusive(&manager_data->m_lock);
+	while (manager_data->m_queue_count == manager_data->m_queue_capacity)
+		SleepConditionVariableSRW(&manager_data->m_slot_available, &manager_data->m_lock, INFINITE, 0);
+	size_t tail = (manager_data->m_queue_head + manager_data->m_queue_count) % manager_data->m_queue_capacity;
+	manager_data->m_queue[tail] = task;
+	manager_data->m_queue_count++;
+	InterlockedIncrement(&manager_data->m_pending);
+	WakeConditionVariable(&manager_data->m_task_available);
+	ReleaseSRWLockExclusive(&manager_data->m_lock);
+
+	return task;
 }
 
 static void AddNewThread(ThreadManager* thread_manager, void (*func)(void*), void* func_data, sfBool copy_data, size_t data_size)
 {
+	ThreadTask* task = AddNewTask(thread_manager, func, func_data, copy_data, data_size);
+	AcquireSRWLockExclusive(&thread_manager->_Data->m_task_list_lock);
+	task->m_is_released = sfTrue;
+	ReleaseSRWLockExclusive(&thread_manager->_Data->m_task_list_lock);
+}
+
+static void WaitTask(ThreadManager* thread_manager, const ThreadTask* task)
+{
+	ThreadManager_Data* manager_data = thread_manager->_Data;
+	AcquireSRWLockExclusive(&manager_data->m_lock);
+	while (!IsTaskFinished(task))
+		SleepConditionVariableSRW(&manager_data->m_task_done, &manager_data->m_lock, INFINITE, 0);
+	ReleaseSRWLockExclusive(&manager_data->m_lock);
+}
+
+static void ReleaseTask(ThreadManager* thread_manager, ThreadTask** task)
+{
+	if (!*task)
+		return;
+	AcquireSRWLockExclusive(&thread_manager->_Data->m_task_list_lock);
+	(*task)->m_is_released = sfTrue;
+	ReleaseSRWLockExclusive(&thread_manager->_Data->m_task_list_lock);
+	*task = NULL;
 	UpdateThreadManager(thread_manager);
+}
+
+static void PostToMainThread(ThreadManager* thread_manager, void (*func)(void*), void* func_data, sfBool copy_data, size_t data_size)
+{
+	ThreadManager_Data* manager_data = thread_manager->_Data;
 	if (copy_data)
 	{
-		void* tmp = TrackerCalloc(1, data_size, "C:\\Users\\y.grallan\\Documents\\BreakerEngine\\BreakerEngine\\ThreadManager.c", 101);
+		void* tmp = calloc_d(char, data_size);
 		assert(tmp);
 		memcpy(tmp, func_data, data_size);
 		func_data = tmp;
 	}
-	ThreadFunctionInfo* newThread = CreateThreadFunction(func, func_data);
-	thread_manager->_Data->m_actual_size++;
-	newThread->m_data_is_copied = copy_data;
-	thread_manager->_Data->m_thread_list->push_back(thread_manager->_Data->m_thread_list, &newThread);
-	sfThread_launch(newThread->m_thread);
+	MainThreadTask* task = calloc_d(MainThreadTask, 1);
+	assert(task);
+	task->func = func;
+	task->func_data = func_data;
+	task->m_data_is_copied = copy_data;
+
+	AcquireSRWLockExclusive(&manager_data->m_main_lock);
+	if (manager_data->m_main_tail)
+		manager_data->m_main_tail->m_next = task;
+	else
+		manager_data->m_main_head = task;
+	manager_data->m_main_tail = task;
+	ReleaseSRWLockExclusive(&manager_data->m_main_lock);
+}
+
+static MainThreadTask* PopMainThreadTask(ThreadManager_Data* manager_data)
+{
+	AcquireSRWLockExclusive(&manager_data->m_main_lock);
+	MainThreadTask* task = manager_data->m_main_head;
+	if (task)
+	{
+		manager_data->m_main_head = task->m_next;
+		if (!manager_data->m_main_head)
+			manager_data->m_main_tail = NULL;
+	}
+	ReleaseSRWLockExclusive(&manager_data->m_main_lock);
+	return task;
+}
+
+static size_t RunMainThreadTasks(ThreadManager* thread_manager, unsigned int budget_us)
+{
+	LARGE_INTEGER frequency, start, now;
+	size_t executed = 0;
+	MainThreadTask* task;
+
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&start);
+	LONGLONG budget = (LONGLONG)budget_us * frequency.QuadPart / 1000000;
+
+	while ((task = PopMainThreadTask(thread_manager->_Data)) != NULL)
+	{
+		task->func(task->func_data);
+		if (task->m_data_is_copied)
+			free_d(task->func_data);
+		free_d(task);
+		executed++;
+
+		QueryPerformanceCounter(&now);
+		if (budget_us && now.QuadPart - start.QuadPart >= budget)
+			break;
+	}
+	return executed;
 }
 
 static void DestroyThreadManager(ThreadManager** thread_manager)
 {
-	while ((*thread_manager)->_Data->m_actual_size)
-		UpdateThreadManager(*thread_manager);
+	ThreadManager_Data* manager_data = (*thread_manager)->_Data;
+
+	AcquireSRWLockExclusive(&manager_data->m_lock);
+	manager_data->m_is_running = sfFalse;
+	WakeAllConditionVariable(&manager_data->m_task_available);
+	ReleaseSRWLockExclusive(&manager_data->m_lock);
+
+	for (size_t i = 0; i < manager_data->m_limit; i++)
+	{
+		sfThread_wait(manager_data->m_workers[i]);
+		sfThread_destroy(manager_data->m_workers[i]);
+	}
+	RunMainThreadTasks(*thread_manager, 0);
 
-	(*thread_manager)->_Data->m_thread_list->destroy(&(*thread_manager)->_Data->m_thread_list);
-	free_d((*thread_manager)->_Data);
+	FOR_EACH_LIST(manager_data->m_task_list, ThreadTask*, i, it,
+		DestroyTask(it);
+		);
+	manager_data->m_task_list->destroy(&manager_data->m_task_list);
+	free_d(manager_data->m_queue);
+	free_d(manager_data->m_workers);
+	free_d(manager_data);
 	free_d(*thread_manager);
 	*thread_manager = NULL;
 }
@@ -128,13 +296,38 @@ ThreadManager* CreateThreadManager(size_t limit)
 	assert(tmp);
 	assert(tmp_data);
 
+	if (!limit)
+		limit = 1;
 	tmp_data->m_limit = limit;
-	tmp_data->m_thread_list = STD_LIST_CREATE(ThreadFunctionInfo*, 0);
-	tmp_data->m_actual_size = 0;
+	tmp_data->m_queue_capacity = limit * THREAD_MANAGER_QUEUE_PER_WORKER;
+	tmp_data->m_queue = calloc_d(ThreadTask*, tmp_data->m_queue_capacity);
+	tmp_data->m_workers = calloc_d(sfThread*, limit);
+	assert(tmp_data->m_queue);
+	assert(tmp_data->m_workers);
+	tmp_data->m_task_list = STD_LIST_CREATE(ThreadTask*, 0);
+	InitializeSRWLock(&tmp_data->m_task_list_lock);
+	InitializeSRWLock(&tmp_data->m_lock);
+	InitializeConditionVariable(&tmp_data->m_task_available);
+	InitializeConditionVariable(&tmp_data->m_slot_available);
+	InitializeConditionVariable(&tmp_data->m_task_done);
+	InitializeSRWLock(&tmp_data->m_main_lock);
+	tmp_data->m_is_running = sfTrue;
+
+	for (size_t i = 0; i < limit; i++)
+	{
+		tmp_data->m_workers[i] = sfThread_create(&WorkerFunction, tmp_data);
+		sfThread_launch(tmp_data->m_workers[i]);
+	}
 
 	tmp->_Data = tmp_data;
 
 	tmp->AddNewThread = &AddNewThread;
+	tmp->AddNewTask = &AddNewTask;
+	tmp->IsTaskFinished = &IsTaskFinished;
+	tmp->WaitTask = &WaitTask;
+	tmp->ReleaseTask = &ReleaseTask;
+	tmp->PostToMainThread = &PostToMainThread;
+	tmp->RunMainThreadTasks = &RunMainThreadTasks;
 	tmp->Update = &UpdateThreadManager;
 	tmp->Destroy = &DestroyThreadManager;
 	tmp->GetThreadCount = &GetThreadCount;
@@ -26,16 +26,30 @@
 
 /**
  * @file threadmanager.h
- * @brief This file defines the ThreadManager structure and functions for managing a multitude of thread.
+ * @brief This file defines the ThreadManager structure and functions for managing a pool of worker threads.
  *
- * This code shows how to create a ThreadManager that can be used for various purposes, such as resources loading or data treatment.
+ * The ThreadManager owns a fixed number of long-lived worker threads that pull tasks from a bounded queue.
+ * Threads are created once with the manager and reused for every task, so adding a task never pays the cost of a thread creation.
  *
  * @code
- * // Example usage of creating a new viewport:
- * ThreadManager* viewport = CreateThreadManager(5);
+ * // Example usage of creating a thread manager with 5 workers:
+ * ThreadManager* thread_manager = CreateThreadManager(5);
+ * ThreadTask* task = thread_manager->AddNewTask(thread_manager, &MyFunction, &my_data, sfTrue, sizeof(my_data));
+ * // Later, from the main loop:
+ * if (thread_manager->IsTaskFinished(task))
+ *     thread_manager->ReleaseTask(thread_manager, &task);
  * @endcode
  *
- * The above code creates a ThreadManager that can handle up to 5 threads simultaneous.
+ * The above code creates a ThreadManager with 5 workers and polls a task until it is done, without blocking the caller.
+ *
+ * Workers can also hand work back to the thread that owns the manager, e.g. a GPU upload that needs the GL context:
+ *
+ * @code
+ * // From a worker:
+ * thread_manager->PostToMainThread(thread_manager, &UploadTexture, &pixels, sfTrue, sizeof(pixels));
+ * // From the main loop, running the posted tasks for at most 2 ms:
+ * thread_manager->RunMainThreadTasks(thread_manager, 2000);
+ * @endcode
  */
 
 /**
@@ -44,55 +58,123 @@
  */
 typedef struct ThreadManager_Data ThreadManager_Data;
 
+/**
+ * @typedef ThreadTask
+ * @brief Opaque completion handle of a task pushed in a ThreadManager.
+ */
+typedef struct ThreadTask ThreadTask;
+
 /**
  * @typedef ThreadManager
- * @brief Manages a collection of threads and provides functionality for creating, updating, and destroying threads.
+ * @brief Manages a pool of worker threads and provides functionality for pushing, polling and waiting tasks.
  */
 typedef struct ThreadManager ThreadManager;
 
 /**
  * @struct ThreadManager
- * @brief Contains function pointers to manage threads, including adding, updating, and destroying threads.
+ * @brief Contains function pointers to manage the worker pool, including adding tasks, polling them and destroying the pool.
  */
 struct ThreadManager
 {
     ThreadManager_Data* _Data; /**< Internal data for managing threads. */
 
     /**
-     * @brief Adds a new thread to the manager.
+     * @brief Adds a new fire-and-forget task to the manager.
      * @param thread_manager Pointer to the ThreadManager object.
-     * @param func The function to be executed by the new thread.
+     * @param func The function to be executed by a worker thread.
      * @param func_data Data to pass to the function, if any.
      * @param copy_data Flag to indicate whether to copy the data or not.
      * @param data_size Size of the data to pass to the function.
      * 
-     * @warning if the thread manager is full, this function will block the main thread until the new task can be added. Update of the thread manager is automatically make in that case.
+     * @warning if the task queue is full, this function sleeps until a worker takes a task out of the queue. It can be called from any thread,
+     * but a worker must only add a bounded number of tasks, far under the 16 queue slots of each worker, or every worker may sleep on a full queue.
      */
     void (*AddNewThread)(ThreadManager* thread_manager, void (*func)(void*), void* func_data, sfBool copy_data, size_t data_size);
 
     /**
-     * @brief Gets the current number of threads managed by the ThreadManager.
+     * @brief Adds a new task to the manager and returns its completion handle.
+     * @param thread_manager Pointer to the ThreadManager object.
+     * @param func The function to be executed by a worker thread.
+     * @param func_data Data to pass to the function, if any.
+     * @param copy_data Flag to indicate whether to copy the data or not.
+     * @param data_size Size of the data to pass to the function.
+     * @return The completion handle, to give back with ReleaseTask once it is no longer needed.
+     *
+     * @warning Same blocking rule as AddNewThread when the task queue is full.
+     */
+    ThreadTask* (*AddNewTask)(ThreadManager* thread_manager, void (*func)(void*), void* func_data, sfBool copy_data, size_t data_size);
+
+    /**
+     * @brief Checks, without blocking, if a task has been fully executed.
+     * @param task The task handle returned by AddNewTask.
+     * @return sfTrue if the task is done, sfFalse otherwise.
+     */
+    sfBool (*IsTaskFinished)(const ThreadTask* task);
+
+    /**
+     * @brief Sleeps until a task has been fully executed.
      * @param thread_manager Pointer to the ThreadManager object.
-     * @return The number of threads managed by the manager.
+     * @param task The task handle returned by AddNewTask.
+     */
+    void (*WaitTask)(ThreadManager* thread_manager, const ThreadTask* task);
+
+    /**
+     * @brief Gives a task handle back to the manager. The task is freed as soon as it is done.
+     * @param thread_manager Pointer to the ThreadManager object.
+     * @param task Pointer to the task handle, set to NULL.
+     */
+    void (*ReleaseTask)(ThreadManager* thread_manager, ThreadTask** task);
+
+    /**
+     * @brief Queues a task to be executed by the thread that owns the manager. Can be called from any thread.
+     * @param thread_manager Pointer to the ThreadManager object.
+     * @param func The function to be executed on the owner thread.
+     * @param func_data Data to pass to the function, if any.
+     * @param copy_data Flag to indicate whether to copy the data or not.
+     * @param data_size Size of the data to pass to the function.
+     *
+     * @note Never blocks, the queue grows as needed. Tasks run in the order they were posted.
+     */
+    void (*PostToMainThread)(ThreadManager* thread_manager, void (*func)(void*), void* func_data, sfBool copy_data, size_t data_size);
+
+    /**
+     * @brief Runs the tasks posted with PostToMainThread until the queue is empty or the budget is spent.
+     * @param thread_manager Pointer to the ThreadManager object.
+     * @param budget_us Time budget in microseconds, 0 runs every queued task. At least one task runs per call.
+     * @return The number of tasks executed.
+     *
+     * @warning Must be called from the thread that owns the manager.
+     */
+    size_t (*RunMainThreadTasks)(ThreadManager* thread_manager, unsigned int budget_us);
+
+    /**
+     * @brief Gets the current number of tasks queued or running in the ThreadManager.
+     * @param thread_manager Pointer to the ThreadManager object.
+     * @return The number of tasks not finished yet.
      */
     size_t(*GetThreadCount)(ThreadManager* thread_manager);
 
     /**
-     * @brief Updates the state of all threads managed by the ThreadManager.
+     * @brief Frees the finished fire-and-forget and released tasks. Never blocks.
      * @param thread_manager Pointer to the ThreadManager object.
      */
     void (*Update)(ThreadManager* thread_manager);
 
     /**
-     * @brief Destroys the ThreadManager and releases all associated resources.
+     * @brief Waits for every queued task, joins the workers, runs the tasks still posted to the main thread and releases all associated resources.
      * @param thread_manager Pointer to the pointer of the ThreadManager object to destroy.
      */
     void (*Destroy)(ThreadManager** thread_manager);
 };
 
 /**
- * @brief Creates a new ThreadManager with a specified thread limit.
- * @param limit The maximum number of threads that can be handled by the manager.
+ * @brief Creates a new ThreadManager with a specified number of workers.
+ * @param limit The number of worker threads owned by the manager.
  * @return Pointer to the newly created ThreadManager object.
  */
 ThreadManager* CreateThreadManager(size_t limit);
+
+/**
+ * @brief The worker pool of the game, created by StartGame. The state inits and the scene loaders run on it, NULL before StartGame.
+ */
+ThreadManager* thread_manager;
@@ -23,6 +23,10 @@
 #include "Tools.h"
 #include "WindowManager.h"
 #include "MemoryManagement.h"
+#include "Profiler.h"
+#include "ResourceManifest.h"
+#include "PackFile.h"
+#include "ThreadManager.h"
 
 DECLARE_ALL_BASICS_OPERATION_VECTOR2_IN_C(sfVector2f, f, float)
 DECLARE_ALL_BASICS_OPERATION_VECTOR2_IN_C(sfVector2i, i, int)
@@ -112,106 +116,284 @@ char* StrAllocNCopy(const char* name)
 	return _strdup(name);
 }
 
-stdList* SearchFilesInfos(const char* path, const char* extension)
+static stdList* SearchLooseFilesInfos(const char* path, const char* extension)
 {
+	stdList* manifest_files = SearchManifestFilesInfos(path, extension);
+	if (manifest_files)
+		return manifest_files;
+
 	stdList* filesList = stdList_Create(sizeof(FilesInfo), 0);
 	Path Converted_Path = fs_create_path(path);
 	FOR_EACH_RECURSIVE_ITERATOR(Converted_Path, filesIterator,
-		Path tmpPath = *STD_GETDATA(filesIterator, Path, i);
-	Path tmpExtension = tmpPath.extension(&tmpPath);
-	if (strcmp(tmpExtension.path_data.m_path, extension) == 0)
+		const Path* tmpPath = STD_GETDATA(filesIterator, Path, i);
+	fs_path_view tmpView = fs_view(tmpPath->path_data.m_path);
+	if (fs_view_equals(fs_view_extension(tmpView), extension))
 	{
 		FilesInfo tmpFilesInfos;
-		strcpy_s(tmpFilesInfos.m_name, MAX_PATH_SIZE, tmpPath.stem(&tmpPath).path_data.m_path);
-		strcpy_s(tmpFilesInfos.m_path, MAX_PATH_SIZE, tmpPath.path_data.m_path);
+		fs_view_copy(fs_view_stem(tmpView), tmpFilesInfos.m_name, MAX_PATH_SIZE);
+		strcpy_s(tmpFilesInfos.m_path, MAX_PATH_SIZE, tmpPath->path_data.m_path);
+		tmpFilesInfos.m_size = (unsigned long long)GetFileSizeCustom(tmpFilesInfos.m_path);
 		filesList->push_back(filesList, &tmpFilesInfos);
 	}
 		)
 		return filesList;
 }
 
-void __LoadWithThread(void* thread_infos)
+stdList* SearchFilesInfos(const char* path, const char* extension)
 {
-	thread_info* infos = thread_infos;
-	for (int it = infos->start; it < infos->end; it++)
+	stdList* loose_files = SearchLooseFilesInfos(path, extension);
+	stdList* packed_files = SearchPackFilesInfos(path, extension);
+	if (!packed_files)
+		return loose_files;
+
+	// The packed copy of a file is the one loaded, the files added or edited after the pack was built only exist loose.
+	for (int i = 0; i < loose_files->size(loose_files); i++)
 	{
-		infos->func(STD_GETDATA(infos->files_info, FilesInfo, it)->m_path);
-		*infos->currentSize += 1;
-		*infos->progressValue = *infos->currentSize / *infos->totalSize;
+		const FilesInfo* loose_file = STD_GETDATA(loose_files, FilesInfo, i);
+		size_t packed_size;
+		if (!GetPackedFile(loose_file->m_path, &packed_size))
+			packed_files->push_back(packed_files, loose_file);
 	}
+	loose_files->destroy(&loose_files);
+	return packed_files;
 }
 
-void __LoadScene(const char* scene, const char* extension, const char* type, float* progressValue, void(*func)(const char*))
+static __declspec(thread) CancelToken* tls_cancel_token = NULL;
+
+void CancelLoad(CancelToken* token)
 {
-	NEW_CHAR(path, MAX_PATH_SIZE)
-		strcpy_s(path, MAX_PATH_SIZE, resource_directory);
+	InterlockedExchange(&token->m_is_cancelled, 1);
+}
+
+void ResetCancelToken(CancelToken* token)
+{
+	InterlockedExchange(&token->m_is_cancelled, 0);
+}
+
+sfBool IsLoadCancelled(const CancelToken* token)
+{
+	for (; token; token = token->m_parent)
+		if (token->m_is_cancelled)
+			return sfTrue;
+	return sfFalse;
+}
+
+void SetThreadCancelToken(CancelToken* token)
+{
+	tls_cancel_token = token;
+}
+
+CancelToken* GetThreadCancelToken(void)
+{
+	return tls_cancel_token;
+}
+
+// Taking the lock makes sure a waiter is either before its check or asleep.
+static void WakeCriticalWaiters(SceneLoader* loader)
+{
+	AcquireSRWLockExclusive(&loader->m_lock);
+	WakeAllConditionVariable(&loader->m_critical_done);
+	ReleaseSRWLockExclusive(&loader->m_lock);
+}
+
+// Runs on a worker of thread_manager, shared with other tasks, so it neither names nor releases the thread in the profiler.
+static void SceneLoaderTask(void* data)
+{
+	SceneLoader* loader = data;
+	for (LONG it = InterlockedIncrement(&loader->m_next_job) - 1; it < loader->m_job_count; it = InterlockedIncrement(&loader->m_next_job) - 1)
+	{
+		if (IsLoadCancelled(&loader->m_cancel_token))
+		{
+			WakeCriticalWaiters(loader);
+			break;
+		}
+		SceneLoadJob* job = loader->m_order[it];
+		PROFILE_ZONE("LoadFile", job->m_func(job->m_file_info.m_path, &loader->m_cancel_token););
+		InterlockedExchangeAdd64(&loader->m_progress->m_loaded_bytes, (LONG64)job->m_file_info.m_size);
+		if (job->m_is_critical && InterlockedDecrement(&loader->m_critical_left) == 0)
+			WakeCriticalWaiters(loader);
+	}
+}
+
+static void BuildScenePath(char* path, const char* scene, const char* type)
+{
+	strcpy_s(path, MAX_PATH_SIZE, resource_directory);
 	strcat_s(path, MAX_PATH_SIZE, "/");
 	strcat_s(path, MAX_PATH_SIZE, scene);
 	strcat_s(path, MAX_PATH_SIZE, "/");
 	strcat_s(path, MAX_PATH_SIZE, type);
+}
+
+// Critical jobs first, then the biggest files.
+static int CompareSceneLoadJobs(const void* a, const void* b)
+{
+	const SceneLoadJob* job_a = *(const SceneLoadJob* const*)a;
+	const SceneLoadJob* job_b = *(const SceneLoadJob* const*)b;
+	if (job_a->m_is_critical != job_b->m_is_critical)
+		return job_a->m_is_critical ? -1 : 1;
+	if (job_a->m_file_info.m_size != job_b->m_file_info.m_size)
+		return job_a->m_file_info.m_size > job_b->m_file_info.m_size ? -1 : 1;
+	return 0;
+}
+
+void __InitSceneLoader(SceneLoader* loader, LoadingProgress* progress, CancelToken* cancel_token)
+{
+	memset(loader, 0, sizeof(SceneLoader));
+	loader->m_jobs = STD_LIST_CREATE(SceneLoadJob, 0);
+	loader->m_progress = progress;
+	loader->m_cancel_token.m_parent = cancel_token;
+	InitializeSRWLock(&loader->m_lock);
+	InitializeConditionVariable(&loader->m_critical_done);
+}
+
+void __LoadScene(const char* scene, const char* extension, const char* type, SceneLoader* loader, void(*func)(const char*, const CancelToken*))
+{
+	NEW_CHAR(path, MAX_PATH_SIZE)
+		BuildScenePath(path, scene, type);
 
-	*progressValue = 0.0f;
 	Path tmp_path = fs_create_path(path);
-	if (tmp_path.exist(&tmp_path))
+	if (tmp_path.exist(&tmp_path) || IsPackedDirectory(path))
 	{
-		stdList* files_infos = SearchFilesInfos(tmp_path.path_data.m_path, extension);
-		if (files_infos->size(files_infos) == 0)
-		{
+		int queued_count = loader->m_jobs->size(loader->m_jobs);
+		LONG64 total_size = 0;
+		FOR_EACH_TEMP_LIST(files_infos, FilesInfo, SearchFilesInfos(tmp_path.path_data.m_path, extension),
+			SceneLoadJob job;
+			job.m_file_info = *STD_GETDATA(files_infos, FilesInfo, i);
+			job.m_func = func;
+			job.m_is_critical = sfFalse;
+			loader->m_jobs->push_back(loader->m_jobs, &job);
+			total_size += (LONG64)job.m_file_info.m_size;
+			)
+		InterlockedExchangeAdd64(&loader->m_progress->m_total_bytes, total_size);
+		if (loader->m_jobs->size(loader->m_jobs) == queued_count)
 			printf_d("%s folder is empty\n", path);
-			files_infos->destroy(&files_infos);
-			return;
-		}
+	}
+	else
+	{
+		printf_d("No %s directory found\n\n", path);
+	}
+}
 
-		float totalSize = 0.f, currentSize = 0.f;
+void __StartSceneLoader(SceneLoader* loader)
+{
+	loader->m_job_count = (LONG)loader->m_jobs->size(loader->m_jobs);
+	if (!loader->m_job_count)
+		return;
 
-		FOR_EACH_LIST(files_infos, FilesInfo, i, it,
-			totalSize ++;
-		);
+	loader->m_order = calloc_d(SceneLoadJob*, loader->m_job_count);
+	assert(loader->m_order);
+	LONG critical_count = 0;
+	for (LONG i = 0; i < loader->m_job_count; i++)
+	{
+		loader->m_order[i] = STD_GETDATA(loader->m_jobs, SceneLoadJob, i);
+		critical_count += loader->m_order[i]->m_is_critical ? 1 : 0;
+	}
+	qsort(loader->m_order, (size_t)loader->m_job_count, sizeof(SceneLoadJob*), &CompareSceneLoadJobs);
+	loader->m_critical_left = critical_count;
 
-		int nbrThread = files_infos->size(files_infos) < MAX_THREAD ? files_infos->size(files_infos) : MAX_THREAD;
-		int block_size = files_infos->size(files_infos) / nbrThread;
+	if (!thread_manager)
+	{
+		SceneLoaderTask(loader);
+		return;
+	}
+	loader->m_task_count = loader->m_job_count < MAX_THREAD ? (int)loader->m_job_count : MAX_THREAD;
+	for (int i = 0; i < loader->m_task_count; i++)
+		loader->m_tasks[i] = thread_manager->AddNewTask(thread_manager, &SceneLoaderTask, loader, sfFalse, 0);
+}
 
+sfBool __WaitCriticalSceneLoads(SceneLoader* loader)
+{
+	AcquireSRWLockExclusive(&loader->m_lock);
+	while (loader->m_critical_left > 0 && !IsLoadCancelled(&loader->m_cancel_token))
+		SleepConditionVariableSRW(&loader->m_critical_done, &loader->m_lock, INFINITE, 0);
+	ReleaseSRWLockExclusive(&loader->m_lock);
+	return IsLoadCancelled(&loader->m_cancel_token) ? sfFalse : sfTrue;
+}
 
-		stdList* thread_list = STD_LIST_CREATE(sfThread*, 0);
-		stdList* thread_infos = STD_LIST_CREATE(thread_info, 0);
+void __FinishSceneLoader(SceneLoader* loader)
+{
+	if (!loader->m_jobs)
+		return;
+	// Once thread_manager is destroyed, its tasks have all run and their handles are freed.
+	for (int i = 0; i < loader->m_task_count && thread_manager; i++)
+	{
+		thread_manager->WaitTask(thread_manager, loader->m_tasks[i]);
+		thread_manager->ReleaseTask(thread_manager, &loader->m_tasks[i]);
+	}
+	if (loader->m_order)
+		free_d(loader->m_order);
+	loader->m_jobs->destroy(&loader->m_jobs);
+	memset(loader, 0, sizeof(SceneLoader));
+}
 
-		for (int i = 0; i < nbrThread; i++)
-		{
-			int start = i * block_size;
-			int end = (i == nbrThread - 1) ? files_infos->size(files_infos) : (i + 1) * block_size;
-
-			thread_info tmp_thread_info = {
-			.end = end,
-			.start = start,
-			.files_info = files_infos,
-			.func = func,
-			.progressValue = progressValue,
-			.currentSize = &currentSize,
-			.totalSize = &totalSize
-			};
-
-			thread_infos->push_back(thread_infos, &tmp_thread_info);
-			sfThread* tmp_thread = NULL;
-			thread_list->push_back(thread_list, &tmp_thread);
-			*STD_GETDATA(thread_list, sfThread*, i) = sfThread_create(&__LoadWithThread, STD_GETDATA(thread_infos, thread_info, i));
-			sfThread_launch(*STD_GETDATA(thread_list, sfThread*, i));
+typedef struct AsyncLoad AsyncLoad;
+struct AsyncLoad
+{
+	volatile LONG* m_load_state;
+	void (*m_load)(void* resource);
+	void* m_resource;
+};
 
-		}
+// Created by the first asynchronous Get, which can come from any thread.
+static ThreadManager* async_loader;
+static SRWLOCK async_loader_lock = SRWLOCK_INIT;
 
-		FOR_EACH_LIST(thread_list, sfThread*, i, tmp,
-			sfThread_wait(*tmp);
-		sfThread_destroy(*tmp);
-			)
+static void AsyncLoadTask(void* data)
+{
+	AsyncLoad* async_load = data;
+	PROFILE_ZONE("AsyncLoad", async_load->m_load(async_load->m_resource););
+	InterlockedExchange(async_load->m_load_state, RESOURCE_LOADED);
+}
+
+sfBool __IsLoadedEagerly(const char* path)
+{
+	if (resource_loading_mode == RESOURCE_LOADING_EAGER)
+		return sfTrue;
+	NEW_CHAR(name, MAX_PATH_SIZE)
+		fs_stem(path, name, MAX_PATH_SIZE);
+	ToLower(name);
+	return strcmp(name, "placeholder") == 0;
+}
+
+sfBool __RequireResource(volatile LONG* load_state, void (*load)(void* resource), void* resource)
+{
+	LONG state = InterlockedCompareExchange(load_state, RESOURCE_LOADING, RESOURCE_UNLOADED);
+	if (state == RESOURCE_LOADED)
+		return sfTrue;
+
+	if (resource_loading_mode == RESOURCE_LOADING_ASYNC)
+	{
+		if (state == RESOURCE_UNLOADED)
+		{
+			AsyncLoad async_load = { load_state, load, resource };
+			AcquireSRWLockExclusive(&async_loader_lock);
+			if (!async_loader)
+				async_loader = CreateThreadManager(ASYNC_LOAD_THREAD_COUNT);
+			async_loader->AddNewThread(async_loader, &AsyncLoadTask, &async_load, sfTrue, sizeof(AsyncLoad));
+			ReleaseSRWLockExclusive(&async_loader_lock);
+		}
+		return sfFalse;
+	}
 
-			thread_list->destroy(&thread_list);
-		thread_infos->destroy(&thread_infos);
-		files_infos->destroy(&files_infos);
+	if (state == RESOURCE_UNLOADED)
+	{
+		PROFILE_ZONE("LazyLoad", load(resource););
+		InterlockedExchange(load_state, RESOURCE_LOADED);
 	}
 	else
 	{
-		printf_d("No %s directory found\n\n", path);
+		while (InterlockedCompareExchange(load_state, RESOURCE_LOADED, RESOURCE_LOADED) != RESOURCE_LOADED)
+			SwitchToThread();
 	}
-	*progressValue = 1.0f;
+	return sfTrue;
+}
+
+void __WaitAsyncLoads(void)
+{
+	AcquireSRWLockExclusive(&async_loader_lock);
+	if (async_loader)
+		async_loader->Destroy(&async_loader);
+	ReleaseSRWLockExclusive(&async_loader_lock);
 }
 
 void UpdateKeyAndMouseState(void)
@@ -575,13 +757,8 @@ void DebugPrint(const char* const string, ...)
 
 float GetFileSizeCustom(const char* filePath)
 {
-	FILE* file = fopen(filePath, "r");
-	if (fseek(file, 0, SEEK_END) < 0)
-	{
-		fclose(file);
+	WIN32_FILE_ATTRIBUTE_DATA file_data;
+	if (!GetFileAttributesExA(filePath, GetFileExInfoStandard, &file_data))
 		return 0.f;
-	}
-	long size = ftell(file);
-	fclose(file);
-	return (float)size;
+	return (float)(((unsigned long long)file_data.nFileSizeHigh << 32) | file_data.nFileSizeLow);
 }
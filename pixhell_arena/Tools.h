@@ -28,6 +28,7 @@
 
 #include "stdString.h"
 #include "FileSystem.h"
+#include "ThreadManager.h"
 #include "SFML/Graphics.h"
 #include "SFML/Audio.h"
 #include "SFML/System.h"
@@ -64,12 +65,26 @@ struct Transform
  */
 float DeltaTime;
 
+/**
+ * @def RenderAlpha
+ * @brief Fraction of a fixed simulation step left in the accumulator when rendering, from 0 to 1.
+ *
+ * Render functions use it to interpolate between the previous and the current simulation state.
+ */
+float RenderAlpha;
+
 /**
  * @def resource_directory
  * @brief The directory containing the game resources.
  */
 char resource_directory[MAX_PATH_SIZE];
 
+/**
+ * @def ASYNC_LOAD_THREAD_COUNT
+ * @brief Number of threads loading the global resources requested in RESOURCE_LOADING_ASYNC mode.
+ */
+#define ASYNC_LOAD_THREAD_COUNT 2
+
 /**
  * @def MAX_THREAD
  * @brief The maximum number of threads allowed.
@@ -570,24 +585,53 @@ float fClamp(float value, float min, float max);
  */
 #define printf_d(string, ...) DebugPrint(string, __VA_ARGS__)
 
- /**
-  * @brief Structure for managing thread information.
-  */
-typedef struct Thread_Info thread_info;
+/**
+ * @brief Structure for tracking the loading progress of a scene in bytes.
+ */
+typedef struct LoadingProgress LoadingProgress;
+
+/**
+ * @struct LoadingProgress
+ * @brief Byte counters shared by every loader thread, only modified with the Interlocked functions.
+ */
+struct LoadingProgress
+{
+	volatile LONG64 m_loaded_bytes; /**< Bytes of the files already loaded. */
+	volatile LONG64 m_total_bytes; /**< Bytes of every file to load. */
+};
+
+/**
+ * @enum ResourceLoadingMode
+ * @brief Enumerates the ways the global resources of the ALL folder are loaded.
+ */
+typedef enum ResourceLoadingMode ResourceLoadingMode;
+enum ResourceLoadingMode
+{
+	RESOURCE_LOADING_EAGER, /**< Everything is loaded by InitResourcesManager. */
+	RESOURCE_LOADING_LAZY, /**< Only the file list is read by InitResourcesManager, each resource is loaded by its first Get call. */
+	RESOURCE_LOADING_ASYNC /**< Like RESOURCE_LOADING_LAZY, but the first Get calls return the placeholder while the resource loads in the background. */
+};
+
+/**
+ * @brief The loading mode of the global resources, set with SetResourceLoadingMode before InitResourcesManager.
+ */
+ResourceLoadingMode resource_loading_mode;
+
+/**
+ * @brief sfTrue when the resources are loaded without a graphics context, set with SetHeadlessResources before InitResourcesManager.
+ */
+sfBool is_headless_resources;
 
 /**
- * @struct Thread_Info
- * @brief Contains information about the files to process in a thread.
+ * @enum ResourceLoadState
+ * @brief Enumerates the states of a global resource, stored in a volatile LONG and only modified with the Interlocked functions.
  */
-struct Thread_Info
+typedef enum ResourceLoadState ResourceLoadState;
+enum ResourceLoadState
 {
-	stdList* files_info; /**< The list of files to process. */
-	int start; /**< The starting index for processing. */
-	int end; /**< The ending index for processing. */
-	float* progressValue; /**< Pointer to track the progress value. */
-	float* totalSize; /**< Pointer to track the total size of the files. */
-	float* currentSize; /**< Pointer to track the current size during processing. */
-	void (*func)(const char*); /**< The function to apply to each file. */
+	RESOURCE_UNLOADED, /**< Listed but not loaded yet. */
+	RESOURCE_LOADING, /**< Being loaded by a thread. */
+	RESOURCE_LOADED /**< Ready to be used. */
 };
 
 /**
@@ -642,6 +686,8 @@ char* StrAllocNCopy(const char* name);
 
 /**
  * @brief Searches for files with a specified extension in a given path.
+ * Answered by the resource manifest when path is inside the loaded resources directory, see LoadResourceManifest.
+ * When a pack is mounted, the files of the pack are merged with the loose files it does not hold.
  * @param path The directory path to search.
  * @param extension The file extension to search for.
  * @return A list of file information.
@@ -661,6 +707,64 @@ struct FilesInfo
 {
 	char m_name[MAX_PATH_SIZE]; /**< The name of the file. */
 	char m_path[MAX_PATH_SIZE]; /**< The full path to the file. */
+	unsigned long long m_size; /**< The size of the file in bytes. */
+};
+
+/**
+ * @brief Structure for stopping a load running on another thread.
+ */
+typedef struct CancelToken CancelToken;
+
+/**
+ * @struct CancelToken
+ * @brief Checked by the scene loaders between two files, a cancelled load stops at the next file and releases what it loaded.
+ */
+struct CancelToken
+{
+	volatile LONG m_is_cancelled; /**< Non zero once CancelLoad was called, only modified with the Interlocked functions. */
+	const CancelToken* m_parent; /**< Token whose cancellation also cancels this one, NULL if none. */
+};
+
+/**
+ * @brief Structure for a file queued on a scene loader.
+ */
+typedef struct SceneLoadJob SceneLoadJob;
+
+/**
+ * @struct SceneLoadJob
+ * @brief A file of a scene and the function loading it.
+ */
+struct SceneLoadJob
+{
+	FilesInfo m_file_info; /**< The file to load. */
+	void (*m_func)(const char*, const CancelToken*); /**< The function loading the file, it releases the file instead of keeping it if the load was cancelled meanwhile. */
+	sfBool m_is_critical; /**< sfTrue if the scene cannot be shown before the file is loaded. */
+};
+
+/**
+ * @brief Structure for loading the files of a scene on a pool of threads, highest priority first.
+ */
+typedef struct SceneLoader SceneLoader;
+
+/**
+ * @struct SceneLoader
+ * @brief Files of a scene queued by __LoadScene, then loaded by up to MAX_THREAD tasks of thread_manager taking the next job in priority order.
+ *
+ * The critical jobs are loaded first, then the biggest files, so a thread never starts a big file while the others are idle at the end.
+ */
+struct SceneLoader
+{
+	stdList* m_jobs; /**< SceneLoadJob queued by __LoadScene. */
+	SceneLoadJob** m_order; /**< The jobs sorted by priority, built by __StartSceneLoader. */
+	LONG m_job_count; /**< Number of jobs in m_order. */
+	volatile LONG m_next_job; /**< Index in m_order of the next job to load, only modified with the Interlocked functions. */
+	volatile LONG m_critical_left; /**< Critical jobs not loaded yet, only modified with the Interlocked functions. */
+	LoadingProgress* m_progress; /**< Progress increased by the size of each loaded file. */
+	CancelToken m_cancel_token; /**< Token of this load only, stopping the loader at the next file. Its parent is the token given to __InitSceneLoader. */
+	ThreadTask* m_tasks[MAX_THREAD]; /**< The loader tasks pushed on thread_manager. */
+	int m_task_count; /**< Number of loader tasks pushed. */
+	SRWLOCK m_lock; /**< Protects the wait on m_critical_done. */
+	CONDITION_VARIABLE m_critical_done; /**< Signaled when m_critical_left reaches 0. */
 };
 
 /**
@@ -723,27 +827,104 @@ void DebugPrint(const char* const string, ...);
 float GetFileSizeCustom(const char* filePath);
 
 /**
- * @brief Loads files in a separate thread.
- *
- * This function loads the specified files asynchronously in a separate thread to avoid blocking the main thread.
+ * @brief Cancels the loads using a token, they stop at the next file.
+ * @param token The token to cancel.
+ */
+void CancelLoad(CancelToken* token);
+
+/**
+ * @brief Makes a cancelled token usable for a new load.
+ * @param token The token to reset.
+ */
+void ResetCancelToken(CancelToken* token);
+
+/**
+ * @brief Tells if the loads using a token were cancelled.
+ * @param token The token to check, NULL is never cancelled.
+ * @return sfTrue if CancelLoad was called on the token or one of its parents since their last reset.
+ */
+sfBool IsLoadCancelled(const CancelToken* token);
+
+/**
+ * @brief Sets the token of the loads started by the calling thread, e.g. the LoadScene of a state Init.
+ * @param token The token, NULL for loads that cannot be cancelled.
+ */
+void SetThreadCancelToken(CancelToken* token);
+
+/**
+ * @brief Retrieves the token set by SetThreadCancelToken on the calling thread.
+ * @return The token, NULL if the thread has none.
+ */
+CancelToken* GetThreadCancelToken(void);
+
+/**
+ * @brief Prepares an empty scene loader.
+ * @param loader The loader to prepare.
+ * @param progress Progress increased by the size of each loaded file, its total is increased by each queued file.
+ * @param cancel_token Token also stopping the loader at the next file, NULL if only the token of the loader can.
  *
- * @param thread_infos The information about the thread to load the files.
+ * @note The loader keeps its own token, so resetting cancel_token for a new load does not resume a cancelled one still finishing.
  */
-void __LoadWithThread(void* thread_infos);
+void __InitSceneLoader(SceneLoader* loader, LoadingProgress* progress, CancelToken* cancel_token);
 
 /**
- * @brief Loads a scene from a file.
+ * @brief Queues the files of a category of a scene on a loader, nothing is loaded before __StartSceneLoader.
  *
- * This function loads a scene from the specified file path, with support for different file types and extensions.
- * A callback function can be provided to perform actions after the scene is loaded.
+ * Every category of a scene is queued before the first file loads, so the progress never goes backward.
+ * The jobs are not critical, mark the ones the scene needs first in loader->m_jobs before starting the loader.
  *
  * @param scene The scene to load.
- * @param extension The file extension of the scene.
- * @param type The type of scene to load.
- * @param progressValue A pointer to track the progress of the loading.
- * @param func A callback function to execute after loading the scene.
+ * @param extension The file extension of the files to load.
+ * @param type The resource directory of the scene to search.
+ * @param loader The loader the files are queued on.
+ * @param func The function loading each file, called from the loader threads with the token of the loader.
+ */
+void __LoadScene(const char* scene, const char* extension, const char* type, SceneLoader* loader, void (*func)(const char*, const CancelToken*));
+
+/**
+ * @brief Sorts the queued files by priority and pushes the loader tasks on thread_manager. Without thread_manager, the files are loaded before it returns.
+ * @param loader The loader to start.
+ */
+void __StartSceneLoader(SceneLoader* loader);
+
+/**
+ * @brief Waits until every critical file of a started loader is loaded, the other files keep loading in the background.
+ * @param loader The loader to wait for.
+ * @return sfTrue once the critical files are loaded, sfFalse if the loader was cancelled first.
+ */
+sfBool __WaitCriticalSceneLoads(SceneLoader* loader);
+
+/**
+ * @brief Waits until every file of a loader is loaded, then frees the loader. Does nothing on a loader already finished.
+ * @param loader The loader to finish.
+ */
+void __FinishSceneLoader(SceneLoader* loader);
+
+/**
+ * @brief Tells if a global resource must be loaded by InitResourcesManager.
+ * Every resource is in RESOURCE_LOADING_EAGER mode, and the placeholders always are since they stand in for the resources not loaded yet.
+ * @param path The path of the resource file.
+ * @return sfTrue if the resource must be loaded now, sfFalse if it is only listed.
+ */
+sfBool __IsLoadedEagerly(const char* path);
+
+/**
+ * @brief Makes sure a global resource is loaded before it is used, following resource_loading_mode.
+ *
+ * The first call loads the resource on the calling thread, or queues it on the async loaders in RESOURCE_LOADING_ASYNC mode.
+ * A thread asking for a resource another thread is loading waits for it, except in RESOURCE_LOADING_ASYNC mode.
+ *
+ * @param load_state The load state of the resource.
+ * @param load The function loading the resource, called with resource.
+ * @param resource The resource entry, must stay valid until it is loaded.
+ * @return sfTrue if the resource is loaded, sfFalse if it is still loading in the background and the placeholder must be used.
+ */
+sfBool __RequireResource(volatile LONG* load_state, void (*load)(void* resource), void* resource);
+
+/**
+ * @brief Waits for every resource queued on the async loaders, then stops them.
  */
-void __LoadScene(const char* scene, const char* extension, const char* type, float* progressValue, void (*func)(const char*));
+void __WaitAsyncLoads(void);
 
 /**
  * @brief Updates the key and mouse states.
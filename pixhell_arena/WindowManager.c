@@ -51,6 +51,7 @@ struct WindowManager_Data
 	stdList* m_custom_param_list;
 	stdList* m_sound_list;
 	Clock* m_window_clock;
+	FramePacer* m_frame_pacer;
 	sfView* m_custom_view;
 
 	sfVector2u m_size;
@@ -266,6 +267,17 @@ static void Display(const WindowManager* window)
 	sfSprite_setTexture(window->_Data->m_renderer, sfRenderTexture_getTexture(window->_Data->m_render_texture), sfTrue);
 	sfRenderWindow_drawSprite(window->_Data->m_window, window->_Data->m_renderer, NULL);
 	sfRenderWindow_display(window->_Data->m_window);
+	window->_Data->m_frame_pacer->WaitNextFrame(window->_Data->m_frame_pacer);
+}
+
+static void SetTargetFrameRate(const WindowManager* window, unsigned int frame_rate)
+{
+	window->_Data->m_frame_pacer->SetTargetFrameRate(window->_Data->m_frame_pacer, frame_rate);
+}
+
+static FrameStats GetFrameStats(const WindowManager* window)
+{
+	return window->_Data->m_frame_pacer->GetStats(window->_Data->m_frame_pacer);
 }
 
 static void WindowManagerDrawSprite(const WindowManager* window, const sfSprite* object, const sfRenderStates* state)
@@ -322,6 +334,61 @@ static void WindowManagerDrawParticles(const WindowManager* window, const Partic
 	sfRenderTexture_drawParticles(window->_Data->m_render_texture, object, state);
 }
 
+#pragma region HEADLESS
+static sfBool HeadlessPollEvent(const WindowManager* window)
+{
+	return sfFalse;
+}
+
+static sfVector2f HeadlessGetMousePos(const WindowManager* window)
+{
+	return sfVector2f_Create(0.f, 0.f);
+}
+
+static void HeadlessToggleFullscreen(const WindowManager* window)
+{
+}
+
+static void HeadlessSetView(const WindowManager* window, sfView* view)
+{
+	window->_Data->m_custom_view = view;
+}
+
+static void HeadlessSetDefaultView(const WindowManager* window)
+{
+}
+
+static sfView* HeadlessGetDefaultView(const WindowManager* window)
+{
+	return NULL;
+}
+
+static void HeadlessClear(const WindowManager* window, sfColor color)
+{
+}
+
+static void HeadlessDisplay(const WindowManager* window)
+{
+}
+
+#define HEADLESS_DRAW(name, type) static void HeadlessDraw##name(const WindowManager* window, const type* object, const sfRenderStates* state) {}
+HEADLESS_DRAW(Sprite, sfSprite)
+HEADLESS_DRAW(Text, sfText)
+HEADLESS_DRAW(Shape, sfShape)
+HEADLESS_DRAW(CircleShape, sfCircleShape)
+HEADLESS_DRAW(ConvexShape, sfConvexShape)
+HEADLESS_DRAW(RectangleShape, sfRectangleShape)
+HEADLESS_DRAW(VertexArray, sfVertexArray)
+HEADLESS_DRAW(VertexBuffer, sfVertexBuffer)
+HEADLESS_DRAW(Animation, Animation)
+HEADLESS_DRAW(Particles, Particles)
+#undef HEADLESS_DRAW
+
+static void HeadlessDrawPrimitives(const WindowManager* window, const sfVertex* object, size_t vertexCount, sfPrimitiveType type, const sfRenderStates* state)
+{
+}
+#pragma endregion
+
 static void DestroyWindowManager(WindowManager** window)
 {
 	DestroySound(*window);
@@ -329,33 +396,19 @@ static void DestroyWindowManager(WindowManager** window)
 	WindowManager* tmp = *window;
 	free_d(tmp->_Data->m_title);
 	tmp->_Data->m_window_clock->destroy(&tmp->_Data->m_window_clock);
-	sfRenderWindow_close(tmp->_Data->m_window);
-	sfRenderWindow_destroy(tmp->_Data->m_window);
+	tmp->_Data->m_frame_pacer->Destroy(&tmp->_Data->m_frame_pacer);
+	if (tmp->_Data->m_window)
+	{
+		sfRenderWindow_close(tmp->_Data->m_window);
+		sfRenderWindow_destroy(tmp->_Data->m_window);
+	}
 	free_d(tmp->_Data);
 	free_d(tmp);
 	*window = NULL;
 }
 
-
-WindowManager* CreateWindowManager(const unsigned int width, const unsigned int height, const char* title, const sfUint32 style, const sfContextSettings* settings)
+static void SetWindowManagerFunctions(WindowManager* window_manager)
 {
-	WindowManager* window_manager = calloc_d(WindowManager, 1);
-	assert(window_manager);
-	WindowManager_Data* window_manager_data = calloc_d(WindowManager_Data, 1);
-	assert(window_manager_data);
-	window_manager_data->m_size = (sfVector2u){ MIN(width,sfVideoMode_getDesktopMode().width), MIN(height, sfVideoMode_getDesktopMode().height) };
-	window_manager_data->m_base_size = (sfVector2u){ width, height };
-	window_manager_data->m_render_texture = sfRenderTexture_create(width, height, sfFalse);
-	window_manager_data->m_renderer = sfSprite_create();
-	window_manager_data->m_window = sfRenderWindow_create((sfVideoMode) { window_manager_data->m_size.x, window_manager_data->m_size.y, sfVideoMode_getDesktopMode().bitsPerPixel }, title, style, settings);
-	window_manager_data->m_style = style;
-	window_manager_data->m_title = StrAllocNCopy(title);
-	window_manager_data->m_fullscreen = sfFullscreen & style ? sfTrue : sfFalse;
-	window_manager_data->m_custom_param_list = STD_LIST_CREATE(CustomParam, 0);
-	window_manager_data->m_sound_list = STD_LIST_CREATE(SoundInfo, 0);
-	window_manager_data->m_window_clock = CreateClock();
-	window_manager->_Data = window_manager_data;
-
 	window_manager->Destroy = &DestroyWindowManager;
 	window_manager->GetEvent = &GetWindowEvent;
 	window_manager->GetSize = &GetWindowManagerSize;
@@ -380,6 +433,8 @@ WindowManager* CreateWindowManager(const unsigned int width, const unsigned int
 	window_manager->GetMousePos = &GetMousePos;
 	window_manager->Clear = &Clear;
 	window_manager->Display = &Display;
+	window_manager->SetTargetFrameRate = &SetTargetFrameRate;
+	window_manager->GetFrameStats = &GetFrameStats;
 
 	window_manager->DrawSprite = &WindowManagerDrawSprite;
 	window_manager->DrawText = &WindowManagerDrawText;
@@ -392,6 +447,30 @@ WindowManager* CreateWindowManager(const unsigned int width, const unsigned int
 	window_manager->DrawPrimitives = &WindowManagerDrawPrimitives;
 	window_manager->DrawAnimation = &WindowManagerDrawAnimation;
 	window_manager->DrawParticles = &WindowManagerDrawParticles;
+}
+
+
+WindowManager* CreateWindowManager(const unsigned int width, const unsigned int height, const char* title, const sfUint32 style, const sfContextSettings* settings)
+{
+	WindowManager* window_manager = calloc_d(WindowManager, 1);
+	assert(window_manager);
+	WindowManager_Data* window_manager_data = calloc_d(WindowManager_Data, 1);
+	assert(window_manager_data);
+	window_manager_data->m_size = (sfVector2u){ MIN(width,sfVideoMode_getDesktopMode().width), MIN(height, sfVideoMode_getDesktopMode().height) };
+	window_manager_data->m_base_size = (sfVector2u){ width, height };
+	window_manager_data->m_render_texture = sfRenderTexture_create(width, height, sfFalse);
+	window_manager_data->m_renderer = sfSprite_create();
+	window_manager_data->m_window = sfRenderWindow_create((sfVideoMode) { window_manager_data->m_size.x, window_manager_data->m_size.y, sfVideoMode_getDesktopMode().bitsPerPixel }, title, style, settings);
+	window_manager_data->m_style = style;
+	window_manager_data->m_title = StrAllocNCopy(title);
+	window_manager_data->m_fullscreen = sfFullscreen & style ? sfTrue : sfFalse;
+	window_manager_data->m_custom_param_list = STD_LIST_CREATE(CustomParam, 0);
+	window_manager_data->m_sound_list = STD_LIST_CREATE(SoundInfo, 0);
+	window_manager_data->m_window_clock = CreateClock();
+	window_manager_data->m_frame_pacer = CreateFramePacer();
+	window_manager->_Data = window_manager_data;
+
+	SetWindowManagerFunctions(window_manager);
 
 	ScreenScaleFactorX = (float)window_manager->_Data->m_size.x / (float)window_manager->_Data->m_base_size.x;
 	ScreenScaleFactorY = (float)window_manager->_Data->m_size.y / (float)window_manager->_Data->m_base_size.y;
@@ -399,3 +478,47 @@ WindowManager* CreateWindowManager(const unsigned int width, const unsigned int
 
 	return window_manager;
 }
+
+WindowManager* CreateHeadlessWindowManager(const unsigned int width, const unsigned int height)
+{
+	WindowManager* window_manager = calloc_d(WindowManager, 1);
+	assert(window_manager);
+	WindowManager_Data* window_manager_data = calloc_d(WindowManager_Data, 1);
+	assert(window_manager_data);
+	window_manager_data->m_size = (sfVector2u){ width, height };
+	window_manager_data->m_base_size = (sfVector2u){ width, height };
+	window_manager_data->m_title = StrAllocNCopy("headless");
+	window_manager_data->m_custom_param_list = STD_LIST_CREATE(CustomParam, 0);
+	window_manager_data->m_sound_list = STD_LIST_CREATE(SoundInfo, 0);
+	window_manager_data->m_window_clock = CreateClock();
+	window_manager_data->m_frame_pacer = CreateFramePacer();
+	window_manager->_Data = window_manager_data;
+
+	SetWindowManagerFunctions(window_manager);
+
+	window_manager->PollEvent = &HeadlessPollEvent;
+	window_manager->GetMousePos = &HeadlessGetMousePos;
+	window_manager->ToggleFullscreen = &HeadlessToggleFullscreen;
+	window_manager->SetCustomView = &HeadlessSetView;
+	window_manager->SetDefaultView = &HeadlessSetDefaultView;
+	window_manager->GetDefaultView = &HeadlessGetDefaultView;
+	window_manager->Clear = &HeadlessClear;
+	window_manager->Display = &HeadlessDisplay;
+
+	window_manager->DrawSprite = &HeadlessDrawSprite;
+	window_manager->DrawText = &HeadlessDrawText;
+	window_manager->DrawShape = &HeadlessDrawShape;
+	window_manager->DrawCircleShape = &HeadlessDrawCircleShape;
+	window_manager->DrawConvexShape = &HeadlessDrawConvexShape;
+	window_manager->DrawRectangleShape = &HeadlessDrawRectangleShape;
+	window_manager->DrawVertexArray = &HeadlessDrawVertexArray;
+	window_manager->DrawVertexBuffer = &HeadlessDrawVertexBuffer;
+	window_manager->DrawPrimitives = &HeadlessDrawPrimitives;
+	window_manager->DrawAnimation = &HeadlessDrawAnimation;
+	window_manager->DrawParticles = &HeadlessDrawParticles;
+
+	ScreenScaleFactorX = 1.f;
+	ScreenScaleFactorY = 1.f;
+
+	return window_manager;
+}
\ No newline at end of file
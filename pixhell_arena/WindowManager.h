@@ -22,6 +22,7 @@
 */
 #pragma once
 #include "Tools.h"
+#include "FramePacer.h"
 #include "string.h"
 
 #undef DrawText;
@@ -271,6 +272,20 @@ struct WindowManager
 	 */
 	void(*Display)(const WindowManager* window);
 
+	/**
+	 * @brief Sets the frame rate Display waits for.
+	 * @param window The WindowManager instance.
+	 * @param frame_rate Target frame rate, 0 removes the limit.
+	 */
+	void (*SetTargetFrameRate)(const WindowManager* window, unsigned int frame_rate);
+
+	/**
+	 * @brief Gets the frame time statistics of the last displayed frames.
+	 * @param window The WindowManager instance.
+	 * @return The frame time statistics, see FrameStats.
+	 */
+	FrameStats(*GetFrameStats)(const WindowManager* window);
+
 	/**
 	 * @brief Draws a sprite object to the window.
 	 * @param window The WindowManager instance.
@@ -375,3 +390,14 @@ struct WindowManager
  * @return A pointer to the newly created WindowManager instance.
  */
 WindowManager* CreateWindowManager(const unsigned int width, const unsigned int height, const char* title, const sfUint32 style, const sfContextSettings* settings);
+
+/**
+ * @brief Creates a window manager without any window nor GL context.
+ * @param width The width reported by GetSize and GetBaseSize.
+ * @param height The height reported by GetSize and GetBaseSize.
+ * @return A pointer to the newly created WindowManager instance.
+ *
+ * Every draw, clear and display call goes to a null sink, PollEvent never returns an event and GetWindow returns NULL.
+ * Custom params, sounds volume and timer keep working.
+ */
+WindowManager* CreateHeadlessWindowManager(const unsigned int width, const unsigned int height);